@@ -53,9 +53,9 @@ corenrn_parameters::corenrn_parameters() {
         ->add_option("-R, --cell-permute",
                      this->cell_interleave_permute,
                      "Cell permutation: 0 No permutation; 1 optimise node adjacency; 2 optimize "
-                     "parent adjacency.",
+                     "parent adjacency; 3 node adjacency solved with SIMD lanes on CPU.",
                      true)
-        ->check(CLI::Range(0, 2));
+        ->check(CLI::Range(0, 3));
     sub_gpu->add_flag("--cuda-interface",
                       this->cuda_interface,
                       "Activate CUDA branch of the code.");
@@ -80,6 +80,10 @@ corenrn_parameters::corenrn_parameters() {
                      "Initial voltage used for nrn_finitialize(1, v_init). If 1000, then "
                      "nrn_finitialize(0,...).")
         ->check(CLI::Range(-1e9, 1e9));
+    sub_input->add_flag("--mmap",
+                        this->mmap_read,
+                        "Read the model data files through a memory mapping and print the "
+                        "setup time of each phase.");
     sub_input->add_option("--report-conf", this->reportfilepath, "Reports configuration file.")
         ->check(CLI::ExistingFile);
     sub_input
@@ -95,6 +99,43 @@ corenrn_parameters::corenrn_parameters() {
     sub_parallel->add_flag("--skip-mpi-finalize",
                            this->skip_mpi_finalize,
                            "Do not call mpi finalize.");
+    sub_parallel->add_flag("--interthread-mutex",
+                           this->interthread_mutex,
+                           "Use mutex guarded buffers instead of lock-free mailboxes for "
+                           "events between threads.");
+    sub_parallel->add_flag("--overlap-gap-transfer",
+                           this->overlap_gap_transfer,
+                           "Exchange the gap junction voltages with the neighbour ranks only and "
+                           "overlap the exchange with the rest of the time step.");
+    sub_parallel->add_flag("--persistent-threads",
+                           this->persistent_threads,
+                           "Keep the threads in one parallel region for the whole simulation, "
+                           "synchronized by barriers, instead of a parallel loop per step.");
+    sub_parallel->add_flag("--dynamic-threads",
+                           this->dynamic_threads,
+                           "Hand out the cell groups to the threads dynamically, the most "
+                           "expensive of the last interval first, instead of round-robin.");
+    sub_parallel->add_flag("--pin-threads",
+                           this->pin_threads,
+                           "Pin the OpenMP threads to one cpu each before reading the model, and "
+                           "print their placement.");
+    sub_parallel->add_flag("--cell-blocks",
+                           this->cell_blocks,
+                           "Run the currents, matrix solve, voltage update and states of a time "
+                           "step for a block of cells that fits in the cache before the next one.");
+    sub_parallel
+        ->add_option("--cell-block-size",
+                     this->cell_block_size,
+                     "Cache budget of a cell block in KiB. The default (0) is half the L2 cache.",
+                     true)
+        ->check(CLI::Range(0, 1'000'000));
+    sub_parallel
+        ->add_option("--setup-threads",
+                     this->setup_threads,
+                     "Number of threads reading and setting up the model files, independent of "
+                     "the number of cell groups. The default (0) uses all cores of the rank.",
+                     true)
+        ->check(CLI::Range(0, 100'000));
 
     auto sub_spike = app.add_option_group("spike", "Spike exchange options.");
     sub_spike
@@ -109,6 +150,18 @@ corenrn_parameters::corenrn_parameters() {
     sub_spike->add_flag("--multisend",
                         this->multisend,
                         "Use Multisend spike exchange instead of Allgather.");
+    sub_spike->add_flag("--overlap-exchange",
+                        this->overlap_exchange,
+                        "Complete the Allgather spike exchange of an interval during the next "
+                        "one. The interval becomes half the min delay.");
+    sub_spike->add_flag("--sparse-exchange",
+                        this->sparse_exchange,
+                        "Send spikes only to the ranks that want them with neighbourhood "
+                        "collectives instead of Allgather.");
+    sub_spike->add_flag("--adaptive-spikebuf",
+                        this->adaptive_spikebuf,
+                        "Send the first spikes of each rank in the Allgather itself, with a "
+                        "buffer size following the spike counts.");
     sub_spike
         ->add_option("--spkcompress",
                      this->spkcompress,
@@ -116,6 +169,12 @@ corenrn_parameters::corenrn_parameters() {
                      true)
         ->check(CLI::Range(0, 100'000));
     sub_spike->add_flag("--binqueue", this->binqueue, "Use bin queue.");
+    sub_spike->add_set("--event-queue",
+                       this->event_queue,
+                       {"default", "splay", "pq", "calendar"},
+                       "Event queue: splay tree, STL priority queue or calendar queue. Default is "
+                       "the one selected at build time.",
+                       true);
 
     auto sub_config = app.add_option_group("config", "Config options.");
     sub_config->add_option("-b, --spikebuf", this->spikebuf, "Spike buffer size.", true)
@@ -145,6 +204,14 @@ corenrn_parameters::corenrn_parameters() {
                      this->report_buff_size,
                      "Size in MB of the report buffer.")
         ->check(CLI::Range(1, 128));
+    sub_config
+        ->add_option("--lfp-cutoff",
+                     this->lfp_cutoff,
+                     "Relative cutoff of LFP reports: for each electrode, the segment "
+                     "coefficients smaller than this fraction of the largest one are dropped and "
+                     "the others stored sparse. 0 (default) keeps them all, dense.",
+                     true)
+        ->check(CLI::Range(0., 1.));
 
     auto sub_output = app.add_option_group("output", "Output configuration.");
     sub_output->add_option("-i, --dt_io", this->dt_io, "Dt of I/O.", true)
@@ -153,6 +220,18 @@ corenrn_parameters::corenrn_parameters() {
                            this->outpath,
                            "Path to place output data files.",
                            true);
+    sub_output->add_set("--spikes-format",
+                        this->spikes_format,
+                        {"text", "binary"},
+                        "Spike output format: text out.dat or binary out.spk (see spikes2dat).",
+                        true);
+    sub_output
+        ->add_option("--spikes-flush",
+                     this->spikes_flush,
+                     "Write spikes to the output file every N minimum delay intervals during the "
+                     "simulation instead of at the end. 0 (default) writes them at the end.",
+                     true)
+        ->check(CLI::Range(0, 1'000'000'000));
     sub_output->add_option("--checkpoint",
                            this->checkpointpath,
                            "Enable checkpoint and specify directory to store related files.");
@@ -207,6 +286,7 @@ std::ostream& operator<<(std::ostream& os, const corenrn_parameters& corenrn_par
        << "--datpath=" << corenrn_param.datpath << std::endl
        << "--filesdat=" << corenrn_param.filesdat << std::endl
        << "--pattern=" << corenrn_param.patternstim << std::endl
+       << "--mmap=" << (corenrn_param.mmap_read ? "true" : "false") << std::endl
        << "--report-conf=" << corenrn_param.reportfilepath << std::endl
        << std::left << std::setw(15) << "--restore=" << corenrn_param.restorepath << std::endl
        << std::endl
@@ -214,13 +294,31 @@ std::ostream& operator<<(std::ostream& os, const corenrn_parameters& corenrn_par
        << "--threading=" << (corenrn_param.threading ? "true" : "false") << std::endl
        << "--skip_mpi_finalize=" << (corenrn_param.skip_mpi_finalize ? "true" : "false")
        << std::endl
+       << "--interthread-mutex=" << (corenrn_param.interthread_mutex ? "true" : "false")
+       << std::endl
+       << "--overlap-gap-transfer=" << (corenrn_param.overlap_gap_transfer ? "true" : "false")
+       << std::endl
+       << "--persistent-threads=" << (corenrn_param.persistent_threads ? "true" : "false")
+       << std::endl
+       << "--dynamic-threads=" << (corenrn_param.dynamic_threads ? "true" : "false")
+       << std::endl
+       << "--pin-threads=" << (corenrn_param.pin_threads ? "true" : "false") << std::endl
+       << "--cell-blocks=" << (corenrn_param.cell_blocks ? "true" : "false") << std::endl
+       << "--cell-block-size=" << corenrn_param.cell_block_size << std::endl
+       << "--setup-threads=" << corenrn_param.setup_threads << std::endl
        << std::endl
        << "SPIKE EXCHANGE" << std::endl
        << "--ms_phases=" << corenrn_param.ms_phases << std::endl
        << "--ms_subintervals=" << corenrn_param.ms_subint << std::endl
        << "--multisend=" << (corenrn_param.multisend ? "true" : "false") << std::endl
+       << "--overlap-exchange=" << (corenrn_param.overlap_exchange ? "true" : "false")
+       << std::endl
+       << "--sparse-exchange=" << (corenrn_param.sparse_exchange ? "true" : "false") << std::endl
+       << "--adaptive-spikebuf=" << (corenrn_param.adaptive_spikebuf ? "true" : "false")
+       << std::endl
        << "--spk_compress=" << corenrn_param.spkcompress << std::endl
        << "--binqueue=" << (corenrn_param.binqueue ? "true" : "false") << std::endl
+       << "--event-queue=" << corenrn_param.event_queue << std::endl
        << std::endl
        << "CONFIGURATION" << std::endl
        << "--spikebuf=" << corenrn_param.spikebuf << std::endl
@@ -229,10 +327,13 @@ std::ostream& operator<<(std::ostream& os, const corenrn_parameters& corenrn_par
        << "--celsius=" << corenrn_param.celsius << std::endl
        << "--mindelay=" << corenrn_param.mindelay << std::endl
        << "--report-buffer-size=" << corenrn_param.report_buff_size << std::endl
+       << "--lfp-cutoff=" << corenrn_param.lfp_cutoff << std::endl
        << std::endl
        << "OUTPUT PARAMETERS" << std::endl
        << "--dt_io=" << corenrn_param.dt_io << std::endl
        << "--outpath=" << corenrn_param.outpath << std::endl
+       << "--spikes-format=" << corenrn_param.spikes_format << std::endl
+       << "--spikes-flush=" << corenrn_param.spikes_flush << std::endl
        << "--checkpoint=" << corenrn_param.checkpointpath << std::endl;
 
     return os;
@@ -49,11 +49,18 @@ struct corenrn_parameters {
     unsigned nwarp = 0;     /// Number of warps to balance for cell_interleave_permute == 2
     unsigned num_gpus = 0;  /// Number of gpus to use per node
     unsigned report_buff_size = report_buff_size_default;  /// Size in MB of the report buffer.
+    unsigned spikes_flush = 0;  /// Write spikes every N min delay intervals (0: at the end)
+    unsigned setup_threads = 0;  /// Threads reading the model files (0: all cores of the rank)
+    unsigned cell_block_size = 0;  /// Cache budget of a cell block in KiB (0: half the L2 cache)
     int seed = -1;  /// Initialization seed for random number generator (int)
 
     bool mpi_enable = false;         /// Enable MPI flag.
     bool skip_mpi_finalize = false;  /// Skip MPI finalization
+    bool interthread_mutex = false;  /// Use mutex guarded buffers for events between threads
     bool multisend = false;          /// Use Multisend spike exchange instead of Allgather.
+    bool overlap_exchange = false;   /// Overlap the Allgather spike exchange with integration
+    bool sparse_exchange = false;    /// Send spikes only to the ranks that want them
+    bool adaptive_spikebuf = false;  /// Allgather inline spike buffer sized at run time
     bool threading = false;          /// Enable pthread/openmp
     bool gpu = false;                /// Enable GPU computation.
     bool cuda_interface = false;     /// Enable CUDA interface (default is the OpenACC interface).
@@ -61,10 +68,18 @@ struct corenrn_parameters {
                                   /// OpenACC regions.
     bool binqueue = false;  /// Use bin queue.
 
+    bool overlap_gap_transfer = false;  /// Overlap the gap junction transfer with the time step
+    bool persistent_threads = false;    /// Keep the threads alive for the whole simulation
+    bool dynamic_threads = false;       /// Hand out the cell groups to the threads dynamically
+    bool pin_threads = false;           /// Pin the OpenMP threads to one cpu each
+    bool cell_blocks = false;           /// Run the fixed step over cache sized blocks of cells
+
     bool show_version = false;  /// Print version and exit.
 
     bool model_stats = false;  /// Print mechanism counts and model size after initialization
 
+    bool mmap_read = false;  /// Read the model data files through a memory mapping
+
     verbose_level verbose{verbose_level::DEFAULT};  /// Verbosity-level
 
     double tstop = 100;        /// Stop time of simulation in msec
@@ -76,10 +91,13 @@ struct corenrn_parameters {
     double forwardskip = 0.;   /// Forward skip to TIME.
     double mindelay = 10.;     /// Maximum integration interval (likely reduced by minimum NetCon
                                /// delay).
+    double lfp_cutoff = 0.;    /// Relative cutoff of the LFP coefficients (0: dense)
 
+    std::string event_queue{"default"};  /// Event queue: default, splay, pq or calendar
     std::string patternstim;             /// Apply patternstim using the specified spike file.
     std::string datpath = ".";           /// Directory path where .dat files
     std::string outpath = ".";           /// Directory where spikes will be written
+    std::string spikes_format{"text"};   /// Spike output format: text (out.dat) or binary (out.spk)
     std::string filesdat = "files.dat";  /// Name of file containing list of gids dat files read in
     std::string restorepath;             /// Restore simulation from provided checkpoint directory.
     std::string reportfilepath;          /// Reports configuration file.
@@ -22,6 +22,7 @@
 #include "coreneuron/engine.h"
 #include "coreneuron/utils/randoms/nrnran123.h"
 #include "coreneuron/nrnconf.h"
+#include "coreneuron/sim/cell_blocks.hpp"
 #include "coreneuron/sim/fast_imem.hpp"
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/mpi/nrnmpi.h"
@@ -34,14 +35,18 @@
 #include "coreneuron/io/prcellstate.hpp"
 #include "coreneuron/utils/nrnmutdec.h"
 #include "coreneuron/utils/nrn_stats.h"
+#include "coreneuron/utils/thread_affinity.hpp"
 #include "coreneuron/io/reports/nrnreport.hpp"
 #include "coreneuron/io/reports/binary_report_handler.hpp"
+#include "coreneuron/io/reports/builtin_report_handler.hpp"
 #include "coreneuron/io/reports/report_handler.hpp"
 #include "coreneuron/io/reports/sonata_report_handler.hpp"
 #include "coreneuron/gpu/nrn_acc_manager.hpp"
 #include "coreneuron/utils/profile/profiler_interface.h"
 #include "coreneuron/network/partrans.hpp"
 #include "coreneuron/network/multisend.hpp"
+#include "coreneuron/network/sparse_exchange.hpp"
+#include "coreneuron/network/netcvode.hpp"
 #include "coreneuron/io/nrn_setup.hpp"
 #include "coreneuron/io/file_utils.hpp"
 #include "coreneuron/io/nrn2core_direct.h"
@@ -216,6 +221,22 @@ void nrn_init_and_load_data(int argc,
     }
 #endif
 
+    // before the model is read, for the first touch of the data of each thread
+    if (corenrn_param.pin_threads) {
+        int local_rank = 0;
+        int local_size = 1;
+#if NRNMPI
+        if (corenrn_param.mpi_enable) {
+            local_rank = nrnmpi_local_rank();
+            local_size = nrnmpi_local_size();
+        }
+#endif
+        std::vector<int> cpus = pin_omp_threads(local_rank, local_size);
+        if (!corenrn_param.is_quiet()) {
+            report_thread_placement(cpus);
+        }
+    }
+
     // full path of files.dat file
     std::string filesdat(corenrn_param.datpath + "/" + corenrn_param.filesdat);
 
@@ -248,6 +269,17 @@ void nrn_init_and_load_data(int argc,
     // for ispc backend
     ispc_celsius = celsius;
 
+    // event queue container, the one selected at build time (QTYPE) by default
+    if (corenrn_param.event_queue == "splay") {
+        nrn_event_queue_ = spltree;
+    } else if (corenrn_param.event_queue == "pq") {
+        nrn_event_queue_ = pq_que;
+    } else if (corenrn_param.event_queue == "calendar") {
+        nrn_event_queue_ = calq;
+    }
+
+    nrn_interthread_mutex_ = corenrn_param.interthread_mutex;
+
     // create net_cvode instance
     mk_netcvode();
 
@@ -274,11 +306,29 @@ void nrn_init_and_load_data(int argc,
         interleave_permute_type = 1;
         use_solve_interleave = true;
     }
+    nrn_dynamic_threads = corenrn_param.dynamic_threads;
+    nrn_cell_blocks = corenrn_param.cell_blocks;
+    nrn_gap_overlap = corenrn_param.overlap_gap_transfer;
+    if (corenrn_param.gpu && nrn_gap_overlap) {
+        if (nrnmpi_myid == 0) {
+            printf(" WARNING : --overlap-gap-transfer is for CPU execution. Ignoring it.\n");
+        }
+        nrn_gap_overlap = false;
+    }
+    if (corenrn_param.gpu && interleave_permute_type == 3) {
+        if (nrnmpi_myid == 0) {
+            printf(" WARNING : --cell-permute type 3 is for CPU execution. Setting it to 1.\n");
+        }
+        interleave_permute_type = 1;
+    }
 
     // multisend options
     use_multisend_ = corenrn_param.multisend ? 1 : 0;
     n_multisend_interval = corenrn_param.ms_subint;
     use_phase2_ = (corenrn_param.ms_phases == 2) ? 1 : 0;
+    // sparse exchange replaces the plain Allgather only
+    use_sparse_exchange_ = corenrn_param.mpi_enable && corenrn_param.sparse_exchange &&
+                           !use_multisend_ && corenrn_param.spkcompress == 0;
 
     // reading *.dat files and setting up the data structures, setting mindelay
     nrn_setup(filesdat.c_str(),
@@ -356,6 +406,13 @@ void nrn_init_and_load_data(int argc,
         nrn_partrans::gap_update_indices();
     }
 
+    if (nrn_cell_blocks) {
+        std::size_t block_bytes = corenrn_param.cell_block_size
+                                      ? corenrn_param.cell_block_size * std::size_t{1024}
+                                      : nrn_cell_block_default_bytes();
+        nrn_cell_blocks_setup(block_bytes);
+    }
+
     // call prcellstate for prcellgid
     call_prcellstate_for_prcellgid(corenrn_param.prcellgid, corenrn_param.gpu, 1);
 }
@@ -397,6 +454,7 @@ void handle_forward_skip(double forwardskip, int prcellgid) {
     for (int step = 0; step < 10; ++step) {
         nrn_fixed_step_minimal();
     }
+    nrnmpi_v_transfer_complete();
 
     if (prcellgid >= 0) {
         prcellstate(prcellgid, "fs");
@@ -433,6 +491,8 @@ std::unique_ptr<ReportHandler> create_report_handler(ReportConfiguration& config
         report_handler = std::make_unique<BinaryReportHandler>(config);
     } else if (config.format == "SONATA") {
         report_handler = std::make_unique<SonataReportHandler>(config);
+    } else if (config.format == "Builtin") {
+        report_handler = std::make_unique<BuiltinReportHandler>(config);
     } else {
         if (nrnmpi_myid == 0) {
             printf(" WARNING : Report name '%s' has unknown format: '%s'.\n",
@@ -610,12 +670,18 @@ extern "C" int run_solve_core(int argc, char** argv) {
         // call prcellstate for prcellgid
         call_prcellstate_for_prcellgid(corenrn_param.prcellgid, compute_gpu, 0);
 
+        // costs of the threads, measured from here
+        nrn_thread_balance_init();
+
         // handle forwardskip
         if (corenrn_param.forwardskip > 0.0) {
             Instrumentor::phase p("handle-forward-skip");
             handle_forward_skip(corenrn_param.forwardskip, corenrn_param.prcellgid);
         }
 
+        // spikes are written during the simulation with --spikes-flush
+        output_spikes_stream_open(output_dir.c_str());
+
         /// Solver execution
         Instrumentor::start_profile();
         Instrumentor::phase_begin("simulation");
@@ -634,6 +700,11 @@ extern "C" int run_solve_core(int argc, char** argv) {
         // Report global cell statistics
         if (!corenrn_param.is_quiet()) {
             report_cell_stats();
+            report_thread_idle_stats();
+            if (corenrn_param.model_stats) {
+                report_event_stats();
+                report_spike_exchange_stats();
+            }
         }
 
         // prcellstate after end of solver
@@ -0,0 +1,70 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+/**
+ * \file
+ * \brief Print a report written by the built-in report writer as text
+ *
+ * Usage: reportdump report.rpt [gid]
+ * Every row of the report is printed on one line, its values separated by
+ * spaces. With a gid only the columns of that gid are printed.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "coreneuron/io/reports/report_file.hpp"
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s report.rpt [gid]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(argv[1], "rb");
+    if (!in) {
+        fprintf(stderr, "Error: could not open %s\n", argv[1]);
+        return 1;
+    }
+    coreneuron::ReportFileLayout layout;
+    if (!coreneuron::read_report_file_layout(in, layout)) {
+        fprintf(stderr, "Error: %s is not a CoreNEURON binary report file\n", argv[1]);
+        fclose(in);
+        return 1;
+    }
+
+    std::vector<std::size_t> columns;
+    for (std::size_t i = 0; i < layout.columns.size(); ++i) {
+        if (argc == 2 || layout.columns[i].gid == std::atoi(argv[2])) {
+            columns.push_back(i);
+        }
+    }
+
+    std::vector<float> values;
+    std::uint64_t ncol = layout.header.ncol;
+    std::uint64_t nchunk = coreneuron::report_nchunk(layout.header);
+    long status = 0;
+    for (std::uint64_t c = 0; c < nchunk; ++c) {
+        status = coreneuron::read_report_chunk(in, layout, c, values);
+        if (status < 0) {
+            fprintf(stderr, "Error: %s is truncated\n", argv[1]);
+            break;
+        }
+        for (long r = 0; r < status; ++r) {
+            for (std::size_t k = 0; k < columns.size(); ++k) {
+                printf(k ? " %g" : "%g", values[r * ncol + columns[k]]);
+            }
+            printf("\n");
+        }
+    }
+
+    fclose(in);
+    return status < 0 ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+/**
+ * \file
+ * \brief Convert a binary spike file (out.spk) to the legacy text out.dat
+ *
+ * Usage: spikes2dat out.spk [out.dat]
+ * Without an output file name the spikes are printed on stdout.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "coreneuron/io/spike_file.hpp"
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s out.spk [out.dat]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(argv[1], "rb");
+    if (!in) {
+        fprintf(stderr, "Error: could not open %s\n", argv[1]);
+        return 1;
+    }
+    if (!coreneuron::read_spike_file_header(in)) {
+        fprintf(stderr, "Error: %s is not a CoreNEURON binary spike file\n", argv[1]);
+        fclose(in);
+        return 1;
+    }
+
+    FILE* out = argc == 3 ? fopen(argv[2], "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Error: could not open %s\n", argv[2]);
+        fclose(in);
+        return 1;
+    }
+
+    std::vector<double> time;
+    std::vector<std::int32_t> gid;
+    int status;
+    while ((status = coreneuron::read_spike_block(in, time, gid)) == 1) {
+        for (std::size_t i = 0; i < time.size(); ++i) {
+            fprintf(out, "%.8g\t%d\n", time[i], gid[i]);
+        }
+    }
+    if (status < 0) {
+        fprintf(stderr, "Error: %s is truncated\n", argv[1]);
+    }
+
+    fclose(in);
+    if (out != stdout) {
+        fclose(out);
+    }
+    return status < 0 ? 1 : 0;
+}
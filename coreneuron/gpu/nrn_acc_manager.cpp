@@ -340,6 +340,16 @@ void setup_nrnthreads_on_device(NrnThread* threads, int nthreads) {
             acc_memcpy_to_device(&(d_nt->presyns), &d_presyns, sizeof(PreSyn*));
         }
 
+        if (nt->ncell) {
+            /* threshold table used by check_thresh */
+            int* d_thvar_index = (int*) acc_copyin(nt->presyns_thvar_index,
+                                                   sizeof(int) * nt->ncell);
+            acc_memcpy_to_device(&(d_nt->presyns_thvar_index), &d_thvar_index, sizeof(int*));
+            double* d_threshold = (double*) acc_copyin(nt->presyns_threshold,
+                                                       sizeof(double) * nt->ncell);
+            acc_memcpy_to_device(&(d_nt->presyns_threshold), &d_threshold, sizeof(double*));
+        }
+
         if (nt->_net_send_buffer_size) {
             /* copy send_receive buffer */
             int* d_net_send_buffer = (int*) acc_copyin(nt->_net_send_buffer,
@@ -1031,6 +1041,11 @@ void delete_nrnthreads_on_device(NrnThread* threads, int nthreads) {
             acc_delete(nt->presyns_helper, sizeof(PreSynHelper) * nt->n_presyn);
         }
 
+        if (nt->ncell) {
+            acc_delete(nt->presyns_thvar_index, sizeof(int) * nt->ncell);
+            acc_delete(nt->presyns_threshold, sizeof(double) * nt->ncell);
+        }
+
         // Cleanup data that's setup in bbcore_read.
         if (nt->_nvdata) {
             acc_delete(nt->_vdata, sizeof(void*) * nt->_nvdata);
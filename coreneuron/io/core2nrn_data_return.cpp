@@ -468,7 +468,7 @@ static bool core2nrn_tqueue_item(TQItem* q, SelfEventWeightMap& sewm, NrnThread&
                 }
                 (*core2nrn_SelfEvent_event_noweight_)(
                     nt.id, td, tar_type, tar_index, flag, is_movable);
-                delete se;
+                net_cvode_instance->p[nt.id].selfevent_pool_.release(se);
             }
             break;
         }
@@ -517,7 +517,7 @@ void core2nrn_tqueue(NrnThread& nt) {
     // TQItems from atomic_dq
     while ((q = tqe->atomic_dq(1e20)) != nullptr) {
         if (core2nrn_tqueue_item(q, sewm, nt) == false) {
-            delete q;
+            tqe->release(q);
         }
     }
     // TQitems from binq_
@@ -561,8 +561,8 @@ void core2nrn_tqueue(NrnThread& nt) {
                     int is_movable = (movable && *movable == q) ? 1 : 0;
                     (*core2nrn_SelfEvent_event_)(
                         nt.id, td, tar_type, tar_index, flag, nc_index, is_movable);
-                    delete q;
-                    delete se;
+                    tqe->release(q);
+                    ntd.selfevent_pool_.release(se);
                 }
             }
         }
@@ -1,7 +1,9 @@
 #include "coreneuron/io/lfp.hpp"
 #include "coreneuron/apps/corenrn_parameters.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <exception>
 #include <limits>
 #include <sstream>
 
@@ -80,8 +82,14 @@ LFPCalculator<Type, SegmentIdTy>::LFPCalculator(const Point3Ds& seg_start,
                                                 const std::vector<double>& radius,
                                                 const std::vector<SegmentIdTy>& segment_ids,
                                                 const Point3Ds& electrodes,
-                                                double extra_cellular_conductivity)
-    : segment_ids_(segment_ids) {
+                                                double extra_cellular_conductivity,
+                                                double cutoff)
+    : nelectrode_(electrodes.size())
+    , nsegment_(seg_start.size())
+    , sparse_(cutoff > 0.0)
+    , segment_ids_(segment_ids)
+    , currents_(seg_start.size())
+    , res_(electrodes.size()) {
     if (seg_start.size() != seg_end.size()) {
         throw std::invalid_argument("Different number of segment starts and ends.");
     }
@@ -90,55 +98,183 @@ LFPCalculator<Type, SegmentIdTy>::LFPCalculator(const Point3Ds& seg_start,
     }
     double f(1.0 / (extra_cellular_conductivity * 4.0 * pi));
 
-    m.resize(electrodes.size());
-    for (size_t k = 0; k < electrodes.size(); ++k) {
-        auto& ms = m[k];
-        ms.resize(seg_start.size());
-        for (size_t l = 0; l < seg_start.size(); l++) {
-            ms[l] = getFactor(electrodes[k], seg_start[l], seg_end[l], radius[l], f);
+    // the electrodes are computed in parallel, the first exception thrown
+    // by getFactor is rethrown once they are all done
+    std::exception_ptr error;
+    auto electrode_factors = [&](size_t k, double* ms) {
+        try {
+            for (size_t l = 0; l < nsegment_; l++) {
+                ms[l] = getFactor(electrodes[k], seg_start[l], seg_end[l], radius[l], f);
+            }
+        } catch (...) {
+            #pragma omp critical(lfp_factor_error)
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    if (!sparse_) {
+        coefs_.resize(nelectrode_ * nsegment_);
+        #pragma omp parallel for schedule(static)
+        for (size_t k = 0; k < nelectrode_; ++k) {
+            electrode_factors(k, coefs_.data() + k * nsegment_);
         }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return;
+    }
+
+    // far away segments contribute little to an electrode: keep, for each
+    // electrode, the coefficients above cutoff times the largest one
+    std::vector<std::vector<double>> kept_coefs(nelectrode_);
+    std::vector<std::vector<int>> kept_columns(nelectrode_);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t k = 0; k < nelectrode_; ++k) {
+        std::vector<double> ms(nsegment_);
+        electrode_factors(k, ms.data());
+        double max_coef = 0.0;
+        for (size_t l = 0; l < nsegment_; l++) {
+            max_coef = std::max(max_coef, std::abs(ms[l]));
+        }
+        for (size_t l = 0; l < nsegment_; l++) {
+            if (std::abs(ms[l]) >= cutoff * max_coef) {
+                kept_coefs[k].push_back(ms[l]);
+                kept_columns[k].push_back(l);
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    row_offsets_.resize(nelectrode_ + 1);
+    row_offsets_[0] = 0;
+    for (size_t k = 0; k < nelectrode_; ++k) {
+        row_offsets_[k + 1] = row_offsets_[k] + kept_coefs[k].size();
+    }
+    coefs_.reserve(row_offsets_[nelectrode_]);
+    columns_.reserve(row_offsets_[nelectrode_]);
+    for (size_t k = 0; k < nelectrode_; ++k) {
+        coefs_.insert(coefs_.end(), kept_coefs[k].begin(), kept_coefs[k].end());
+        columns_.insert(columns_.end(), kept_columns[k].begin(), kept_columns[k].end());
+        std::vector<double>().swap(kept_coefs[k]);
+        std::vector<int>().swap(kept_columns[k]);
     }
 }
 
 template <LFPCalculatorType Type, typename SegmentIdTy>
-template <typename Vector>
-inline void LFPCalculator<Type, SegmentIdTy>::lfp(const Vector& membrane_current) {
-    std::vector<double> res(m.size());
-    for (size_t k = 0; k < m.size(); ++k) {
-        res[k] = 0.0;
-        auto& ms = m[k];
-        for (size_t l = 0; l < ms.size(); l++) {
-            res[k] += ms[l] * membrane_current[segment_ids_[l]];
+void LFPCalculator<Type, SegmentIdTy>::lfp_dense() {
+    const double* cur = currents_.data();
+    const double* m = coefs_.data();
+    double* res = res_.data();
+    const size_t n = nsegment_;
+    const long nblock = (nelectrode_ + block_size - 1) / block_size;
+    #pragma omp parallel for schedule(static) if (nelectrode_ * nsegment_ > parallel_threshold)
+    for (long b = 0; b < nblock; ++b) {
+        size_t k0 = b * block_size;
+        if (k0 + block_size <= nelectrode_) {
+            const double* m0 = m + k0 * n;
+            const double* m1 = m0 + n;
+            const double* m2 = m1 + n;
+            const double* m3 = m2 + n;
+            double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+            #pragma omp simd reduction(+ : s0, s1, s2, s3)
+            for (size_t l = 0; l < n; ++l) {
+                double c = cur[l];
+                s0 += m0[l] * c;
+                s1 += m1[l] * c;
+                s2 += m2[l] * c;
+                s3 += m3[l] * c;
+            }
+            res[k0] = s0;
+            res[k0 + 1] = s1;
+            res[k0 + 2] = s2;
+            res[k0 + 3] = s3;
+        } else {
+            for (size_t k = k0; k < nelectrode_; ++k) {
+                const double* mk = m + k * n;
+                double sum = 0.0;
+                #pragma omp simd reduction(+ : sum)
+                for (size_t l = 0; l < n; ++l) {
+                    sum += mk[l] * cur[l];
+                }
+                res[k] = sum;
+            }
         }
     }
+}
+
+template <LFPCalculatorType Type, typename SegmentIdTy>
+void LFPCalculator<Type, SegmentIdTy>::lfp_sparse() {
+    const double* cur = currents_.data();
+    const double* val = coefs_.data();
+    const int* col = columns_.data();
+    const size_t* offsets = row_offsets_.data();
+    double* res = res_.data();
+    const long nelectrode = nelectrode_;
+    #pragma omp parallel for schedule(dynamic, 8) if (coefs_.size() > parallel_threshold)
+    for (long k = 0; k < nelectrode; ++k) {
+        double sum = 0.0;
+        #pragma omp simd reduction(+ : sum)
+        for (size_t i = offsets[k]; i < offsets[k + 1]; ++i) {
+            sum += val[i] * cur[col[i]];
+        }
+        res[k] = sum;
+    }
+}
+
+template <LFPCalculatorType Type, typename SegmentIdTy>
+template <typename Vector>
+void LFPCalculator<Type, SegmentIdTy>::local_lfp(const Vector& membrane_current) {
+    // gather once, instead of once per electrode
+    for (size_t l = 0; l < nsegment_; l++) {
+        currents_[l] = membrane_current[segment_ids_[l]];
+    }
+    if (sparse_) {
+        lfp_sparse();
+    } else {
+        lfp_dense();
+    }
+}
+
+template <LFPCalculatorType Type, typename SegmentIdTy>
+template <typename Vector>
+inline void LFPCalculator<Type, SegmentIdTy>::lfp(const Vector& membrane_current) {
+    local_lfp(membrane_current);
+    lfp_values_.resize(res_.size());
 #if NRNMPI
     if (corenrn_param.mpi_enable) {
-        lfp_values_.resize(res.size());
         int mpi_sum{1};
-        nrnmpi_dbl_allreduce_vec(res.data(), lfp_values_.data(), res.size(), mpi_sum);
+        nrnmpi_dbl_allreduce_vec(res_.data(), lfp_values_.data(), res_.size(), mpi_sum);
     } else
 #endif
     {
-        std::swap(res, lfp_values_);
+        std::copy(res_.begin(), res_.end(), lfp_values_.begin());
     }
 }
 
-
 template LFPCalculator<LineSource>::LFPCalculator(const lfputils::Point3Ds& seg_start,
                                                   const lfputils::Point3Ds& seg_end,
                                                   const std::vector<double>& radius,
                                                   const std::vector<int>& segment_ids,
                                                   const lfputils::Point3Ds& electrodes,
-                                                  double extra_cellular_conductivity);
+                                                  double extra_cellular_conductivity,
+                                                  double cutoff);
 template LFPCalculator<PointSource>::LFPCalculator(const lfputils::Point3Ds& seg_start,
                                                    const lfputils::Point3Ds& seg_end,
                                                    const std::vector<double>& radius,
                                                    const std::vector<int>& segment_ids,
                                                    const lfputils::Point3Ds& electrodes,
-                                                   double extra_cellular_conductivity);
+                                                   double extra_cellular_conductivity,
+                                                   double cutoff);
 template void LFPCalculator<LineSource>::lfp(const DoublePtr& membrane_current);
 template void LFPCalculator<PointSource>::lfp(const DoublePtr& membrane_current);
 template void LFPCalculator<LineSource>::lfp(const std::vector<double>& membrane_current);
 template void LFPCalculator<PointSource>::lfp(const std::vector<double>& membrane_current);
+template void LFPCalculator<LineSource>::local_lfp(const DoublePtr& membrane_current);
+template void LFPCalculator<PointSource>::local_lfp(const DoublePtr& membrane_current);
+template void LFPCalculator<LineSource>::local_lfp(const std::vector<double>& membrane_current);
+template void LFPCalculator<PointSource>::local_lfp(const std::vector<double>& membrane_current);
 
 }  // namespace coreneuron
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <vector>
 
 #include "coreneuron/mpi/nrnmpi.h"
@@ -79,47 +80,96 @@ struct LFPCalculator {
      * \param electrodes positions of the electrodes
      * \param extra_cellular_conductivity conductivity of the extra-cellular
      * medium
+     * \param cutoff relative cutoff. If positive, the coefficients of an
+     * electrode smaller than cutoff times its largest coefficient are dropped
+     * and the others are stored sparse. Otherwise all the coefficients are
+     * stored dense.
      */
     LFPCalculator(const lfputils::Point3Ds& seg_start,
                   const lfputils::Point3Ds& seg_end,
                   const std::vector<double>& radius,
                   const std::vector<SegmentIdTy>& segment_ids,
                   const lfputils::Point3Ds& electrodes,
-                  double extra_cellular_conductivity);
+                  double extra_cellular_conductivity,
+                  double cutoff = 0.0);
 
+    /// LFP of all the ranks, summed with an allreduce when MPI is enabled
     template <typename Vector>
     void lfp(const Vector& membrane_current);
 
+    /// LFP of the segments of this calculator only, in local_lfp_values()
+    template <typename Vector>
+    void local_lfp(const Vector& membrane_current);
+
+    /// Stays at the same address for the lifetime of the calculator
+    const std::vector<double>& local_lfp_values() const noexcept {
+        return res_;
+    }
+
     const std::vector<double>& lfp_values() const noexcept {
         return lfp_values_;
     }
 
+    bool is_sparse() const noexcept {
+        return sparse_;
+    }
+
+    /// Number of coefficients stored
+    std::size_t ncoefficients() const noexcept {
+        return coefs_.size();
+    }
+
+    /// Size in bytes of the stored coefficients and their indices
+    std::size_t memory_usage() const noexcept {
+        return coefs_.size() * sizeof(double) + columns_.size() * sizeof(int) +
+               row_offsets_.size() * sizeof(std::size_t);
+    }
+
   private:
     inline double getFactor(const lfputils::Point3D& e_pos,
                             const lfputils::Point3D& seg_0,
                             const lfputils::Point3D& seg_1,
                             const double radius,
                             const double f) const;
+    void lfp_dense();
+    void lfp_sparse();
+
+    /// electrodes computed together by the dense kernel, which then loads
+    /// every membrane current once per block instead of once per electrode
+    static constexpr std::size_t block_size = 4;
+    /// number of multiply-adds below which the kernels stay serial
+    static constexpr std::size_t parallel_threshold = 1 << 16;
+
+    std::size_t nelectrode_;
+    std::size_t nsegment_;
+    bool sparse_;
+    /// dense: nelectrode_ x nsegment_, row major. sparse: CSR values
+    std::vector<double> coefs_;
+    /// sparse only: CSR segment of each value and first value of each electrode
+    std::vector<int> columns_;
+    std::vector<std::size_t> row_offsets_;
+    std::vector<SegmentIdTy> segment_ids_;
+    /// membrane currents gathered in segment order
+    std::vector<double> currents_;
+    std::vector<double> res_;
     std::vector<double> lfp_values_;
-    std::vector<std::vector<double>> m;
-    const std::vector<SegmentIdTy>& segment_ids_;
 };
 
 template <>
-double LFPCalculator<LineSource>::getFactor(const lfputils::Point3D& e_pos,
-                                            const lfputils::Point3D& seg_0,
-                                            const lfputils::Point3D& seg_1,
-                                            const double radius,
-                                            const double f) const {
+inline double LFPCalculator<LineSource>::getFactor(const lfputils::Point3D& e_pos,
+                                                   const lfputils::Point3D& seg_0,
+                                                   const lfputils::Point3D& seg_1,
+                                                   const double radius,
+                                                   const double f) const {
     return lfputils::line_source_lfp_factor(e_pos, seg_0, seg_1, radius, f);
 }
 
 template <>
-double LFPCalculator<PointSource>::getFactor(const lfputils::Point3D& e_pos,
-                                             const lfputils::Point3D& seg_0,
-                                             const lfputils::Point3D& seg_1,
-                                             const double radius,
-                                             const double f) const {
+inline double LFPCalculator<PointSource>::getFactor(const lfputils::Point3D& e_pos,
+                                                    const lfputils::Point3D& seg_0,
+                                                    const lfputils::Point3D& seg_1,
+                                                    const double radius,
+                                                    const double f) const {
     return lfputils::point_source_lfp_factor(e_pos, lfputils::barycenter(seg_0, seg_1), radius, f);
 }
 
@@ -128,15 +178,25 @@ extern template LFPCalculator<LineSource>::LFPCalculator(const lfputils::Point3D
                                                          const std::vector<double>& radius,
                                                          const std::vector<int>& segment_ids,
                                                          const lfputils::Point3Ds& electrodes,
-                                                         double extra_cellular_conductivity);
+                                                         double extra_cellular_conductivity,
+                                                         double cutoff);
 extern template LFPCalculator<PointSource>::LFPCalculator(const lfputils::Point3Ds& seg_start,
                                                           const lfputils::Point3Ds& seg_end,
                                                           const std::vector<double>& radius,
                                                           const std::vector<int>& segment_ids,
                                                           const lfputils::Point3Ds& electrodes,
-                                                          double extra_cellular_conductivity);
+                                                          double extra_cellular_conductivity,
+                                                          double cutoff);
 extern template void LFPCalculator<LineSource>::lfp(const lfputils::DoublePtr& membrane_current);
 extern template void LFPCalculator<PointSource>::lfp(const lfputils::DoublePtr& membrane_current);
 extern template void LFPCalculator<LineSource>::lfp(const std::vector<double>& membrane_current);
 extern template void LFPCalculator<PointSource>::lfp(const std::vector<double>& membrane_current);
+extern template void LFPCalculator<LineSource>::local_lfp(
+    const lfputils::DoublePtr& membrane_current);
+extern template void LFPCalculator<PointSource>::local_lfp(
+    const lfputils::DoublePtr& membrane_current);
+extern template void LFPCalculator<LineSource>::local_lfp(
+    const std::vector<double>& membrane_current);
+extern template void LFPCalculator<PointSource>::local_lfp(
+    const std::vector<double>& membrane_current);
 }  // namespace coreneuron
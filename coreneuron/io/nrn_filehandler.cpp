@@ -6,7 +6,11 @@
 # =============================================================================.
 */
 
+#include <algorithm>
 #include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include "coreneuron/io/nrn_filehandler.hpp"
 #include "coreneuron/nrnconf.h"
 
@@ -22,19 +26,39 @@ bool FileHandler::file_exist(const std::string& filename) const {
     return (stat(filename.c_str(), &buffer) == 0);
 }
 
-void FileHandler::open(const std::string& filename, std::ios::openmode mode) {
+void FileHandler::open(const std::string& filename, std::ios::openmode mode, bool use_mmap) {
     nrn_assert((mode & (std::ios::in | std::ios::out)));
     close();
-    F.open(filename, mode | std::ios::binary);
-    if (!F.is_open()) {
-        std::cerr << "cannot open file '" << filename << "'" << std::endl;
-    }
-    nrn_assert(F.is_open());
     current_mode = mode;
+    if (use_mmap && !(mode & std::ios::out)) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "cannot open file '" << filename << "'" << std::endl;
+        }
+        nrn_assert(fd >= 0);
+        struct stat st;
+        nrn_assert(fstat(fd, &st) == 0);
+        size_t size = st.st_size;
+        void* p = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+        ::close(fd);
+        nrn_assert(p != MAP_FAILED);
+        if (p) {
+            madvise(p, size, MADV_SEQUENTIAL);
+        }
+        mapped = true;
+        map_begin = static_cast<const char*>(p);
+        map_pos = map_begin;
+        map_end = map_begin + size;
+    } else {
+        F.open(filename, mode | std::ios::binary);
+        if (!F.is_open()) {
+            std::cerr << "cannot open file '" << filename << "'" << std::endl;
+        }
+        nrn_assert(F.is_open());
+    }
     char version[256];
     if (current_mode & std::ios::in) {
-        F.getline(version, sizeof(version));
-        nrn_assert(!F.fail());
+        read_line(version, sizeof(version));
         check_bbcore_write_version(version);
     }
     if (current_mode & std::ios::out) {
@@ -42,7 +66,26 @@ void FileHandler::open(const std::string& filename, std::ios::openmode mode) {
     }
 }
 
+void FileHandler::read_line(char* buf, size_t size) {
+    if (!mapped) {
+        F.getline(buf, size);
+        nrn_assert(!F.fail());
+        return;
+    }
+    const char* eol =
+        static_cast<const char*>(memchr(map_pos, '\n', std::min(size_t(map_end - map_pos), size)));
+    // like getline, fail if there is no newline within size - 1 characters
+    nrn_assert(eol != nullptr && size_t(eol - map_pos) < size);
+    size_t len = eol - map_pos;
+    memcpy(buf, map_pos, len);
+    buf[len] = '\0';
+    map_pos = eol + 1;
+}
+
 bool FileHandler::eof() {
+    if (mapped) {
+        return map_pos == map_end;
+    }
     if (F.eof()) {
         return true;
     }
@@ -57,8 +100,7 @@ bool FileHandler::eof() {
 int FileHandler::read_int() {
     char line_buf[max_line_length];
 
-    F.getline(line_buf, sizeof(line_buf));
-    nrn_assert(!F.fail());
+    read_line(line_buf, sizeof(line_buf));
 
     int i;
     int n_scan = sscanf(line_buf, "%d", &i);
@@ -70,8 +112,7 @@ int FileHandler::read_int() {
 void FileHandler::read_mapping_count(int* gid, int* nsec, int* nseg, int* nseclist) {
     char line_buf[max_line_length];
 
-    F.getline(line_buf, sizeof(line_buf));
-    nrn_assert(!F.fail());
+    read_line(line_buf, sizeof(line_buf));
 
     /** mapping file has extra strings, ignore those */
     int n_scan = sscanf(line_buf, "%d %d %d %d", gid, nsec, nseg, nseclist);
@@ -85,8 +126,7 @@ void FileHandler::read_mapping_cell_count(int* count) {
 void FileHandler::read_checkpoint_assert() {
     char line_buf[max_line_length];
 
-    F.getline(line_buf, sizeof(line_buf));
-    nrn_assert(!F.fail());
+    read_line(line_buf, sizeof(line_buf));
 
     int i;
     int n_scan = sscanf(line_buf, "chkpnt %d\n", &i);
@@ -102,6 +142,13 @@ void FileHandler::read_checkpoint_assert() {
 }
 
 void FileHandler::close() {
+    if (mapped) {
+        if (map_begin) {
+            munmap(const_cast<char*>(map_begin), map_end - map_begin);
+        }
+        mapped = false;
+        map_begin = map_pos = map_end = nullptr;
+    }
     F.close();
 }
 }  // namespace coreneuron
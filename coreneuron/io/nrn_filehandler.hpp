@@ -9,6 +9,7 @@
 #ifndef nrn_filehandler_h
 #define nrn_filehandler_h
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -25,6 +26,11 @@ namespace coreneuron {
  *
  * All automatic allocations performed by read_int_array()
  * and read_dbl_array() methods use new [].
+ *
+ * Files opened for reading with use_mmap are memory mapped instead of
+ * read through the fstream: arrays are copied once from the mapping
+ * straight into their destination. Arrays in the file follow text lines
+ * and are not aligned, so they cannot be used in place.
  */
 
 // @todo: remove this static buffer
@@ -35,6 +41,23 @@ class FileHandler {
     std::ios_base::openmode current_mode;  //!< File open mode (not stored in fstream)
     int chkpnt;                            //!< Current checkpoint number state.
     int stored_chkpnt;                     //!< last "remembered" checkpoint number state.
+    bool mapped = false;                   //!< File is read from a memory mapping.
+    const char* map_begin = nullptr;       //!< Start of the mapping.
+    const char* map_pos = nullptr;         //!< Current read position in the mapping.
+    const char* map_end = nullptr;         //!< End of the mapping.
+
+    /** Read a line into buf, without the newline. */
+    void read_line(char* buf, size_t size);
+
+    /** Copy the next nbytes of the mapping into p, or skip them if p is null. */
+    void map_read(void* p, size_t nbytes) {
+        nrn_assert(nbytes <= size_t(map_end - map_pos));
+        if (p) {
+            memcpy(p, map_pos, nbytes);
+        }
+        map_pos += nbytes;
+    }
+
     /** Read a checkpoint line, bump our chkpnt counter, and assert equality.
      *
      * Checkpoint information is represented by a sequence "checkpt %d\n"
@@ -54,12 +77,17 @@ class FileHandler {
 
     explicit FileHandler(const std::string& filename);
 
-    /** Preserving chkpnt state, move to a new file. */
-    void open(const std::string& filename, std::ios::openmode mode = std::ios::in);
+    /** Preserving chkpnt state, move to a new file.
+     *
+     * With use_mmap, a file opened for reading only is memory mapped.
+     */
+    void open(const std::string& filename,
+              std::ios::openmode mode = std::ios::in,
+              bool use_mmap = false);
 
     /** Is the file not open */
     bool fail() const {
-        return F.fail();
+        return !mapped && F.fail();
     }
 
     bool file_exist(const std::string& filename) const;
@@ -115,7 +143,7 @@ class FileHandler {
         int nsec, nseg, n_scan;
         char line_buf[max_line_length], name[max_line_length];
 
-        F.getline(line_buf, sizeof(line_buf));
+        read_line(line_buf, sizeof(line_buf));
         n_scan = sscanf(line_buf, "%s %d %d", name, &nsec, &nseg);
 
         nrn_assert(n_scan == 3);
@@ -162,6 +190,10 @@ class FileHandler {
             nrn_assert(p != 0);
 
         read_checkpoint_assert();
+        if (mapped) {
+            map_read(flag == read ? p : nullptr, count * sizeof(T));
+            return p;
+        }
         switch (flag) {
             case seek:
                 F.seekg(count * sizeof(T), std::ios_base::cur);
@@ -196,6 +228,39 @@ class FileHandler {
         return vec;
     }
 
+    /** Read an array of cnt instances of sz items, stored instance after instance,
+     * into p with item j of instance i at p[i + j * stride] (SoA layout).
+     *
+     * When the file is mapped, items go straight from the mapping to p.
+     */
+    template <typename T>
+    inline T* read_array_transposed(T* p, size_t cnt, size_t sz, size_t stride) {
+        if (cnt * sz > 0)
+            nrn_assert(p != 0);
+
+        if (!mapped) {
+            std::vector<T> d(cnt * sz);
+            parse_array(d.data(), cnt * sz, read);
+            for (size_t i = 0; i < cnt; ++i) {
+                for (size_t j = 0; j < sz; ++j) {
+                    p[i + j * stride] = d[i * sz + j];
+                }
+            }
+            return p;
+        }
+
+        read_checkpoint_assert();
+        nrn_assert(cnt * sz * sizeof(T) <= size_t(map_end - map_pos));
+        const char* src = map_pos;
+        for (size_t i = 0; i < cnt; ++i) {
+            for (size_t j = 0; j < sz; ++j) {
+                memcpy(p + i + j * stride, src + (i * sz + j) * sizeof(T), sizeof(T));
+            }
+        }
+        map_pos += cnt * sz * sizeof(T);
+        return p;
+    }
+
     /** Close currently open file. */
     void close();
 
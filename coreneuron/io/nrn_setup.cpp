@@ -11,18 +11,26 @@
 #include <map>
 #include <cstring>
 #include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 #include "coreneuron/apps/corenrn_parameters.hpp"
 #include "coreneuron/nrnconf.h"
 #include "coreneuron/utils/randoms/nrnran123.h"
 #include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/sim/cell_blocks.hpp"
 #include "coreneuron/nrniv/nrniv_decl.h"
 #include "coreneuron/sim/fast_imem.hpp"
 #include "coreneuron/network/multisend.hpp"
+#include "coreneuron/network/sparse_exchange.hpp"
 #include "coreneuron/utils/nrn_assert.h"
 #include "coreneuron/utils/nrnmutdec.h"
 #include "coreneuron/utils/memory.h"
 #include "coreneuron/utils/utils.hpp"
+#include "coreneuron/utils/thread_affinity.hpp"
 #include "coreneuron/mpi/nrnmpi.h"
 #include "coreneuron/mpi/core/nrnmpi.hpp"
 #include "coreneuron/io/nrn_setup.hpp"
@@ -156,6 +164,7 @@ std::vector<std::map<int, PreSyn*>> neg_gid2out;
 /// Maps for ouput and input presyns
 std::map<int, PreSyn*> gid2out;
 std::map<int, InputPreSyn*> gid2in;
+Gid2InTable gid2in_table;
 
 /// InputPreSyn.nc_index_ to + InputPreSyn.nc_cnt_ give the NetCon*
 std::vector<NetCon*> netcon_in_presyn_order_;
@@ -344,6 +353,9 @@ void determine_inputpresyn() {
 
     inputpresyn_.clear();
 
+    // gid2in is complete, from now on spike delivery uses the flat table
+    gid2in_table.build(gid2in);
+
     // with gid to InputPreSyn and PreSyn maps we can setup the multisend
     // target lists.
     if (use_multisend_) {
@@ -351,6 +363,10 @@ void determine_inputpresyn() {
         nrn_multisend_setup();
 #endif
     }
+    // and the per destination send lists of the sparse exchange
+    if (use_sparse_exchange_) {
+        nrn_sparse_exchange_setup();
+    }
 
     // fill the netcon_in_presyn_order and recompute nc_cnt_
     // note that not all netcon_in_presyn will be filled if there are netcon
@@ -398,6 +414,84 @@ void nrn_setup_cleanup() {
     neg_gid2out.clear();
 }
 
+namespace coreneuron {
+/// Size of the worker pool reading the model files, see --setup-threads.
+/// By default all cores of the node are shared among its ranks, which can be
+/// more than the number of OpenMP threads used for the simulation.
+static int setup_pool_size() {
+    int n = corenrn_param.setup_threads;
+#if defined(_OPENMP)
+    if (n == 0) {
+        int local_size = 1;
+#if NRNMPI
+        if (corenrn_param.mpi_enable) {
+            local_size = nrnmpi_local_size();
+        }
+#endif
+        n = std::max(omp_get_max_threads(), omp_get_num_procs() / local_size);
+    }
+#endif
+    return std::max(n, 1);
+}
+
+/// Ask the kernel to start reading the files of phase P of all the cell groups,
+/// so that a group is already in the page cache when a worker gets to it.
+template <phase P>
+static void prefetch_phase_files(const UserParams& userParams) {
+    for (int i = 0; i < userParams.ngroup; ++i) {
+        int fd = ::open(phase_file_name<P>(userParams, i).c_str(), O_RDONLY);
+        if (fd >= 0) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            ::close(fd);
+        }
+    }
+}
+
+/// Read the files of phase P on the setup worker pool. The cell groups are
+/// handed out one at a time, independently of the thread owning the group.
+template <phase P>
+static void phase_pool(UserParams& userParams, int nworkers) {
+    // clang-format off
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(nworkers)
+    for (int i = 0; i < userParams.ngroup; ++i) {
+        RankAffinityScope affinity;
+        phase_wrapper_w<P>(nrn_threads + i, userParams, false);
+    }
+    // clang-format on
+}
+
+/// Phase2 from files: parsing of all the groups first on the setup worker pool,
+/// then each thread populates its own NrnThread with the mechanisms of the group
+/// spread over userParams.group_workers threads.
+static void phase2_pool(UserParams& userParams,
+                        int nworkers,
+                        double& read_time,
+                        double& populate_time) {
+    std::vector<Phase2> p2(userParams.ngroup);
+    read_time = nrn_wtime();
+    // clang-format off
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(nworkers)
+    for (int i = 0; i < userParams.ngroup; ++i) {
+        RankAffinityScope affinity;
+        auto& F = userParams.file_reader[i];
+        F.open(phase_file_name<phase::two>(userParams, i), std::ios::in, userParams.use_mmap);
+        p2[i].read_file(F, nrn_threads[i]);
+        F.close();
+    }
+    // clang-format on
+    read_time = nrn_wtime() - read_time;
+
+    populate_time = nrn_wtime();
+    nrn_multithread_job([&](NrnThread* nt) {
+        if (nt->id < userParams.ngroup) {
+            p2[nt->id].populate(*nt, userParams);
+            setup_ThreadData(*nt);
+        }
+    });
+    populate_time = nrn_wtime() - populate_time;
+}
+}  // namespace coreneuron
+
 void nrn_setup(const char* filesdat,
                bool is_mapping_needed,
                CheckPoints& checkPoints,
@@ -414,7 +508,20 @@ void nrn_setup(const char* filesdat,
                           gidgroups,
                           datpath,
                           strlen(restore_path) == 0 ? datpath : restore_path,
-                          checkPoints);
+                          checkPoints,
+                          corenrn_param.mmap_read);
+    // setup time of each stage, reported with --mmap or --verbose 3
+    enum {
+        prefetch,
+        phase1,
+        inputpresyn,
+        phase2_read,
+        phase2_populate,
+        gapjunctions,
+        phase3,
+        nstage
+    };
+    double stage_time[nstage] = {};
 
 
     // temporary bug work around. If any process has multiple threads, no
@@ -473,8 +580,29 @@ void nrn_setup(const char* filesdat,
     // of phase2.  So gap junction setup is deferred to after phase2.
 
     nrnthreads_netcon_negsrcgid_tid.resize(nrn_nthread);
+
+    // The files are read by a pool of setup workers that does not depend on
+    // nrn_nthread. With fewer groups than workers, the remaining workers help
+    // with the mechanisms of each group in Phase2::populate.
+    const int pool_size = coreneuron::setup_pool_size();
+    const int nworkers = std::min(pool_size, std::max(userParams.ngroup, 1));
+#if defined(_OPENMP)
+    const int max_active_levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(std::max(max_active_levels, 2));
+    const int nteam = std::min(omp_get_max_threads(), nrn_nthread);
+    userParams.group_workers = std::max(pool_size / nteam, 1);
+#endif
+
+    stage_time[prefetch] = nrn_wtime();
     if (!corenrn_embedded) {
-        coreneuron::phase_wrapper<coreneuron::phase::one>(userParams);
+        coreneuron::prefetch_phase_files<coreneuron::phase::one>(userParams);
+        coreneuron::prefetch_phase_files<coreneuron::phase::two>(userParams);
+    }
+    stage_time[prefetch] = nrn_wtime() - stage_time[prefetch];
+
+    stage_time[phase1] = nrn_wtime();
+    if (!corenrn_embedded) {
+        coreneuron::phase_pool<coreneuron::phase::one>(userParams, nworkers);
     } else {
         nrn_multithread_job([](NrnThread* n) {
             Phase1 p1{n->id};
@@ -486,21 +614,45 @@ void nrn_setup(const char* filesdat,
     // from the gid2out map and the nrnthreads_netcon_srcgid array,
     // fill the gid2in, and from the number of entries,
     // allocate the process wide InputPreSyn array
+    stage_time[phase1] = nrn_wtime() - stage_time[phase1];
+    stage_time[inputpresyn] = nrn_wtime();
     determine_inputpresyn();
+    stage_time[inputpresyn] = nrn_wtime() - stage_time[inputpresyn];
+
+    // the gap and phase3 files are needed next, start reading them while
+    // phase2 is being set up
+    if (!corenrn_embedded) {
+        if (nrn_have_gaps) {
+            coreneuron::prefetch_phase_files<coreneuron::gap>(userParams);
+        }
+        if (is_mapping_needed) {
+            coreneuron::prefetch_phase_files<coreneuron::phase::three>(userParams);
+        }
+    }
 
     // read the rest of the gidgroup's data and complete the setup for each
     // thread.
     /* nrn_multithread_job supports serial, pthread, and openmp. */
-    coreneuron::phase_wrapper<coreneuron::phase::two>(userParams, corenrn_embedded);
+    if (!corenrn_embedded) {
+        coreneuron::phase2_pool(userParams,
+                                nworkers,
+                                stage_time[phase2_read],
+                                stage_time[phase2_populate]);
+    } else {
+        stage_time[phase2_populate] = nrn_wtime();
+        coreneuron::phase_wrapper<coreneuron::phase::two>(userParams, corenrn_embedded);
+        stage_time[phase2_populate] = nrn_wtime() - stage_time[phase2_populate];
+    }
 
     // gap junctions
     // Gaps are done after phase2, in order to use layout and permutation
     // information via calls to stdindex2ptr.
+    stage_time[gapjunctions] = nrn_wtime();
     if (nrn_have_gaps) {
         nrn_partrans::transfer_thread_data_ = new nrn_partrans::TransferThreadData[nrn_nthread];
         if (!corenrn_embedded) {
             nrn_partrans::setup_info_ = new SetupTransferInfo[nrn_nthread];
-            coreneuron::phase_wrapper<coreneuron::gap>(userParams);
+            coreneuron::phase_pool<coreneuron::gap>(userParams, nworkers);
         } else {
             nrn_partrans::setup_info_ = (*nrn2core_get_partrans_setup_info_)(userParams.ngroup,
                                                                              nrn_nthread,
@@ -515,8 +667,16 @@ void nrn_setup(const char* filesdat,
         nrn_partrans::setup_info_ = nullptr;
     }
 
+    stage_time[gapjunctions] = nrn_wtime() - stage_time[gapjunctions];
+
+    stage_time[phase3] = nrn_wtime();
     if (is_mapping_needed)
-        coreneuron::phase_wrapper<coreneuron::phase::three>(userParams);
+        coreneuron::phase_pool<coreneuron::phase::three>(userParams, nworkers);
+    stage_time[phase3] = nrn_wtime() - stage_time[phase3];
+
+#if defined(_OPENMP)
+    omp_set_max_active_levels(max_active_levels);
+#endif
 
     *mindelay = set_mindelay(*mindelay);
 
@@ -552,6 +712,16 @@ void nrn_setup(const char* filesdat,
 
     if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
         printf(" Setup Done   : %.2lf seconds \n", nrn_wtime() - time);
+        if (corenrn_param.mmap_read || corenrn_param.verbose == corenrn_param.DEBUG) {
+            printf("   workers    : %d (%d per group)\n", nworkers, userParams.group_workers);
+            printf("   prefetch   : %.2lf seconds \n", stage_time[prefetch]);
+            printf("   phase1     : %.2lf seconds \n", stage_time[phase1]);
+            printf("   inputpresyn: %.2lf seconds \n", stage_time[inputpresyn]);
+            printf("   phase2 read: %.2lf seconds \n", stage_time[phase2_read]);
+            printf("   phase2 pop.: %.2lf seconds \n", stage_time[phase2_populate]);
+            printf("   gap        : %.2lf seconds \n", stage_time[gapjunctions]);
+            printf("   phase3     : %.2lf seconds \n", stage_time[phase3]);
+        }
 
         if (model_size_bytes < 1024) {
             printf(" Model size   : %ld bytes\n", model_size_bytes);
@@ -711,6 +881,7 @@ void nrn_cleanup_ion_map() {
 void nrn_cleanup() {
     clear_event_queue();  // delete left-over TQItem
     gid2in.clear();
+    gid2in_table.clear();
     gid2out.clear();
 
     // clean nrnthread_chkpnt
@@ -802,6 +973,11 @@ void nrn_cleanup() {
             nt->presyns_helper = nullptr;
         }
 
+        free_memory(nt->presyns_thvar_index);
+        nt->presyns_thvar_index = nullptr;
+        free_memory(nt->presyns_threshold);
+        nt->presyns_threshold = nullptr;
+
         if (nt->pntprocs) {
             free_memory(nt->pntprocs);
             nt->pntprocs = nullptr;
@@ -867,6 +1043,7 @@ void nrn_cleanup() {
 #if NRN_MULTISEND
     nrn_multisend_cleanup();
 #endif
+    nrn_sparse_exchange_cleanup();
 
     netcon_in_presyn_order_.clear();
 
@@ -878,6 +1055,8 @@ void nrn_cleanup() {
 
     destroy_interleave_info();
 
+    nrn_cell_blocks_cleanup();
+
     nrn_partrans::gap_cleanup();
 }
 
@@ -994,7 +1173,7 @@ size_t input_presyn_size(void) {
         return 0;
     }
     size_t nbyte = sizeof(gid2in) + sizeof(int) * gid2in.size() +
-                   sizeof(InputPreSyn*) * gid2in.size();
+                   sizeof(InputPreSyn*) * gid2in.size() + gid2in_table.bytes();
 #ifdef DEBUG
     printf(" gid2in table bytes=~%ld size=%d\n", nbyte, gid2in.size());
 #endif
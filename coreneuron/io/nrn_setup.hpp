@@ -99,23 +99,27 @@ inline void read_phase_aux<gap>(NrnThread& nt, UserParams& userParams) {
     read_phasegap(nt, userParams);
 }
 
+/// Name of the file of phase P for the cell group i
+template <phase P>
+inline std::string phase_file_name(const UserParams& userParams, int i) {
+    const char* data_dir = userParams.path;
+    // directory to read could be different for phase 2 if we are restoring
+    // all other phases still read from dataset directory because the data
+    // is constant
+    if (P == 2) {
+        data_dir = userParams.restore_path;
+    }
+    return std::string(data_dir) + "/" + std::to_string(userParams.gidgroups[i]) + "_" +
+           getPhaseName<P>() + ".dat";
+}
+
 /// Reading phase wrapper for each neuron group.
 template <phase P>
 inline void* phase_wrapper_w(NrnThread* nt, UserParams& userParams, bool in_memory_transfer) {
     int i = nt->id;
     if (i < userParams.ngroup) {
         if (!in_memory_transfer) {
-            const char* data_dir = userParams.path;
-            // directory to read could be different for phase 2 if we are restoring
-            // all other phases still read from dataset directory because the data
-            // is constant
-            if (P == 2) {
-                data_dir = userParams.restore_path;
-            }
-
-            std::string fname = std::string(data_dir) + "/" +
-                                std::to_string(userParams.gidgroups[i]) + "_" + getPhaseName<P>() +
-                                ".dat";
+            std::string fname = phase_file_name<P>(userParams, i);
 
             // Avoid trying to open the gid_gap.dat file if it doesn't exist when there are no
             // gap junctions in this gid
@@ -123,7 +127,7 @@ inline void* phase_wrapper_w(NrnThread* nt, UserParams& userParams, bool in_memo
                 userParams.file_reader[i].close();
             } else {
                 // if no file failed to open or not opened at all
-                userParams.file_reader[i].open(fname);
+                userParams.file_reader[i].open(fname, std::ios::in, userParams.use_mmap);
             }
         }
         read_phase_aux<P>(*nt, userParams);
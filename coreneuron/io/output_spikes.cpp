@@ -18,12 +18,12 @@
 #include "coreneuron/nrnconf.h"
 #include "coreneuron/io/nrn2core_direct.h"
 #include "coreneuron/io/output_spikes.hpp"
+#include "coreneuron/io/spike_file.hpp"
 #include "coreneuron/mpi/nrnmpi.h"
 #include "coreneuron/mpi/core/nrnmpi.hpp"
-#include "coreneuron/utils/nrnmutdec.h"
 #include "coreneuron/mpi/nrnmpidec.h"
-#include "coreneuron/utils/string_utils.h"
 #include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/sim/multicore.hpp"
 #ifdef ENABLE_SONATA_REPORTS
 #include "bbp/sonata/reports.h"
 #endif  // ENABLE_SONATA_REPORTS
@@ -45,54 +45,153 @@ namespace coreneuron {
 std::vector<double> spikevec_time;
 std::vector<int> spikevec_gid;
 
-static OMP_Mutex mut;
+/// Spikes recorded by one thread since the last spikevec_merge. Aligned so that
+/// threads appending to their own buffer do not share cache lines.
+struct alignas(64) SpikeRecordBuffer {
+    std::vector<double> time;
+    std::vector<int> gid;
+};
+/// nrn_nthread of them
+static std::vector<SpikeRecordBuffer> spikevec_thread;
+
+/// Spikes per block of the binary spike file
+static constexpr std::size_t spike_file_block_size = 1 << 20;
 
 void mk_spikevec_buffer(int sz) {
+    spikevec_thread.resize(std::max(nrn_nthread, 1));
     try {
         spikevec_time.reserve(sz);
         spikevec_gid.reserve(sz);
+        std::size_t thread_sz = sz / spikevec_thread.size();
+        for (auto& buf: spikevec_thread) {
+            buf.time.reserve(thread_sz);
+            buf.gid.reserve(thread_sz);
+        }
     } catch (const std::length_error& le) {
         std::cerr << "Lenght error" << le.what() << std::endl;
     }
 }
 
-void spikevec_lock() {
-    mut.lock();
+void spikevec_record(int tid, int gid, double tt) {
+    SpikeRecordBuffer& buf = spikevec_thread[tid];
+    buf.time.push_back(tt);
+    buf.gid.push_back(gid);
 }
 
-void spikevec_unlock() {
-    mut.unlock();
+void spikevec_merge() {
+    for (auto& buf: spikevec_thread) {
+        spikevec_time.insert(spikevec_time.end(), buf.time.begin(), buf.time.end());
+        spikevec_gid.insert(spikevec_gid.end(), buf.gid.begin(), buf.gid.end());
+        buf.time.clear();
+        buf.gid.clear();
+    }
 }
 
+/** Sort by time then gid, keeping the order of equal spikes.
+ *  The input is split into its ascending runs, one per thread of the
+ *  spikevec_merge or per rank of sort_spikes in practice, and these are merged
+ *  with a heap of the run heads instead of sorting everything again.
+ */
 void local_spikevec_sort(std::vector<double>& isvect,
                          std::vector<int>& isvecg,
                          std::vector<double>& osvect,
                          std::vector<int>& osvecg) {
-    osvect.resize(isvect.size());
-    osvecg.resize(isvecg.size());
-    // first build a permutation vector
-    std::vector<std::size_t> perm(isvect.size());
-    std::iota(perm.begin(), perm.end(), 0);
-    // sort by gid (second predicate first)
-    std::stable_sort(perm.begin(), perm.end(), [&](std::size_t i, std::size_t j) {
-        return isvecg[i] < isvecg[j];
-    });
-    // then sort by time
-    std::stable_sort(perm.begin(), perm.end(), [&](std::size_t i, std::size_t j) {
-        return isvect[i] < isvect[j];
-    });
-    // now apply permutation to time and gid output vectors
-    std::transform(perm.begin(), perm.end(), osvect.begin(), [&](std::size_t i) {
-        return isvect[i];
-    });
-    std::transform(perm.begin(), perm.end(), osvecg.begin(), [&](std::size_t i) {
-        return isvecg[i];
-    });
+    std::size_t n = isvect.size();
+    osvect.resize(n);
+    osvecg.resize(n);
+    auto before = [&](std::size_t i, std::size_t j) {
+        return isvect[i] < isvect[j] || (isvect[i] == isvect[j] && isvecg[i] < isvecg[j]);
+    };
+    // cursor and end of each run, the runs being in input order
+    std::vector<std::pair<std::size_t, std::size_t>> runs;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i == 0 || before(i, i - 1)) {
+            if (!runs.empty()) {
+                runs.back().second = i;
+            }
+            runs.emplace_back(i, n);
+        }
+    }
+    if (runs.size() == 1) {
+        std::copy(isvect.begin(), isvect.end(), osvect.begin());
+        std::copy(isvecg.begin(), isvecg.end(), osvecg.begin());
+        return;
+    }
+    // min-heap of run indices on their current head, ties go to the earlier run
+    auto later = [&](std::size_t a, std::size_t b) {
+        std::size_t i = runs[a].first;
+        std::size_t j = runs[b].first;
+        return before(j, i) || (!before(i, j) && b < a);
+    };
+    std::vector<std::size_t> heap(runs.size());
+    std::iota(heap.begin(), heap.end(), 0);
+    std::make_heap(heap.begin(), heap.end(), later);
+    for (std::size_t k = 0; k < n; ++k) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        auto& run = runs[heap.back()];
+        osvect[k] = isvect[run.first];
+        osvecg[k] = isvecg[run.first];
+        if (++run.first < run.second) {
+            std::push_heap(heap.begin(), heap.end(), later);
+        } else {
+            heap.pop_back();
+        }
+    }
+}
+
+/** Pack time sorted spikes as binary blocks into spike_data.
+ *  With header, the file header is written in front of the blocks.
+ */
+static void pack_spikes_binary(const std::vector<double>& time,
+                               const std::vector<int>& gid,
+                               bool header,
+                               std::vector<char>& spike_data) {
+    std::size_t num_spikes = gid.size();
+    std::size_t num_bytes = header ? sizeof(SpikeFileHeader) : 0;
+    for (std::size_t i = 0; i < num_spikes; i += spike_file_block_size) {
+        num_bytes += spike_block_bytes(std::min(spike_file_block_size, num_spikes - i));
+    }
+    spike_data.resize(num_bytes);
+    char* pos = spike_data.data();
+    if (header) {
+        SpikeFileHeader file_header = make_spike_file_header();
+        std::memcpy(pos, &file_header, sizeof(file_header));
+        pos += sizeof(file_header);
+    }
+    for (std::size_t i = 0; i < num_spikes; i += spike_file_block_size) {
+        std::size_t n = std::min(spike_file_block_size, num_spikes - i);
+        pos = pack_spike_block(pos, &time[i], &gid[i], n);
+    }
+}
+
+/// Format time sorted spikes as out.dat lines into spike_data
+static void pack_spikes_text(const std::vector<double>& time,
+                             const std::vector<int>& gid,
+                             std::vector<char>& spike_data) {
+    // each spike record in the file is time + gid (64 chars sufficient)
+    const int SPIKE_RECORD_LEN = 64;
+    std::size_t num_spikes = gid.size();
+    spike_data.resize(num_spikes * SPIKE_RECORD_LEN);
+    std::size_t num_chars = 0;
+    for (std::size_t i = 0; i < num_spikes; i++) {
+        num_chars +=
+            snprintf(&spike_data[num_chars], SPIKE_RECORD_LEN, "%.8g\t%d\n", time[i], gid[i]);
+    }
+    spike_data.resize(num_chars);
 }
 
 #if NRNMPI
 
 void sort_spikes(std::vector<double>& spikevec_time, std::vector<int>& spikevec_gid) {
+    // every rank sends a contiguous time range to each rank, so the local spikes
+    // are sorted first and the received ones are a sorted run per sender
+    {
+        std::vector<double> time;
+        std::vector<int> gid;
+        local_spikevec_sort(spikevec_time, spikevec_gid, time, gid);
+        spikevec_time.swap(time);
+        spikevec_gid.swap(gid);
+    }
     double lmin_time = std::numeric_limits<double>::max();
     double lmax_time = std::numeric_limits<double>::min();
     if (!spikevec_time.empty()) {
@@ -113,6 +212,8 @@ void sort_spikes(std::vector<double>& spikevec_time, std::vector<int>& spikevec_
     // first find number of spikes in each time window
     for (const auto& st: spikevec_time) {
         int idx = (int) (st - min_time) / bin_t;
+        // the latest spikes fall exactly on the upper bound of the last bin
+        idx = std::min(idx, nrnmpi_numprocs - 1);
         snd_cnts[idx]++;
     }
     for (int i = 1; i < nrnmpi_numprocs; i++) {
@@ -194,15 +295,17 @@ void output_spike_populations(
 }
 #endif  // ENABLE_SONATA_REPORTS
 
-/** Write generated spikes to out.dat using mpi parallel i/o.
+/** Write generated spikes to out.dat (or out.spk in binary format) using mpi parallel i/o.
+ *  After sort_spikes every rank holds a contiguous time range, so each rank
+ *  writes its own part at its offset in the file with a single collective write.
  *  \todo : MPI related code should be factored into nrnmpi.c
- *          Check spike record length which is set to 64 chars
  */
 void output_spikes_parallel(
     const char* outpath,
     const std::vector<std::pair<std::string, int>>& population_name_offset) {
+    bool binary = corenrn_param.spikes_format == "binary";
     std::stringstream ss;
-    ss << outpath << "/out.dat";
+    ss << outpath << (binary ? "/out.spk" : "/out.dat");
     std::string fname = ss.str();
 
     // remove if file already exist
@@ -219,43 +322,52 @@ void output_spikes_parallel(
     sort_spikes(spikevec_time, spikevec_gid);
     nrnmpi_barrier();
 
-    // each spike record in the file is time + gid (64 chars sufficient)
-    const int SPIKE_RECORD_LEN = 64;
-    unsigned num_spikes = spikevec_gid.size();
-    unsigned num_bytes = (sizeof(char) * num_spikes * SPIKE_RECORD_LEN);
-    char* spike_data = (char*) malloc(num_bytes);
-
-    if (spike_data == nullptr) {
-        printf("Error while writing spikes due to memory allocation\n");
-        return;
+    std::vector<char> spike_data;
+    if (binary) {
+        pack_spikes_binary(spikevec_time, spikevec_gid, nrnmpi_myid == 0, spike_data);
+    } else {
+        pack_spikes_text(spikevec_time, spikevec_gid, spike_data);
     }
+    nrnmpi_write_file(fname, spike_data.data(), spike_data.size());
+}
+#endif
 
-    // empty if no spikes
-    strcpy(spike_data, "");
-
-    // populate buffer with all spike entries
-    char spike_entry[SPIKE_RECORD_LEN];
-    unsigned spike_data_offset = 0;
-    for (unsigned i = 0; i < num_spikes; i++) {
-        int spike_entry_chars =
-            snprintf(spike_entry, 64, "%.8g\t%d\n", spikevec_time[i], spikevec_gid[i]);
-        spike_data_offset =
-            strcat_at_pos(spike_data, spike_data_offset, spike_entry, spike_entry_chars);
+static void output_spikes_serial_binary(const std::string& fname,
+                                        std::vector<double>& sorted_spikevec_time,
+                                        std::vector<int>& sorted_spikevec_gid) {
+    // drop the invalid gids, like the text output does
+    std::size_t num_spikes = 0;
+    for (std::size_t i = 0; i < sorted_spikevec_gid.size(); ++i) {
+        if (sorted_spikevec_gid[i] > -1) {
+            sorted_spikevec_time[num_spikes] = sorted_spikevec_time[i];
+            sorted_spikevec_gid[num_spikes] = sorted_spikevec_gid[i];
+            ++num_spikes;
+        }
     }
 
-    // calculate offset into global file. note that we don't write
-    // all num_bytes but only "populated" buffer
-    unsigned long num_chars = strlen(spike_data);
+    FILE* f = fopen(fname.c_str(), "wb");
+    if (!f) {
+        std::cout << "WARNING: Could not open file for writing spikes." << std::endl;
+        return;
+    }
 
-    nrnmpi_write_file(fname, spike_data, num_chars);
+    SpikeFileHeader header = make_spike_file_header();
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    for (std::size_t i = 0; ok && i < num_spikes; i += spike_file_block_size) {
+        std::size_t n = std::min(spike_file_block_size, num_spikes - i);
+        ok = write_spike_block(f, &sorted_spikevec_time[i], &sorted_spikevec_gid[i], n);
+    }
+    if (!ok) {
+        std::cout << "WARNING: Error while writing spikes to " << fname << std::endl;
+    }
 
-    free(spike_data);
+    fclose(f);
 }
-#endif
 
 void output_spikes_serial(const char* outpath) {
+    bool binary = corenrn_param.spikes_format == "binary";
     std::stringstream ss;
-    ss << outpath << "/out.dat";
+    ss << outpath << (binary ? "/out.spk" : "/out.dat");
     std::string fname = ss.str();
 
     // reserve some space for sorted spikevec buffers
@@ -266,6 +378,11 @@ void output_spikes_serial(const char* outpath) {
     // remove if file already exist
     remove(fname.c_str());
 
+    if (binary) {
+        output_spikes_serial_binary(fname, sorted_spikevec_time, sorted_spikevec_gid);
+        return;
+    }
+
     FILE* f = fopen(fname.c_str(), "w");
     if (!f && nrnmpi_myid == 0) {
         std::cout << "WARNING: Could not open file for writing spikes." << std::endl;
@@ -279,13 +396,161 @@ void output_spikes_serial(const char* outpath) {
     fclose(f);
 }
 
+/// --> Spike output streamed during the simulation
+struct SpikeStream {
+    bool active = false;
+    bool binary = false;
+    bool parallel = false;         /// Written with MPI i/o by all ranks
+    bool header_written = false;   /// Binary file header already written
+    double tflush = 0.;            /// Time of the next flush
+    FILE* file = nullptr;          /// Output file of serial runs
+    int mpi_stream = -1;           /// Output stream of parallel runs
+    std::vector<char> buffers[2];  /// Packed spikes, alternately written while computing
+    int slot = 0;                  /// Buffer used by the next flush
+};
+static SpikeStream spike_stream;
+
+std::size_t spikevec_flushed = 0;
+
+void output_spikes_stream_open(const char* outpath) {
+    if (corenrn_param.spikes_flush == 0) {
+        return;
+    }
+    // NEURON gets all spikes at the end and SONATA writes them at once
+    if (corenrn_embedded && nrn2core_all_spike_vectors_return_) {
+        return;
+    }
+#ifdef ENABLE_SONATA_REPORTS
+    return;
+#endif
+    spike_stream = SpikeStream{};
+    spike_stream.binary = corenrn_param.spikes_format == "binary";
+    std::stringstream ss;
+    ss << outpath << (spike_stream.binary ? "/out.spk" : "/out.dat");
+    std::string fname = ss.str();
+#if NRNMPI
+    if (corenrn_param.mpi_enable && nrnmpi_initialized()) {
+        spike_stream.parallel = true;
+        // remove if file already exist
+        if (nrnmpi_myid == 0) {
+            remove(fname.c_str());
+        }
+        nrnmpi_barrier();
+        spike_stream.mpi_stream = nrnmpi_file_stream_open(fname);
+    } else
+#endif
+    {
+        remove(fname.c_str());
+        spike_stream.file = fopen(fname.c_str(), spike_stream.binary ? "wb" : "w");
+        if (!spike_stream.file) {
+            std::cout << "WARNING: Could not open file for writing spikes." << std::endl;
+            return;
+        }
+    }
+    spikevec_flushed = 0;
+    spike_stream.tflush = t + corenrn_param.spikes_flush * corenrn_param.mindelay;
+    spike_stream.active = true;
+}
+
+/** Write the recorded spikes earlier than tcut and remove them from spikevec.
+ *  Every call appends a globally sorted chunk, so that the file is the same
+ *  as the one written at the end by output_spikes.
+ */
+static void output_spikes_stream_write(double tcut) {
+    spikevec_merge();
+    std::vector<double> time;
+    std::vector<int> gid;
+    std::size_t nkeep = 0;
+    for (std::size_t i = 0; i < spikevec_gid.size(); ++i) {
+        if (spikevec_time[i] < tcut) {
+            time.push_back(spikevec_time[i]);
+            gid.push_back(spikevec_gid[i]);
+        } else {
+            spikevec_time[nkeep] = spikevec_time[i];
+            spikevec_gid[nkeep] = spikevec_gid[i];
+            ++nkeep;
+        }
+    }
+    // keeps capacity, so memory stays bounded by the spikes of one flush period
+    spikevec_time.resize(nkeep);
+    spikevec_gid.resize(nkeep);
+    spikevec_flushed += gid.size();
+
+    bool header = spike_stream.binary && !spike_stream.header_written && nrnmpi_myid == 0;
+    spike_stream.header_written = true;
+    std::vector<char>& spike_data = spike_stream.buffers[spike_stream.slot];
+#if NRNMPI
+    if (spike_stream.parallel) {
+        sort_spikes(time, gid);
+        // the write started two flushes ago from this buffer must be done
+        nrnmpi_file_stream_wait(spike_stream.mpi_stream, spike_stream.slot);
+    } else
+#endif
+    {
+        std::vector<double> sorted_time(time.size());
+        std::vector<int> sorted_gid(gid.size());
+        local_spikevec_sort(time, gid, sorted_time, sorted_gid);
+        time.swap(sorted_time);
+        gid.swap(sorted_gid);
+    }
+
+    if (spike_stream.binary) {
+        pack_spikes_binary(time, gid, header, spike_data);
+    } else {
+        pack_spikes_text(time, gid, spike_data);
+    }
+
+#if NRNMPI
+    if (spike_stream.parallel) {
+        nrnmpi_file_stream_write(
+            spike_stream.mpi_stream, spike_stream.slot, spike_data.data(), spike_data.size());
+        spike_stream.slot ^= 1;
+        return;
+    }
+#endif
+    if (fwrite(spike_data.data(), 1, spike_data.size(), spike_stream.file) != spike_data.size()) {
+        std::cout << "WARNING: Error while writing spikes." << std::endl;
+    }
+    fflush(spike_stream.file);
+}
+
+void output_spikes_flush(double tt) {
+    // t is the same on all ranks, so they all take part in the collective write
+    if (!spike_stream.active || tt < spike_stream.tflush - 0.5 * dt) {
+        return;
+    }
+    spike_stream.tflush = tt + corenrn_param.spikes_flush * corenrn_param.mindelay;
+    // spikes of the next intervals are recorded after tt - dt
+    output_spikes_stream_write(tt - dt);
+}
+
+/// Write the remaining spikes and close the file
+static void output_spikes_stream_close() {
+    output_spikes_stream_write(std::numeric_limits<double>::infinity());
+#if NRNMPI
+    if (spike_stream.parallel) {
+        nrnmpi_file_stream_close(spike_stream.mpi_stream);
+    } else
+#endif
+    {
+        fclose(spike_stream.file);
+    }
+    spike_stream = SpikeStream{};
+}
+
 void output_spikes(const char* outpath,
                    const std::vector<std::pair<std::string, int>>& population_name_offset) {
+    spikevec_merge();
     // try to transfer spikes to NEURON. If successfull, don't write out.dat
     if (all_spikes_return(spikevec_time, spikevec_gid)) {
         clear_spike_vectors();
         return;
     }
+    if (spike_stream.active) {
+        output_spikes_stream_close();
+        clear_spike_vectors();
+        return;
+    }
 #if NRNMPI
     if (corenrn_param.mpi_enable && nrnmpi_initialized()) {
         output_spikes_parallel(outpath, population_name_offset);
@@ -304,9 +569,14 @@ void clear_spike_vectors() {
     spikevec_gid.clear();
     spikevec_time.reserve(spikevec_time_capacity);
     spikevec_gid.reserve(spikevec_gid_capacity);
+    for (auto& buf: spikevec_thread) {
+        buf.time.clear();
+        buf.gid.clear();
+    }
 }
 
 void validation(std::vector<std::pair<double, int>>& res) {
+    spikevec_merge();
     for (unsigned i = 0; i < spikevec_gid.size(); ++i)
         if (spikevec_gid[i] > -1)
             res.push_back(std::make_pair(spikevec_time[i], spikevec_gid[i]));
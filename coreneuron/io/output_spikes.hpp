@@ -9,21 +9,37 @@
 #ifndef output_spikes_h
 #define output_spikes_h
 
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <utility>
 namespace coreneuron {
 void output_spikes(const char* outpath,
                    const std::vector<std::pair<std::string, int>>& population_name_offset);
+/// Start writing spikes during the simulation if requested by --spikes-flush
+void output_spikes_stream_open(const char* outpath);
+/// Called at the end of each min delay interval at time tt, writes the spikes every
+/// --spikes-flush intervals. Collective across ranks.
+void output_spikes_flush(double tt);
 void mk_spikevec_buffer(int);
 
+/// Spikes of this rank, filled from the per thread buffers by spikevec_merge
 extern std::vector<double> spikevec_time;
 extern std::vector<int> spikevec_gid;
+/// Number of local spikes already written and removed from spikevec
+extern std::size_t spikevec_flushed;
+
+/// Record a spike in the buffer of thread tid, without locking
+void spikevec_record(int tid, int gid, double tt);
+/// Move the spikes of the per thread buffers to spikevec, outside of parallel regions
+void spikevec_merge();
+/// Sort spikes by time then gid, merging the already sorted runs of the input
+void local_spikevec_sort(std::vector<double>& isvect,
+                         std::vector<int>& isvecg,
+                         std::vector<double>& osvect,
+                         std::vector<int>& osvecg);
 
 void clear_spike_vectors();
 void validation(std::vector<std::pair<double, int>>& res);
-
-void spikevec_lock();
-void spikevec_unlock();
 }  // namespace coreneuron
 #endif
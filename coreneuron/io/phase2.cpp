@@ -6,15 +6,20 @@
 # =============================================================================
 */
 
+#include <algorithm>
+
 #include "coreneuron/io/phase2.hpp"
 #include "coreneuron/coreneuron.hpp"
+#include "coreneuron/network/netcvode.hpp"
 #include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/sim/cell_blocks.hpp"
 #include "coreneuron/io/nrn_checkpoint.hpp"
 #include "coreneuron/utils/nrnoc_aux.hpp"
 #include "coreneuron/permute/cellorder.hpp"
 #include "coreneuron/permute/data_layout.hpp"
 #include "coreneuron/permute/node_permute.h"
 #include "coreneuron/utils/utils.hpp"
+#include "coreneuron/utils/thread_affinity.hpp"
 #include "coreneuron/utils/vrecitem.h"
 #include "coreneuron/io/mem_layout_util.hpp"
 #include "coreneuron/io/setup_fornetcon.hpp"
@@ -101,7 +106,20 @@ inline void mech_data_layout_transform(T* data, int cnt, int sz, int layout) {
     }
 }
 
+/// Copy of p in memory first touched by the calling thread, hence on its NUMA node. p is freed.
+template <typename T>
+static T* first_touch_copy(T* p, std::size_t n) {
+    if (!p) {
+        return p;
+    }
+    T* copy = static_cast<T*>(emalloc_align(n * sizeof(T)));
+    std::copy(p, p + n, copy);
+    free_memory(p);
+    return copy;
+}
+
 void Phase2::read_file(FileHandler& F, const NrnThread& nt) {
+    mech_data_in_layout = true;
     n_output = F.read_int();
     n_real_output = F.read_int();
     n_node = F.read_int();
@@ -126,7 +144,7 @@ void Phase2::read_file(FileHandler& F, const NrnThread& nt) {
     int n_data_padded = nrn_soa_padded_size(n_node, SOA_LAYOUT);
     {
         {  // Compute size of _data and allocate
-            int n_data = 6 * n_data_padded;
+            n_data = 6 * n_data_padded;
             if (n_diam > 0) {
                 n_data += n_data_padded;
             }
@@ -162,7 +180,12 @@ void Phase2::read_file(FileHandler& F, const NrnThread& nt) {
         if (!corenrn.get_is_artificial()[mech_types[i]]) {
             nodeindices = F.read_vector<int>(n);
         }
-        F.read_array<double>(_data + offset, sz * n);
+        if (layout == Layout::SoA) {
+            // straight into the final layout, populate does not transform it again
+            F.read_array_transposed<double>(_data + offset, n, sz, nrn_soa_padded_size(n, layout));
+        } else {
+            F.read_array<double>(_data + offset, sz * n);
+        }
         offset += nrn_soa_padded_size(n, layout) * sz;
         std::vector<int> pdata;
         if (dsz > 0) {
@@ -264,7 +287,7 @@ void Phase2::read_direct(int thread_id, const NrnThread& nt) {
 
     // TODO: fix it in the future
     int n_data_padded = nrn_soa_padded_size(n_node, SOA_LAYOUT);
-    int n_data = 6 * n_data_padded;
+    n_data = 6 * n_data_padded;
     if (n_diam > 0) {
         n_data += n_data_padded;
     }
@@ -919,6 +942,13 @@ void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
     else
         nt._vdata = nullptr;
 
+    // read_file ran on any of the setup workers, move the data to the NUMA node
+    // of this thread, the one that integrates the group
+    if (mech_data_in_layout) {
+        _data = first_touch_copy(_data, n_data);
+        v_parent_index = first_touch_copy(v_parent_index, n_node);
+    }
+
     // The data format begins with the matrix data
     int n_data_padded = nrn_soa_padded_size(nt.end, SOA_LAYOUT);
     nt._data = _data;
@@ -975,11 +1005,36 @@ void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
     int synoffset = 0;
     std::vector<int> pnt_offset(memb_func.size());
 
+    // The mechanisms are independent from here on, so their data is spread over
+    // the setup workers of this group.
+    std::vector<NrnThreadMembList*> tml_vec;
+    for (auto tml = nt.tml; tml; tml = tml->next) {
+        tml_vec.push_back(tml);
+    }
+    const int ntml = tml_vec.size();
+
+    // Allocated and zeroed, i.e. first touched, by this thread and only filled by
+    // the workers, so that they are on the NUMA node of this thread
+    for (int itml = 0; itml < ntml; ++itml) {
+        Memb_list* ml = tml_vec[itml]->ml;
+        int type = tml_vec[itml]->index;
+        int szdp = nrn_prop_dparam_size_[type];
+        int layout = corenrn.get_mech_data_layout()[type];
+        ml->nodeindices = (int*) ecalloc_align(ml->nodecount, sizeof(int));
+        if (szdp) {
+            ml->pdata = (int*) ecalloc_align(nrn_soa_padded_size(ml->nodecount, layout) * szdp,
+                                             sizeof(int));
+        }
+    }
+
     // All the mechanism data and pdata.
-    // Also fill in the pnt_offset
-    // Complete spec of Point_process except for the acell presyn_ field.
-    int itml = 0;
-    for (auto tml = nt.tml; tml; tml = tml->next, ++itml) {
+    // clang-format off
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(userParams.group_workers) \
+                             if (userParams.group_workers > 1)
+    // clang-format on
+    for (int itml = 0; itml < ntml; ++itml) {
+        RankAffinityScope affinity(userParams.group_workers > 1);
+        auto tml = tml_vec[itml];
         int type = tml->index;
         Memb_list* ml = tml->ml;
         int n = ml->nodecount;
@@ -987,13 +1042,13 @@ void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
         int szdp = nrn_prop_dparam_size_[type];
         int layout = corenrn.get_mech_data_layout()[type];
 
-        ml->nodeindices = (int*) ecalloc_align(ml->nodecount, sizeof(int));
         std::copy(tmls[itml].nodeindices.begin(), tmls[itml].nodeindices.end(), ml->nodeindices);
 
-        mech_data_layout_transform<double>(ml->data, n, szp, layout);
+        if (!mech_data_in_layout) {
+            mech_data_layout_transform<double>(ml->data, n, szp, layout);
+        }
 
         if (szdp) {
-            ml->pdata = (int*) ecalloc_align(nrn_soa_padded_size(n, layout) * szdp, sizeof(int));
             std::copy(tmls[itml].pdata.begin(), tmls[itml].pdata.end(), ml->pdata);
             mech_data_layout_transform<int>(ml->pdata, n, szdp, layout);
 
@@ -1018,6 +1073,15 @@ void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
         } else {
             ml->pdata = nullptr;
         }
+    }
+
+    // Fill in the pnt_offset
+    // Complete spec of Point_process except for the acell presyn_ field.
+    for (auto tml: tml_vec) {
+        int type = tml->index;
+        Memb_list* ml = tml->ml;
+        int szdp = nrn_prop_dparam_size_[type];
+        int layout = corenrn.get_mech_data_layout()[type];
         if (corenrn.get_pnt_map()[type] > 0) {  // POINT_PROCESS mechanism including acell
             int cnt = ml->nodecount;
             Point_process* pnt = nullptr;
@@ -1052,6 +1116,9 @@ void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
     */
     if (interleave_permute_type) {
         nt._permute = interleave_order(nt.id, nt.ncell, nt.end, nt._v_parent_index);
+    } else if (nrn_cell_blocks) {
+        // the cell blocks need the nodes of every cell together
+        nt._permute = cell_contiguous_order(nt.ncell, nt.end, nt._v_parent_index);
     }
     if (nt._permute) {
         int* p = nt._permute;
@@ -1075,10 +1142,25 @@ void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
 #endif
 
         // specify the ml->_permute and sort the nodeindices
-        for (auto tml = nt.tml; tml; tml = tml->next) {
-            if (tml->ml->nodeindices) {  // not artificial
-                permute_nodeindices(tml->ml, p);
-                permute_ml(tml->ml, tml->index, nt);
+        // clang-format off
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(userParams.group_workers) \
+                                 if (userParams.group_workers > 1)
+        // clang-format on
+        for (int itml = 0; itml < ntml; ++itml) {
+            RankAffinityScope affinity(userParams.group_workers > 1);
+            if (tml_vec[itml]->ml->nodeindices) {  // not artificial
+                permute_nodeindices(tml_vec[itml]->ml, p);
+            }
+        }
+        // permute_ml needs the _permute of the ions used by a mechanism
+        // clang-format off
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(userParams.group_workers) \
+                                 if (userParams.group_workers > 1)
+        // clang-format on
+        for (int itml = 0; itml < ntml; ++itml) {
+            RankAffinityScope affinity(userParams.group_workers > 1);
+            if (tml_vec[itml]->ml->nodeindices) {  // not artificial
+                permute_ml(tml_vec[itml]->ml, tml_vec[itml]->index, nt);
             }
         }
 
@@ -1172,6 +1254,8 @@ void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
         }
     }
 
+    nrn_threshold_table_setup(nt);
+
     // initial net_send_buffer size about 1% of number of presyns
     // nt._net_send_buffer_size = nt.ncell/100 + 1;
     // but, to avoid reallocation complexity on GPU ...
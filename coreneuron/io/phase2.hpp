@@ -107,6 +107,8 @@ class Phase2 {
     std::vector<double> actual_diam;
     */
     double* _data;
+    std::size_t n_data = 0;            // size of _data
+    bool mech_data_in_layout = false;  // mechanism data already in SoA/AoS layout (read_file)
     struct TML {
         std::vector<int> nodeindices;
         std::vector<int> pdata;
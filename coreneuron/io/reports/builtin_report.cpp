@@ -0,0 +1,268 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "coreneuron/io/reports/builtin_report.hpp"
+#include "coreneuron/io/reports/report_file.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/mpi/core/nrnmpi.hpp"
+#include "coreneuron/mpi/nrnmpidec.h"
+#include "coreneuron/utils/nrn_assert.h"
+#include "coreneuron/utils/utils.hpp"
+
+namespace coreneuron {
+
+namespace {
+/// Rows of one chunk, for the columns of this rank
+struct ReportChunk {
+    long index = -1;
+    std::vector<float> values;
+};
+
+struct BuiltinReport {
+    std::string name;
+    double dt;
+    double tstart;
+    double tstop;
+    double report_dt;
+    int buffer_size;
+    long start_step = 0;     /// simulation step of the first row
+    long steps_per_row = 1;  /// simulation steps between two rows
+    ReportFileHeader header;
+    std::uint64_t nchunk = 0;
+    std::uint64_t next_chunk = 0;  /// first chunk not written yet
+    /// variables in the order they were added
+    std::vector<std::pair<ReportColumn, double*>> vars;
+    /// after builtin_report_setup, the variables of the columns of this rank
+    std::vector<double*> values;
+    /// range of columns of each gid
+    std::unordered_map<int, std::pair<std::size_t, std::size_t>> gid_columns;
+    std::vector<char> layout;  /// header and column block, kept until the file is closed
+    ReportChunk chunks[2];     /// chunk c is filled in chunks[c % 2]
+    bool parallel = false;     /// written with MPI i/o by all ranks
+    FILE* file = nullptr;      /// output file of serial runs
+    int mpi_stream = -1;       /// output stream of parallel runs
+};
+}  // namespace
+
+static std::vector<BuiltinReport> builtin_reports;
+static int buffer_size_hint = -1;
+
+static BuiltinReport& find_report(const std::string& name) {
+    auto it = std::find_if(builtin_reports.begin(),
+                           builtin_reports.end(),
+                           [&name](const BuiltinReport& r) { return r.name == name; });
+    nrn_assert(it != builtin_reports.end());
+    return *it;
+}
+
+static void write_bytes(BuiltinReport& report, int slot, const char* data, std::size_t length) {
+#if NRNMPI
+    if (report.parallel) {
+        nrnmpi_file_stream_write(report.mpi_stream, slot, data, length);
+        return;
+    }
+#endif
+    if (fwrite(data, 1, length, report.file) != length) {
+        std::cerr << "[ERROR] could not write report " << report.name << std::endl;
+        nrn_abort(1);
+    }
+}
+
+/// Buffer of chunk c, cleared when the chunk is used for the first time
+static ReportChunk& get_chunk(BuiltinReport& report, std::uint64_t c) {
+    int slot = c % 2;
+    ReportChunk& chunk = report.chunks[slot];
+    if (chunk.index != static_cast<long>(c)) {
+        // the chunk previously in this buffer must have been written, and
+        // its write completed before the buffer is reused
+        nrn_assert(chunk.index < static_cast<long>(report.next_chunk));
+#if NRNMPI
+        if (report.parallel) {
+            nrnmpi_file_stream_wait(report.mpi_stream, slot);
+        }
+#endif
+        chunk.index = c;
+        chunk.values.assign(report.header.chunk_rows * report.values.size(), 0.f);
+    }
+    return chunk;
+}
+
+/// Start the write of the next chunk, left to complete while computing
+static void write_next_chunk(BuiltinReport& report) {
+    std::uint64_t c = report.next_chunk;
+    const ReportChunk& chunk = get_chunk(report, c);
+    std::size_t n = report_chunk_rows(report.header, c) * report.values.size();
+    write_bytes(report, c % 2, reinterpret_cast<const char*>(chunk.values.data()), n * sizeof(float));
+    report.next_chunk++;
+}
+
+void builtin_report_create(const std::string& name,
+                           double dt,
+                           double tstart,
+                           double tstop,
+                           double report_dt,
+                           int buffer_size) {
+    BuiltinReport report;
+    report.name = name;
+    report.dt = dt;
+    report.tstart = tstart;
+    report.tstop = tstop;
+    report.report_dt = report_dt;
+    report.buffer_size = buffer_size;
+    builtin_reports.push_back(std::move(report));
+}
+
+void builtin_report_add_var(const std::string& name, int gid, int id, double* value) {
+    find_report(name).vars.emplace_back(ReportColumn{gid, id}, value);
+}
+
+void builtin_report_set_buffer_size_hint(int buffer_size) {
+    buffer_size_hint = buffer_size;
+}
+
+void builtin_report_setup(int min_steps_to_record) {
+    for (auto& report: builtin_reports) {
+        // columns of this rank sorted by gid, the elements of a gid in the order they were added
+        std::stable_sort(report.vars.begin(), report.vars.end(), [](const auto& a, const auto& b) {
+            return a.first.gid < b.first.gid;
+        });
+        std::vector<ReportColumn> columns;
+        for (const auto& var: report.vars) {
+            auto& range = report.gid_columns[var.first.gid];
+            if (range.first == range.second) {
+                range.first = columns.size();
+            }
+            columns.push_back(var.first);
+            range.second = columns.size();
+            report.values.push_back(var.second);
+        }
+        report.vars.clear();
+
+        long ncol = columns.size();
+        long total_ncol = ncol;
+        long max_ncol = ncol;
+#if NRNMPI
+        report.parallel = corenrn_param.mpi_enable && nrnmpi_initialized();
+        if (report.parallel) {
+            nrnmpi_long_allreduce_vec(&ncol, &total_ncol, 1, 1);
+            nrnmpi_long_allreduce_vec(&ncol, &max_ncol, 1, 2);
+        }
+#endif
+        std::uint64_t nrow = 0;
+        if (report.tstop > report.tstart) {
+            nrow = std::ceil((report.tstop - report.tstart) / report.report_dt - 1e-6);
+        }
+        // the chunks must hold the rows of a min delay interval, and those
+        // few steps before or after it recorded by the same flush
+        int buffer_size = buffer_size_hint >= 0 ? buffer_size_hint : report.buffer_size;
+        std::uint64_t chunk_rows = static_cast<std::uint64_t>(buffer_size) * 1024 * 1024 /
+                                   (sizeof(float) * std::max(max_ncol, 1L));
+        chunk_rows = std::max(chunk_rows, static_cast<std::uint64_t>(min_steps_to_record + 2));
+        chunk_rows = std::min(chunk_rows, std::max(nrow, std::uint64_t{1}));
+        report.header = make_report_file_header(
+            nrow, total_ncol, chunk_rows, nrnmpi_numprocs, report.tstart, report.report_dt);
+        report.nchunk = report_nchunk(report.header);
+        report.start_step = std::lround(report.tstart / report.dt);
+        report.steps_per_row = std::max(std::lround(report.report_dt / report.dt), 1L);
+
+        // rank 0 writes the file header before its column block
+        std::size_t header_size = nrnmpi_myid == 0 ? sizeof(ReportFileHeader) : 0;
+        report.layout.resize(header_size + report_column_block_bytes(ncol));
+        std::memcpy(report.layout.data(), &report.header, header_size);
+        pack_report_column_block(report.layout.data() + header_size, columns.data(), ncol);
+
+        std::string fname = report.name + ".rpt";
+#if NRNMPI
+        if (report.parallel) {
+            if (nrnmpi_myid == 0) {
+                remove(fname.c_str());
+            }
+            nrnmpi_barrier();
+            report.mpi_stream = nrnmpi_file_stream_open(fname);
+        } else
+#endif
+        {
+            report.file = fopen(fname.c_str(), "wb");
+            if (!report.file) {
+                std::cerr << "[ERROR] could not open report file " << fname << std::endl;
+                nrn_abort(1);
+            }
+        }
+        write_bytes(report, 0, report.layout.data(), report.layout.size());
+    }
+}
+
+void builtin_report_record(double step, int ngid, const int* gids, const std::string& name) {
+    BuiltinReport& report = find_report(name);
+    long s = std::lround(step) - report.start_step;
+    if (s < 0 || s % report.steps_per_row) {
+        return;
+    }
+    std::uint64_t row = s / report.steps_per_row;
+    if (row >= report.header.nrow) {
+        return;
+    }
+    std::uint64_t c = row / report.header.chunk_rows;
+    nrn_assert(c >= report.next_chunk);
+    ReportChunk& chunk = get_chunk(report, c);
+    std::size_t ncol = report.values.size();
+    float* out = chunk.values.data() + (row - c * report.header.chunk_rows) * ncol;
+    for (int i = 0; i < ngid; ++i) {
+        auto it = report.gid_columns.find(gids[i]);
+        if (it == report.gid_columns.end()) {
+            continue;
+        }
+        for (std::size_t k = it->second.first; k < it->second.second; ++k) {
+            out[k] = static_cast<float>(*report.values[k]);
+        }
+    }
+}
+
+void builtin_report_end_iteration(double t) {
+    for (auto& report: builtin_reports) {
+        // same decision on all the ranks, the chunk writes are collective
+        while (report.next_chunk < report.nchunk) {
+            std::uint64_t last_row = std::min((report.next_chunk + 1) * report.header.chunk_rows,
+                                              report.header.nrow) -
+                                     1;
+            if (report.tstart + last_row * report.report_dt >= t - 0.25 * report.dt) {
+                break;
+            }
+            write_next_chunk(report);
+        }
+    }
+}
+
+void builtin_report_flush(double /* t */) {
+    for (auto& report: builtin_reports) {
+        // rows never recorded (simulation stopped early) are left as zeros
+        while (report.next_chunk < report.nchunk) {
+            write_next_chunk(report);
+        }
+#if NRNMPI
+        if (report.parallel) {
+            nrnmpi_file_stream_close(report.mpi_stream);
+        } else
+#endif
+        {
+            fclose(report.file);
+        }
+    }
+    builtin_reports.clear();
+}
+
+}  // namespace coreneuron
@@ -0,0 +1,64 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+/**
+ * \file
+ * \brief Built-in report writer, used by the "Builtin" report format
+ *
+ * A small replacement of the reportinglib and libsonata writers that needs
+ * no external library. The calls mirror those of reportinglib: a report is
+ * created, its variables are added, the files are laid out collectively and
+ * the values are then recorded step by step and written chunk by chunk during
+ * the simulation. The file format is described in report_file.hpp.
+ *
+ * None of these functions is thread safe, they are called from the single
+ * threaded parts of the simulation (see ReportEvent::write_staged).
+ */
+
+#include <string>
+
+namespace coreneuron {
+
+/**
+ * Create a report, called on all the ranks and in the same order
+ *
+ * @param name Report name, the file is written to name.rpt
+ * @param dt Simulation time step
+ * @param tstart Time of the first recorded row
+ * @param tstop End of the report
+ * @param report_dt Time between two rows
+ * @param buffer_size Size in MB of each of the two buffers of the report
+ */
+void builtin_report_create(const std::string& name,
+                           double dt,
+                           double tstart,
+                           double tstop,
+                           double report_dt,
+                           int buffer_size);
+
+/// Add the element id of gid to a report, value is read by builtin_report_record
+void builtin_report_add_var(const std::string& name, int gid, int id, double* value);
+
+/// Size in MB of the buffers of all the reports, overrides the one of builtin_report_create
+void builtin_report_set_buffer_size_hint(int buffer_size);
+
+/// Write the headers once all the variables are added, a collective over all ranks
+void builtin_report_setup(int min_steps_to_record);
+
+/// Copy the values of the given gids for the simulation step
+void builtin_report_record(double step, int ngid, const int* gids, const std::string& name);
+
+/// Write the chunks whose rows are all recorded at time t
+void builtin_report_end_iteration(double t);
+
+/// Write all the remaining chunks and close the files
+void builtin_report_flush(double t);
+
+}  // namespace coreneuron
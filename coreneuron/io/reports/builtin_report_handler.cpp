@@ -0,0 +1,49 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include "builtin_report_handler.hpp"
+#include "builtin_report.hpp"
+
+namespace coreneuron {
+
+void BuiltinReportHandler::create_report(double dt, double tstop, double delay) {
+    // all the ranks create the file, even those without anything to report
+    builtin_report_create(m_report_config.output_path,
+                          dt,
+                          std::max(m_report_config.start, t),
+                          std::min(m_report_config.stop, tstop),
+                          m_report_config.report_dt,
+                          m_report_config.buffer_size);
+    ReportHandler::create_report(dt, tstop, delay);
+}
+
+void BuiltinReportHandler::register_section_report(const NrnThread& nt,
+                                                   ReportConfiguration& config,
+                                                   const VarsToReport& vars_to_report,
+                                                   bool is_soma_target) {
+    register_report(nt, config, vars_to_report);
+}
+
+void BuiltinReportHandler::register_custom_report(const NrnThread& nt,
+                                                  ReportConfiguration& config,
+                                                  const VarsToReport& vars_to_report) {
+    register_report(nt, config, vars_to_report);
+}
+
+void BuiltinReportHandler::register_report(const NrnThread& nt,
+                                           ReportConfiguration& config,
+                                           const VarsToReport& vars_to_report) {
+    for (const auto& kv: vars_to_report) {
+        int gid = kv.first;
+        for (const auto& var: kv.second) {
+            builtin_report_add_var(config.output_path, gid, var.id, var.var_value);
+        }
+    }
+}
+
+}  // Namespace coreneuron
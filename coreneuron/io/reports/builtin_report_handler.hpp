@@ -0,0 +1,39 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "report_handler.hpp"
+
+namespace coreneuron {
+
+/// Reports of format "Builtin", written without any external reporting library
+class BuiltinReportHandler: public ReportHandler {
+  public:
+    BuiltinReportHandler(ReportConfiguration& config)
+        : ReportHandler(config) {}
+
+    void create_report(double dt, double tstop, double delay) override;
+    void register_section_report(const NrnThread& nt,
+                                 ReportConfiguration& config,
+                                 const VarsToReport& vars_to_report,
+                                 bool is_soma_target) override;
+    void register_custom_report(const NrnThread& nt,
+                                ReportConfiguration& config,
+                                const VarsToReport& vars_to_report) override;
+
+  private:
+    void register_report(const NrnThread& nt,
+                         ReportConfiguration& config,
+                         const VarsToReport& vars_to_report);
+};
+
+}  // Namespace coreneuron
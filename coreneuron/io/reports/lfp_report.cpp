@@ -0,0 +1,238 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#include "coreneuron/io/reports/lfp_report.hpp"
+#include "coreneuron/io/reports/builtin_report.hpp"
+#include "coreneuron/io/nrnsection_mapping.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/mpi/core/nrnmpi.hpp"
+#include "coreneuron/mpi/nrnmpidec.h"
+#include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/utils/nrn_assert.h"
+#include "coreneuron/utils/utils.hpp"
+
+namespace coreneuron {
+
+LFPGeometry read_lfp_geometry(const std::string& filename) {
+    LFPGeometry geometry;
+    std::ifstream file(filename);
+    auto fail = [&filename]() {
+        std::cerr << "[ERROR] LFP geometry file " << filename << " is missing or invalid\n";
+        nrn_abort(1);
+    };
+    int nelectrode = 0;
+    if (!(file >> nelectrode >> geometry.conductivity) || nelectrode <= 0) {
+        fail();
+    }
+    geometry.electrodes.resize(nelectrode);
+    for (auto& e: geometry.electrodes) {
+        file >> e[0] >> e[1] >> e[2];
+    }
+    int ncell = 0;
+    file >> ncell;
+    for (int i = 0; i < ncell && file; ++i) {
+        int gid, nsection;
+        file >> gid >> nsection;
+        auto& sections = geometry.cells[gid];
+        for (int j = 0; j < nsection && file; ++j) {
+            int section, nseg;
+            file >> section >> nseg;
+            auto& segments = sections[section];
+            segments.resize(nseg);
+            for (auto& s: segments) {
+                file >> s.start[0] >> s.start[1] >> s.start[2] >> s.end[0] >> s.end[1] >>
+                    s.end[2] >> s.radius;
+            }
+        }
+    }
+    if (!file) {
+        fail();
+    }
+    return geometry;
+}
+
+std::unique_ptr<LFPCalculator<LineSource>> create_lfp_calculator(const NrnThread& nt,
+                                                                 const std::set<int>& target,
+                                                                 const LFPGeometry& geometry,
+                                                                 double cutoff) {
+    const auto* mapinfo = static_cast<NrnThreadMappingInfo*>(nt.mapping);
+    if (!mapinfo) {
+        std::cerr << "[LFP] Error : mapping information is missing for a Cell group " << nt.ncell
+                  << '\n';
+        nrn_abort(1);
+    }
+    lfputils::Point3Ds seg_start, seg_end;
+    std::vector<double> radius;
+    std::vector<int> segment_ids;
+    for (int i = 0; i < nt.ncell; i++) {
+        int gid = nt.presyns[i].gid_;
+        auto cell = geometry.cells.find(gid);
+        if (target.find(gid) == target.end() || cell == geometry.cells.end()) {
+            continue;
+        }
+        const auto* cell_mapping = mapinfo->get_cell_mapping(gid);
+        if (cell_mapping == nullptr) {
+            std::cerr << "[LFP] Error : Compartment mapping information is missing for gid " << gid
+                      << '\n';
+            nrn_abort(1);
+        }
+        for (const auto& section: cell->second) {
+            // the section lists of a cell do not share sections
+            const segvec_type* segments = nullptr;
+            for (const auto* sections: cell_mapping->secmapvec) {
+                auto it = sections->secmap.find(section.first);
+                if (it != sections->secmap.end()) {
+                    segments = &it->second;
+                    break;
+                }
+            }
+            if (!segments || segments->size() != section.second.size()) {
+                std::cerr << "[LFP] Error : geometry of section " << section.first << " of gid "
+                          << gid << " does not match its mapping\n";
+                nrn_abort(1);
+            }
+            for (size_t k = 0; k < segments->size(); ++k) {
+                const auto& s = section.second[k];
+                seg_start.push_back(s.start);
+                seg_end.push_back(s.end);
+                radius.push_back(s.radius);
+                segment_ids.push_back((*segments)[k]);
+            }
+        }
+    }
+    if (segment_ids.empty()) {
+        return nullptr;
+    }
+    return std::make_unique<LFPCalculator<LineSource>>(
+        seg_start, seg_end, radius, segment_ids, geometry.electrodes, geometry.conductivity, cutoff);
+}
+
+namespace {
+/// Sum over threads and ranks of the LFP of a report
+struct LFPReduction {
+    std::string name;
+    double dt;
+    double tstart;
+    double report_dt;
+    long start_step;
+    long steps_per_row;
+    std::size_t nrow;
+    std::size_t nelectrode;
+    std::size_t next_row = 0;     /// first row not reduced yet
+    std::vector<double> pending;  /// thread sums of the rows from next_row
+    std::vector<double> reduced;
+    std::vector<double> values;   /// row handed to the report writer
+};
+}  // namespace
+
+static std::vector<LFPReduction> lfp_reductions;
+/// column gid of the electrodes in the report files
+static int lfp_gid = 0;
+
+void lfp_report_create(const std::string& name,
+                       double dt,
+                       double tstart,
+                       double tstop,
+                       double report_dt,
+                       int nelectrode) {
+    LFPReduction r;
+    r.name = name;
+    r.dt = dt;
+    r.tstart = tstart;
+    r.report_dt = report_dt;
+    r.start_step = std::lround(tstart / dt);
+    r.steps_per_row = std::max(std::lround(report_dt / dt), 1L);
+    r.nrow = tstop > tstart ? std::ceil((tstop - tstart) / report_dt - 1e-6) : 0;
+    r.nelectrode = nelectrode;
+    r.values.resize(nelectrode);
+    lfp_reductions.push_back(std::move(r));
+    // the values never move: the vector is not resized anymore
+    if (nrnmpi_myid == 0) {
+        LFPReduction& added = lfp_reductions.back();
+        for (int k = 0; k < nelectrode; ++k) {
+            builtin_report_add_var(name, lfp_gid, k, &added.values[k]);
+        }
+    }
+}
+
+void lfp_report_add(const std::string& name, double step, const double* values) {
+    auto r = std::find_if(lfp_reductions.begin(),
+                          lfp_reductions.end(),
+                          [&name](const LFPReduction& r) { return r.name == name; });
+    nrn_assert(r != lfp_reductions.end());
+    long s = std::lround(step) - r->start_step;
+    if (s < 0 || s % r->steps_per_row) {
+        return;
+    }
+    std::size_t row = s / r->steps_per_row;
+    if (row >= r->nrow) {
+        return;
+    }
+    nrn_assert(row >= r->next_row);
+    std::size_t first = (row - r->next_row) * r->nelectrode;
+    if (r->pending.size() < first + r->nelectrode) {
+        r->pending.resize(first + r->nelectrode, 0.0);
+    }
+    for (std::size_t k = 0; k < r->nelectrode; ++k) {
+        r->pending[first + k] += values[k];
+    }
+}
+
+/// Reduce and write the rows before end_row
+static void reduce_rows(LFPReduction& r, std::size_t end_row) {
+    if (end_row <= r.next_row) {
+        return;
+    }
+    std::size_t n = (end_row - r.next_row) * r.nelectrode;
+    if (r.pending.size() < n) {
+        r.pending.resize(n, 0.0);
+    }
+    double* sum = r.pending.data();
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        // all the rows of the interval in one collective
+        r.reduced.resize(n);
+        nrnmpi_dbl_allreduce_vec(r.pending.data(), r.reduced.data(), n, 1);
+        sum = r.reduced.data();
+    }
+#endif
+    for (std::size_t row = r.next_row; row < end_row; ++row) {
+        std::copy(sum, sum + r.nelectrode, r.values.begin());
+        sum += r.nelectrode;
+        double step = r.start_step + static_cast<long>(row) * r.steps_per_row;
+        builtin_report_record(step, 1, &lfp_gid, r.name);
+    }
+    r.pending.erase(r.pending.begin(), r.pending.begin() + n);
+    r.next_row = end_row;
+}
+
+void lfp_reports_reduce(double t) {
+    for (auto& r: lfp_reductions) {
+        // same rows on all the ranks: the rows staged by the end of the interval
+        std::size_t end_row = r.next_row;
+        while (end_row < r.nrow && r.tstart + end_row * r.report_dt < t - 0.25 * r.dt) {
+            ++end_row;
+        }
+        reduce_rows(r, end_row);
+    }
+}
+
+void lfp_reports_finalize() {
+    for (auto& r: lfp_reductions) {
+        reduce_rows(r, r.nrow);
+    }
+    lfp_reductions.clear();
+}
+
+}  // namespace coreneuron
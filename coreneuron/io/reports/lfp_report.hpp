@@ -0,0 +1,91 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+/**
+ * \file
+ * \brief LFP reports, computed during the simulation from the membrane currents
+ *
+ * The electrodes and the geometry of the segments come from a text file,
+ * given as the report variable of the report configuration:
+ *
+ *     nelectrode conductivity
+ *     x y z                              (one line per electrode)
+ *     ncell
+ *     gid nsection                       (for each cell)
+ *     section nseg                       (for each section of the cell)
+ *     x0 y0 z0 x1 y1 z1 radius           (one line per segment of the section)
+ *
+ * Sections are numbered as in the section mapping, which gives the segments
+ * of every section of the cells of a thread.
+ *
+ * Every thread computes the LFP of its own segments from nrn_fast_imem at
+ * report_dt. The values staged by the threads are summed per report step and
+ * the steps of a flush interval are summed across ranks with a single
+ * allreduce. Rank 0 writes the result, one column per electrode, with the
+ * built-in report writer.
+ */
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "coreneuron/io/lfp.hpp"
+
+namespace coreneuron {
+
+struct NrnThread;
+
+/// Electrodes and segment geometry of an LFP report
+struct LFPGeometry {
+    struct Segment {
+        lfputils::Point3D start;
+        lfputils::Point3D end;
+        double radius;
+    };
+    double conductivity = 1.0;
+    lfputils::Point3Ds electrodes;
+    /// for each gid, the segments of each of its sections
+    std::unordered_map<int, std::map<int, std::vector<Segment>>> cells;
+};
+
+/// Read the geometry file of an LFP report, aborts if the file is invalid
+LFPGeometry read_lfp_geometry(const std::string& filename);
+
+/**
+ * Calculator for the segments of the target gids of a thread
+ *
+ * @return nullptr if the thread has no segment in the geometry
+ */
+std::unique_ptr<LFPCalculator<LineSource>> create_lfp_calculator(const NrnThread& nt,
+                                                                 const std::set<int>& target,
+                                                                 const LFPGeometry& geometry,
+                                                                 double cutoff);
+
+/// Create the reduction of an LFP report, called on all the ranks and in the same order
+void lfp_report_create(const std::string& name,
+                       double dt,
+                       double tstart,
+                       double tstop,
+                       double report_dt,
+                       int nelectrode);
+
+/// Add the LFP of a thread for the simulation step
+void lfp_report_add(const std::string& name, double step, const double* values);
+
+/// Sum the steps recorded before time t across ranks and hand them to the report writer
+void lfp_reports_reduce(double t);
+
+/// Sum and hand all the remaining steps, at the end of the simulation
+void lfp_reports_finalize();
+
+}  // namespace coreneuron
@@ -18,6 +18,9 @@
 #include "coreneuron/network/netcvode.hpp"
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/io/reports/nrnreport.hpp"
+#include "coreneuron/io/reports/report_event.hpp"
+#include "coreneuron/io/reports/builtin_report.hpp"
+#include "coreneuron/io/reports/lfp_report.hpp"
 #include "coreneuron/io/nrnsection_mapping.hpp"
 #include "coreneuron/mechanism/mech_mapping.hpp"
 #include "coreneuron/mechanism/membfunc.hpp"
@@ -34,7 +37,11 @@ namespace coreneuron {
 static int size_report_buffer = 4;
 
 void nrn_flush_reports(double t) {
+    nrn_write_staged_reports();
+    // the LFP of all the ranks is recorded before the chunks are written
+    lfp_reports_reduce(t);
     // flush before buffer is full
+    builtin_report_end_iteration(t);
 #ifdef ENABLE_BIN_REPORTS
     records_end_iteration(t);
 #endif
@@ -52,6 +59,7 @@ void nrn_flush_reports(double t) {
  */
 void setup_report_engine(double dt_report, double mindelay) {
     int min_steps_to_record = static_cast<int>(std::round(mindelay / dt_report));
+    builtin_report_setup(min_steps_to_record);
 #ifdef ENABLE_BIN_REPORTS
     records_set_min_steps_to_record(min_steps_to_record);
     records_setup_communicator();
@@ -67,6 +75,7 @@ void setup_report_engine(double dt_report, double mindelay) {
 // Size in MB of the report buffers
 void set_report_buffer_size(int n) {
     size_report_buffer = n;
+    builtin_report_set_buffer_size_hint(size_report_buffer);
 #ifdef ENABLE_BIN_REPORTS
     records_set_max_buffer_size_hint(size_report_buffer);
 #endif
@@ -76,6 +85,9 @@ void set_report_buffer_size(int n) {
 }
 
 void finalize_report() {
+    nrn_write_staged_reports();
+    lfp_reports_finalize();
+    builtin_report_flush(nrn_threads[0]._t);
 #ifdef ENABLE_BIN_REPORTS
     records_flush(nrn_threads[0]._t);
 #endif
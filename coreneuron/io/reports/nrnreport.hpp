@@ -28,10 +28,27 @@ namespace coreneuron {
 struct SummationReport {
     // Contains the values of the summation with index == segment_id
     std::vector<double> summation_ = {};
-    // Map containing the pointers of the currents and its scaling factor for every segment_id
+    // Map containing the pointers of the currents and its scaling factor for every segment_id,
+    // only used while registering the report
     std::unordered_map<size_t, std::vector<std::pair<double*, int>>> currents_;
-    // Map containing the list of segment_ids per gid
+    // Map containing the list of segment_ids per gid, only used while registering the report
     std::unordered_map<int, std::vector<size_t>> gid_segments_;
+    // Whether i_membrane is added to the currents of every segment
+    bool imembrane_ = false;
+
+    // The maps above flattened in CSR form once registered. The summation of
+    // segment_ids_[i] is the sum of _data[current_index_[k]] * current_scale_[k]
+    // for k in [current_offsets_[i], current_offsets_[i + 1]), plus the
+    // i_membrane of the segment.
+    std::vector<int> segment_ids_;
+    std::vector<int> current_offsets_;
+    std::vector<int> current_index_;
+    std::vector<double> current_scale_;
+    // Second pass for soma targets: summation_[soma_ids_[j]] becomes the sum of
+    // summation_[soma_segments_[k]] for k in [soma_offsets_[j], soma_offsets_[j + 1])
+    std::vector<int> soma_ids_;
+    std::vector<int> soma_offsets_;
+    std::vector<int> soma_segments_;
 };
 
 struct SummationReportMapping {
@@ -71,7 +88,8 @@ enum ReportType {
     SynapseReport,
     IMembraneReport,
     SectionReport,
-    SummationReport
+    SummationReport,
+    LFPReport
 };
 
 // enumerate that defines the section type for a Section report
@@ -99,6 +117,7 @@ struct ReportConfiguration {
     int buffer_size;                      // hint on buffer size used for this report
     uint64_t population_offset;           // offset of the node ids in the population
     std::set<int> target;                 // list of gids for this report
+    std::string lfp_geometry;             // electrodes and segments file of a LFP report
 };
 
 void setup_report_engine(double dt_report, double mindelay);
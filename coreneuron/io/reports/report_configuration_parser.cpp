@@ -140,6 +140,11 @@ std::vector<ReportConfiguration> create_report_configurations(
             report_type = SynapseReport;
         } else if (report.type_str == "summation") {
             report_type = SummationReport;
+        } else if (report.type_str == "lfp") {
+            // the report variable is the geometry file, the LFP needs the membrane currents
+            report_type = LFPReport;
+            report.lfp_geometry = report_on;
+            nrn_use_fast_imem = true;
         } else {
             std::cerr << "Report error: unsupported type " << report.type_str << std::endl;
             nrn_abort(1);
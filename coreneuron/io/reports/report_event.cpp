@@ -9,6 +9,8 @@
 #include "report_event.hpp"
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/io/reports/nrnreport.hpp"
+#include "coreneuron/io/reports/builtin_report.hpp"
+#include "coreneuron/io/reports/lfp_report.hpp"
 #include "coreneuron/utils/nrn_assert.h"
 #ifdef ENABLE_BIN_REPORTS
 #include "reportinglib/Records.h"
@@ -19,17 +21,21 @@
 
 namespace coreneuron {
 
-#if defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
+/// all the ReportEvent-s, whose staged steps are written by nrn_write_staged_reports
+static std::vector<ReportEvent*> report_events;
+
 ReportEvent::ReportEvent(double dt,
                          double tstart,
                          const VarsToReport& filtered_gids,
                          const char* name,
-                         double report_dt)
+                         double report_dt,
+                         bool builtin)
     : dt(dt)
     , tstart(tstart)
     , report_path(name)
     , report_dt(report_dt)
-    , vars_to_report(filtered_gids) {
+    , vars_to_report(filtered_gids)
+    , builtin(builtin) {
     nrn_assert(filtered_gids.size());
     step = tstart / dt;
     reporting_period = static_cast<int>(report_dt / dt);
@@ -38,64 +44,125 @@ ReportEvent::ReportEvent(double dt,
         gids_to_report.push_back(gid.first);
     }
     std::sort(gids_to_report.begin(), gids_to_report.end());
+
+    // staging layout: the variables of each gid, gids in increasing order
+    std::vector<double*> src;
+    for (int gid: gids_to_report) {
+        for (const auto& var: vars_to_report[gid]) {
+            src.push_back(var.var_value);
+        }
+    }
+    staging = ReportStaging(std::move(src));
+    std::size_t i = 0;
+    for (int gid: gids_to_report) {
+        auto& staged_vars = staged_vars_to_report[gid];
+        for (const auto& var: vars_to_report[gid]) {
+            staged_vars.emplace_back(var.id, staging.value(i++));
+        }
+    }
+    report_events.push_back(this);
+}
+
+ReportEvent::~ReportEvent() {
+    report_events.erase(std::find(report_events.begin(), report_events.end(), this));
 }
 
 void ReportEvent::summation_alu(NrnThread* nt) {
     // Sum currents only on reporting steps
     if (step > 0 && (static_cast<int>(step) % reporting_period) == 0) {
         auto& summation_report = nt->summation_report_handler_->summation_reports_[report_path];
+        double* summation = summation_report.summation_.data();
+        const double* data = nt->_data;
+        const int* offsets = summation_report.current_offsets_.data();
+        const int* index = summation_report.current_index_.data();
+        const double* scale = summation_report.current_scale_.data();
+        const int* segment_ids = summation_report.segment_ids_.data();
+        const double* imembrane = summation_report.imembrane_ ? nt->nrn_fast_imem->nrn_sav_rhs
+                                                              : nullptr;
         // Add currents of all variables in each segment
-        double sum = 0.0;
-        for (const auto& kv: summation_report.currents_) {
-            int segment_id = kv.first;
-            for (const auto& value: kv.second) {
-                double current_value = *value.first;
-                int scale = value.second;
-                sum += current_value * scale;
+        int nsegment = summation_report.segment_ids_.size();
+        for (int i = 0; i < nsegment; ++i) {
+            double sum = 0.0;
+            #pragma omp simd reduction(+ : sum)
+            for (int k = offsets[i]; k < offsets[i + 1]; ++k) {
+                sum += data[index[k]] * scale[k];
             }
-            summation_report.summation_[segment_id] = sum;
-            sum = 0.0;
+            if (imembrane) {
+                sum += imembrane[segment_ids[i]];
+            }
+            summation[segment_ids[i]] = sum;
         }
         // Add all currents in the soma
         // Only when type summation and soma target
-        if (!summation_report.gid_segments_.empty()) {
+        const int* soma_offsets = summation_report.soma_offsets_.data();
+        const int* soma_segments = summation_report.soma_segments_.data();
+        int nsoma = summation_report.soma_ids_.size();
+        for (int j = 0; j < nsoma; ++j) {
             double sum_soma = 0.0;
-            for (const auto& kv: summation_report.gid_segments_) {
-                int gid = kv.first;
-                for (const auto& segment_id: kv.second) {
-                    sum_soma += summation_report.summation_[segment_id];
-                }
-                *(vars_to_report[gid].front().var_value) = sum_soma;
-                sum_soma = 0.0;
+            #pragma omp simd reduction(+ : sum_soma)
+            for (int k = soma_offsets[j]; k < soma_offsets[j + 1]; ++k) {
+                sum_soma += summation[soma_segments[k]];
             }
+            summation[summation_report.soma_ids_[j]] = sum_soma;
         }
     }
 }
 
-/** on deliver, call ReportingLib and setup next event */
+void ReportEvent::lfp_alu(NrnThread* nt) {
+    // Compute the LFP only on the steps written by lfp_report_add, counted from the report start
+    long s = std::lround(step) - lfp_start_step;
+    if (s >= 0 && s % lfp_steps_per_row == 0) {
+        lfp_calculator->local_lfp(nt->nrn_fast_imem->nrn_sav_rhs);
+    }
+}
+
+/** on deliver, stage the values and setup next event */
 void ReportEvent::deliver(double t, NetCvode* nc, NrnThread* nt) {
-/* reportinglib is not thread safe */
-#pragma omp critical
-    {
+    if (lfp_calculator) {
+        lfp_alu(nt);
+    } else {
         summation_alu(nt);
+    }
+    // reportinglib is not thread safe, the values wait in the thread private
+    // staging area until nrn_write_staged_reports
+    staging.stage(step);
+    send(t + dt, nc, nt);
+    step++;
+}
+
+void ReportEvent::write_staged() {
+    staging.flush([this](double staged_step) {
         // each thread needs to know its own step
+        if (lfp_calculator) {
+            lfp_report_add(report_path, staged_step, staging.value(0));
+            return;
+        }
+        if (builtin) {
+            builtin_report_record(
+                staged_step, gids_to_report.size(), gids_to_report.data(), report_path);
+            return;
+        }
 #ifdef ENABLE_BIN_REPORTS
-        records_nrec(step, gids_to_report.size(), gids_to_report.data(), report_path.data());
+        records_nrec(
+            staged_step, gids_to_report.size(), gids_to_report.data(), report_path.data());
 #endif
 #ifdef ENABLE_SONATA_REPORTS
-        sonata_record_node_data(step,
+        sonata_record_node_data(staged_step,
                                 gids_to_report.size(),
                                 gids_to_report.data(),
                                 report_path.data());
 #endif
-        send(t + dt, nc, nt);
-        step++;
+    });
+}
+
+void nrn_write_staged_reports() {
+    for (ReportEvent* event: report_events) {
+        event->write_staged();
     }
 }
 
 bool ReportEvent::require_checkpoint() {
     return false;
 }
-#endif  // defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
 
 }  // Namespace coreneuron
@@ -9,16 +9,19 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 #include <string>
 
 #include "coreneuron/network/netcon.hpp"
 #include "coreneuron/network/netcvode.hpp"
+#include "coreneuron/io/reports/report_staging.hpp"
+#include "coreneuron/io/lfp.hpp"
 
 namespace coreneuron {
 
-#if defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
 struct VarWithMapping {
     int id;
     double* var_value;
@@ -36,12 +39,32 @@ class ReportEvent: public DiscreteEvent {
                 double tstart,
                 const VarsToReport& filtered_gids,
                 const char* name,
-                double report_dt);
+                double report_dt,
+                bool builtin = false);
+    ReportEvent(const ReportEvent&) = delete;
+    ReportEvent& operator=(const ReportEvent&) = delete;
+    ~ReportEvent() override;
 
-    /** on deliver, call ReportingLib and setup next event */
+    /** on deliver, stage the values and setup next event */
     void deliver(double t, NetCvode* nc, NrnThread* nt) override;
     bool require_checkpoint() override;
     void summation_alu(NrnThread* nt);
+    /// LFP reports: the staged values are the LFP of the thread, computed on the steps of
+    /// the report rows, report_dt apart from the report start
+    void set_lfp_calculator(std::unique_ptr<LFPCalculator<LineSource>> calculator,
+                            double report_start) {
+        lfp_calculator = std::move(calculator);
+        // the rows of lfp_report_add
+        lfp_start_step = std::lround(report_start / dt);
+        lfp_steps_per_row = std::max(std::lround(report_dt / dt), 1L);
+    }
+    void lfp_alu(NrnThread* nt);
+    /// Variables to register with the reporting library, pointing to the staged values
+    const VarsToReport& staged_vars() const {
+        return staged_vars_to_report;
+    }
+    /// Hand the staged steps to the reporting library, outside of parallel regions
+    void write_staged();
 
   private:
     double dt;
@@ -52,7 +75,16 @@ class ReportEvent: public DiscreteEvent {
     std::vector<int> gids_to_report;
     double tstart;
     VarsToReport vars_to_report;
+    ReportStaging staging;
+    VarsToReport staged_vars_to_report;
+    /// written by the built-in report writer instead of the reporting libraries
+    bool builtin;
+    std::unique_ptr<LFPCalculator<LineSource>> lfp_calculator;
+    long lfp_start_step = 0;
+    long lfp_steps_per_row = 1;
 };
-#endif  // defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
+
+/// Hand the steps staged by all the ReportEvent-s to the reporting library
+void nrn_write_staged_reports();
 
 }  // Namespace coreneuron
@@ -0,0 +1,172 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#pragma once
+
+/**
+ * \file
+ * \brief Binary format of the reports written by the built-in report writer
+ *
+ * A report is a matrix with one row per report time step and one column per
+ * reported variable. The file starts with a ReportFileHeader followed by one
+ * column block per rank, in rank order:
+ *
+ *     uint64_t ncol;                  // number of columns of the rank
+ *     ReportColumn columns[ncol];     // gid and element id of each column
+ *
+ * The rows are then stored in chunks of header.chunk_rows rows (the last
+ * chunk may be shorter). Within a chunk, the values of each rank are stored
+ * contiguously, row major, in the same rank order as the column blocks:
+ *
+ *     float values[nrow_chunk][ncol of rank 0];
+ *     float values[nrow_chunk][ncol of rank 1];
+ *     ...
+ *
+ * so that every rank writes a single contiguous range per chunk. The columns
+ * of a row are the concatenation of the column blocks. All values are in
+ * native byte order.
+ *
+ * This header is self-contained (no dependency on the coreneuron library)
+ * so that it can be used by standalone tools like reportdump.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace coreneuron {
+
+static constexpr char report_file_magic[8] = {'C', 'N', 'R', 'N', 'R', 'E', 'P', '\0'};
+static constexpr std::uint32_t report_file_version = 1;
+
+struct ReportFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t value_size;  // sizeof the values, always 4 for version 1
+    std::uint64_t nrow;        // number of report time steps
+    std::uint64_t ncol;        // number of columns over all the ranks
+    std::uint64_t chunk_rows;  // number of rows of every chunk but the last one
+    std::uint64_t nblock;      // number of column blocks (ranks)
+    double tstart;             // time of the first row
+    double dt;                 // time between two rows
+};
+static_assert(sizeof(ReportFileHeader) == 64, "ReportFileHeader must be 64 bytes");
+
+struct ReportColumn {
+    std::int32_t gid;
+    std::int32_t id;  // element id, as in the reportinglib and sonata mappings
+};
+static_assert(sizeof(ReportColumn) == 8, "ReportColumn must be 8 bytes");
+
+inline ReportFileHeader make_report_file_header(std::uint64_t nrow,
+                                                std::uint64_t ncol,
+                                                std::uint64_t chunk_rows,
+                                                std::uint64_t nblock,
+                                                double tstart,
+                                                double dt) {
+    ReportFileHeader h;
+    std::memcpy(h.magic, report_file_magic, sizeof(h.magic));
+    h.version = report_file_version;
+    h.value_size = sizeof(float);
+    h.nrow = nrow;
+    h.ncol = ncol;
+    h.chunk_rows = chunk_rows;
+    h.nblock = nblock;
+    h.tstart = tstart;
+    h.dt = dt;
+    return h;
+}
+
+/// Number of rows of the given chunk
+inline std::uint64_t report_chunk_rows(const ReportFileHeader& h, std::uint64_t chunk) {
+    std::uint64_t first = chunk * h.chunk_rows;
+    return first >= h.nrow ? 0 : (h.nrow - first < h.chunk_rows ? h.nrow - first : h.chunk_rows);
+}
+
+/// Number of chunks of the file
+inline std::uint64_t report_nchunk(const ReportFileHeader& h) {
+    return h.chunk_rows ? (h.nrow + h.chunk_rows - 1) / h.chunk_rows : 0;
+}
+
+/// Size in bytes of a column block of ncol columns, including its count
+inline std::uint64_t report_column_block_bytes(std::uint64_t ncol) {
+    return sizeof(std::uint64_t) + ncol * sizeof(ReportColumn);
+}
+
+/// Copy one column block into buf, which must hold report_column_block_bytes(n). Returns the end.
+inline char* pack_report_column_block(char* buf, const ReportColumn* columns, std::uint64_t n) {
+    std::memcpy(buf, &n, sizeof(n));
+    buf += sizeof(n);
+    std::memcpy(buf, columns, n * sizeof(ReportColumn));
+    return buf + n * sizeof(ReportColumn);
+}
+
+/// Everything before the first chunk
+struct ReportFileLayout {
+    ReportFileHeader header;
+    std::vector<std::uint64_t> block_ncol;  // number of columns of each block
+    std::vector<ReportColumn> columns;      // all the columns, in row order
+};
+
+/// Read the header and the column blocks of a file opened for binary reading
+inline bool read_report_file_layout(FILE* f, ReportFileLayout& layout) {
+    ReportFileHeader& h = layout.header;
+    if (fread(&h, sizeof(h), 1, f) != 1 ||
+        std::memcmp(h.magic, report_file_magic, sizeof(h.magic)) != 0 ||
+        h.version != report_file_version || h.value_size != sizeof(float)) {
+        return false;
+    }
+    layout.block_ncol.resize(h.nblock);
+    layout.columns.clear();
+    for (std::uint64_t b = 0; b < h.nblock; ++b) {
+        std::uint64_t n;
+        if (fread(&n, sizeof(n), 1, f) != 1) {
+            return false;
+        }
+        layout.block_ncol[b] = n;
+        std::size_t first = layout.columns.size();
+        layout.columns.resize(first + n);
+        if (fread(layout.columns.data() + first, sizeof(ReportColumn), n, f) != n) {
+            return false;
+        }
+    }
+    return layout.columns.size() == h.ncol;
+}
+
+/**
+ * Read the next chunk into values, as nrow_chunk full rows of header.ncol values.
+ * Returns the number of rows read, 0 at the end of the file and -1 if the
+ * chunk is truncated.
+ */
+inline long read_report_chunk(FILE* f,
+                              const ReportFileLayout& layout,
+                              std::uint64_t chunk,
+                              std::vector<float>& values) {
+    const ReportFileHeader& h = layout.header;
+    std::uint64_t nrow = report_chunk_rows(h, chunk);
+    if (nrow == 0) {
+        return 0;
+    }
+    values.resize(nrow * h.ncol);
+    std::vector<float> block;
+    std::uint64_t col = 0;
+    for (std::uint64_t n: layout.block_ncol) {
+        block.resize(nrow * n);
+        if (fread(block.data(), sizeof(float), block.size(), f) != block.size()) {
+            return -1;
+        }
+        for (std::uint64_t r = 0; r < nrow; ++r) {
+            std::memcpy(&values[r * h.ncol + col], &block[r * n], n * sizeof(float));
+        }
+        col += n;
+    }
+    return static_cast<long>(nrow);
+}
+
+}  // namespace coreneuron
@@ -8,13 +8,24 @@
 
 #include "report_handler.hpp"
 #include "coreneuron/io/nrnsection_mapping.hpp"
+#include "coreneuron/io/reports/lfp_report.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
 #include "coreneuron/mechanism/mech_mapping.hpp"
 #include "coreneuron/utils/utils.hpp"
 
 namespace coreneuron {
 
 void ReportHandler::create_report(double dt, double tstop, double delay) {
-#if defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
+#if !defined(ENABLE_BIN_REPORTS) && !defined(ENABLE_SONATA_REPORTS)
+    // only the built-in writer is available
+    if (m_report_config.format != "Builtin") {
+        if (nrnmpi_myid == 0) {
+            std::cerr << "[WARNING] : Reporting is disabled. Please recompile with either "
+                         "libsonata or reportinglib. \n";
+        }
+        return;
+    }
+#endif  // !defined(ENABLE_BIN_REPORTS) && !defined(ENABLE_SONATA_REPORTS)
     if (m_report_config.start < t) {
         m_report_config.start = t;
     }
@@ -28,6 +39,10 @@ void ReportHandler::create_report(double dt, double tstop, double delay) {
                   << " is not mapped in this simulation, cannot report on it \n";
         nrn_abort(1);
     }
+    if (m_report_config.type == LFPReport) {
+        create_lfp_report(dt);
+        return;
+    }
     for (int ith = 0; ith < nrn_nthread; ++ith) {
         NrnThread& nt = nrn_threads[ith];
         double* report_variable = nt._actual_v;
@@ -36,7 +51,8 @@ void ReportHandler::create_report(double dt, double tstop, double delay) {
         }
         const std::vector<int>& nodes_to_gid = map_gids(nt);
         VarsToReport vars_to_report;
-        bool is_soma_target;
+        bool is_section_report = false;
+        bool is_soma_target = false;
         switch (m_report_config.type) {
             case IMembraneReport:
                 report_variable = nt.nrn_fast_imem->nrn_sav_rhs;
@@ -47,40 +63,90 @@ void ReportHandler::create_report(double dt, double tstop, double delay) {
                                                report_variable,
                                                m_report_config.section_type,
                                                m_report_config.section_all_compartments);
+                is_section_report = true;
                 is_soma_target = m_report_config.section_type == SectionType::Soma ||
                                  m_report_config.section_type == SectionType::Cell;
-                register_section_report(nt, m_report_config, vars_to_report, is_soma_target);
                 break;
             case SummationReport:
                 vars_to_report = get_summation_vars_to_report(nt,
                                                               m_report_config.target,
                                                               m_report_config,
                                                               nodes_to_gid);
-                register_custom_report(nt, m_report_config, vars_to_report);
                 break;
             default:
                 vars_to_report = get_synapse_vars_to_report(nt, m_report_config, nodes_to_gid);
-                register_custom_report(nt, m_report_config, vars_to_report);
         }
+        // the reporting library reads the values staged by the event, not the live ones
+        std::unique_ptr<ReportEvent> report_event;
         if (!vars_to_report.empty()) {
-            auto report_event = std::make_unique<ReportEvent>(dt,
-                                                              t,
-                                                              vars_to_report,
-                                                              m_report_config.output_path.data(),
-                                                              m_report_config.report_dt);
+            report_event = std::make_unique<ReportEvent>(dt,
+                                                         t,
+                                                         vars_to_report,
+                                                         m_report_config.output_path.data(),
+                                                         m_report_config.report_dt,
+                                                         m_report_config.format == "Builtin");
+        }
+        const VarsToReport& registered_vars = report_event ? report_event->staged_vars()
+                                                           : vars_to_report;
+        if (is_section_report) {
+            register_section_report(nt, m_report_config, registered_vars, is_soma_target);
+        } else {
+            register_custom_report(nt, m_report_config, registered_vars);
+        }
+        if (report_event) {
             report_event->send(t, net_cvode_instance, &nt);
             m_report_events.push_back(std::move(report_event));
         }
     }
-#else
-    if (nrnmpi_myid == 0) {
-        std::cerr << "[WARNING] : Reporting is disabled. Please recompile with either libsonata or "
-                     "reportinglib. \n";
+}
+
+void ReportHandler::create_lfp_report(double dt) {
+    if (m_report_config.format != "Builtin") {
+        if (nrnmpi_myid == 0) {
+            std::cerr << "[WARNING] : LFP report '" << m_report_config.output_path
+                      << "' needs the 'Builtin' format, not '" << m_report_config.format << "'.\n";
+        }
+        return;
+    }
+    const LFPGeometry geometry = read_lfp_geometry(m_report_config.lfp_geometry);
+    lfp_report_create(m_report_config.output_path,
+                      dt,
+                      m_report_config.start,
+                      m_report_config.stop,
+                      m_report_config.report_dt,
+                      geometry.electrodes.size());
+    for (int ith = 0; ith < nrn_nthread; ++ith) {
+        NrnThread& nt = nrn_threads[ith];
+        if (!nt.ncell) {
+            continue;
+        }
+        auto calculator = create_lfp_calculator(nt,
+                                                m_report_config.target,
+                                                geometry,
+                                                corenrn_param.lfp_cutoff);
+        if (!calculator) {
+            continue;
+        }
+        // the event stages the LFP of the thread, summed by lfp_reports_reduce
+        std::vector<VarWithMapping> to_report;
+        const double* values = calculator->local_lfp_values().data();
+        for (std::size_t k = 0; k < geometry.electrodes.size(); ++k) {
+            to_report.emplace_back(k, const_cast<double*>(values + k));
+        }
+        VarsToReport vars_to_report;
+        vars_to_report[nt.presyns[0].gid_] = std::move(to_report);
+        auto report_event = std::make_unique<ReportEvent>(dt,
+                                                          t,
+                                                          vars_to_report,
+                                                          m_report_config.output_path.data(),
+                                                          m_report_config.report_dt,
+                                                          true);
+        report_event->set_lfp_calculator(std::move(calculator), m_report_config.start);
+        report_event->send(t, net_cvode_instance, &nt);
+        m_report_events.push_back(std::move(report_event));
     }
-#endif  // defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
 }
 
-#if defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
 void ReportHandler::register_section_report(const NrnThread& nt,
                                             ReportConfiguration& config,
                                             const VarsToReport& vars_to_report,
@@ -195,6 +261,54 @@ VarsToReport ReportHandler::get_section_vars_to_report(const NrnThread& nt,
     return vars_to_report;
 }
 
+/** Compile the maps of a summation report into its CSR arrays, in increasing
+ *  segment and gid order, and release the maps.
+ */
+static void flatten_summation_report(const NrnThread& nt,
+                                     struct SummationReport& report,
+                                     VarsToReport& vars_to_report) {
+    std::vector<size_t> segments;
+    segments.reserve(report.currents_.size());
+    for (const auto& kv: report.currents_) {
+        segments.push_back(kv.first);
+    }
+    std::sort(segments.begin(), segments.end());
+    report.current_offsets_.assign(1, 0);
+    for (size_t segment_id: segments) {
+        report.segment_ids_.push_back(segment_id);
+        for (const auto& current: report.currents_[segment_id]) {
+            std::ptrdiff_t index = current.first - nt._data;
+            nrn_assert(index >= 0 && static_cast<size_t>(index) < nt._ndata);
+            report.current_index_.push_back(index);
+            report.current_scale_.push_back(current.second);
+        }
+        report.current_offsets_.push_back(report.current_index_.size());
+    }
+
+    std::vector<int> gids;
+    gids.reserve(report.gid_segments_.size());
+    for (const auto& kv: report.gid_segments_) {
+        gids.push_back(kv.first);
+    }
+    std::sort(gids.begin(), gids.end());
+    report.soma_offsets_.assign(1, 0);
+    for (int gid: gids) {
+        const auto& vars = vars_to_report[gid];
+        if (vars.empty()) {
+            continue;
+        }
+        report.soma_ids_.push_back(vars.front().var_value - report.summation_.data());
+        const auto& gid_segments = report.gid_segments_[gid];
+        report.soma_segments_.insert(report.soma_segments_.end(),
+                                     gid_segments.begin(),
+                                     gid_segments.end());
+        report.soma_offsets_.push_back(report.soma_segments_.size());
+    }
+
+    report.currents_.clear();
+    report.gid_segments_.clear();
+}
+
 VarsToReport ReportHandler::get_summation_vars_to_report(
     const NrnThread& nt,
     const std::set<int>& target,
@@ -275,8 +389,9 @@ VarsToReport ReportHandler::get_summation_vars_to_report(
                     for (const auto& segment_id: segment_ids) {
                         // corresponding voltage in coreneuron voltage array
                         if (has_imembrane) {
-                            summation_report.currents_[segment_id].push_back(
-                                std::make_pair(nt.nrn_fast_imem->nrn_sav_rhs + segment_id, 1));
+                            // added by summation_alu, the segment only needs an entry
+                            summation_report.currents_[segment_id];
+                            summation_report.imembrane_ = true;
                         }
                         if (report.section_type == SectionType::All) {
                             double* variable = report_variable + segment_id;
@@ -290,6 +405,7 @@ VarsToReport ReportHandler::get_summation_vars_to_report(
             vars_to_report[gid] = to_report;
         }
     }
+    flatten_summation_report(nt, summation_report, vars_to_report);
     return vars_to_report;
 }
 
@@ -367,6 +483,5 @@ std::vector<int> ReportHandler::map_gids(const NrnThread& nt) const {
     }
     return nodes_gid;
 }
-#endif  // defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
 
 }  // Namespace coreneuron
@@ -24,7 +24,6 @@ class ReportHandler {
     virtual ~ReportHandler() = default;
 
     virtual void create_report(double dt, double tstop, double delay);
-#if defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
     virtual void register_section_report(const NrnThread& nt,
                                          ReportConfiguration& config,
                                          const VarsToReport& vars_to_report,
@@ -45,12 +44,12 @@ class ReportHandler {
                                             ReportConfiguration& report,
                                             const std::vector<int>& nodes_to_gids) const;
     std::vector<int> map_gids(const NrnThread& nt) const;
-#endif  // defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
   protected:
+    /// LFP reports are written by the built-in writer from the sum over threads and ranks
+    void create_lfp_report(double dt);
+
     ReportConfiguration m_report_config;
-#if defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
     std::vector<std::unique_ptr<ReportEvent>> m_report_events;
-#endif  // defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
 };
 
 }  // Namespace coreneuron
@@ -0,0 +1,81 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace coreneuron {
+
+/**
+ * \class ReportStaging
+ * \brief Thread private copies of the values reported by a ReportEvent
+ *
+ * The reporting libraries are not thread safe. Instead of calling them from
+ * every thread in a critical section, the thread owning the values copies them
+ * at each step into a row of its staging area, laid out once in registration
+ * order. At the end of the min delay interval a single thread hands the rows
+ * to the library one step at a time, through the values the library was
+ * registered with.
+ */
+class ReportStaging {
+  public:
+    ReportStaging() = default;
+    explicit ReportStaging(std::vector<double*> src)
+        : src_(std::move(src))
+        , values_(src_.size()) {}
+
+    std::size_t size() const {
+        return src_.size();
+    }
+
+    /// Address of the i-th value, to register with the reporting library
+    double* value(std::size_t i) {
+        return &values_[i];
+    }
+
+    /// Copy the current values as those of step, called by the owning thread
+    void stage(double step) {
+        std::size_t row = rows_.size();
+        rows_.resize(row + src_.size());
+        for (std::size_t i = 0; i < src_.size(); ++i) {
+            rows_[row + i] = *src_[i];
+        }
+        steps_.push_back(step);
+    }
+
+    /// Number of steps staged since the last flush
+    std::size_t nstaged() const {
+        return steps_.size();
+    }
+
+    /// For each staged step, oldest first, load its values into the registered
+    /// ones and call write(step). The capacity of the staging area is kept.
+    template <typename F>
+    void flush(F&& write) {
+        auto row = rows_.cbegin();
+        for (double step: steps_) {
+            std::copy(row, row + src_.size(), values_.begin());
+            row += src_.size();
+            write(step);
+        }
+        rows_.clear();
+        steps_.clear();
+    }
+
+  private:
+    std::vector<double*> src_;   ///< live values, in registration order
+    std::vector<double> values_;  ///< values read by the reporting library
+    std::vector<double> rows_;    ///< a row of staged values per step
+    std::vector<double> steps_;   ///< step of each row
+};
+
+}  // namespace coreneuron
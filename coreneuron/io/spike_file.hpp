@@ -0,0 +1,114 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#pragma once
+
+/**
+ * \file
+ * \brief Binary spike output format
+ *
+ * The file starts with a SpikeFileHeader followed by a sequence of blocks.
+ * Every block holds a contiguous, time sorted, range of spikes as two
+ * columns:
+ *
+ *     uint64_t n;        // number of spikes in the block
+ *     double time[n];    // spike times
+ *     int32_t gid[n];    // spike gids
+ *     int32_t pad;       // only if n is odd, keeps blocks 8 byte aligned
+ *
+ * Blocks are written in time order so that concatenating them gives the
+ * same sequence as the text out.dat. The end of the last block is the end
+ * of the file. All values are in native byte order.
+ *
+ * This header is self-contained (no dependency on the coreneuron library)
+ * so that it can be used by standalone tools like spikes2dat.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace coreneuron {
+
+static constexpr char spike_file_magic[8] = {'C', 'N', 'R', 'N', 'S', 'P', 'K', '\0'};
+static constexpr std::uint32_t spike_file_version = 1;
+
+struct SpikeFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t gid_size;  // sizeof the gid column entries, always 4 for version 1
+};
+static_assert(sizeof(SpikeFileHeader) == 16, "SpikeFileHeader must be 16 bytes");
+
+inline SpikeFileHeader make_spike_file_header() {
+    SpikeFileHeader h;
+    std::memcpy(h.magic, spike_file_magic, sizeof(h.magic));
+    h.version = spike_file_version;
+    h.gid_size = sizeof(std::int32_t);
+    return h;
+}
+
+/// Size in bytes of a block of n spikes, including its count and padding
+inline std::uint64_t spike_block_bytes(std::uint64_t n) {
+    return sizeof(std::uint64_t) + n * sizeof(double) + ((n + 1) / 2) * 2 * sizeof(std::int32_t);
+}
+
+/// Copy one block into buf, which must hold spike_block_bytes(n). Returns the end of the block.
+inline char* pack_spike_block(char* buf, const double* time, const int* gid, std::uint64_t n) {
+    static_assert(sizeof(int) == sizeof(std::int32_t), "gid column requires 32 bit int");
+    std::memcpy(buf, &n, sizeof(n));
+    buf += sizeof(n);
+    std::memcpy(buf, time, n * sizeof(double));
+    buf += n * sizeof(double);
+    std::memcpy(buf, gid, n * sizeof(std::int32_t));
+    buf += n * sizeof(std::int32_t);
+    if (n % 2) {
+        std::memset(buf, 0, sizeof(std::int32_t));
+        buf += sizeof(std::int32_t);
+    }
+    return buf;
+}
+
+/// Append one block to a file opened for binary writing. Returns false on i/o error.
+inline bool write_spike_block(FILE* f, const double* time, const int* gid, std::uint64_t n) {
+    static_assert(sizeof(int) == sizeof(std::int32_t), "gid column requires 32 bit int");
+    const std::int32_t pad = 0;
+    return fwrite(&n, sizeof(n), 1, f) == 1 && fwrite(time, sizeof(double), n, f) == n &&
+           fwrite(gid, sizeof(std::int32_t), n, f) == n &&
+           (n % 2 == 0 || fwrite(&pad, sizeof(pad), 1, f) == 1);
+}
+
+/// Check the header of a file opened for binary reading
+inline bool read_spike_file_header(FILE* f) {
+    SpikeFileHeader h;
+    return fread(&h, sizeof(h), 1, f) == 1 &&
+           std::memcmp(h.magic, spike_file_magic, sizeof(h.magic)) == 0 &&
+           h.version == spike_file_version && h.gid_size == sizeof(std::int32_t);
+}
+
+/**
+ * Read the next block into time and gid.
+ * Returns 1 if a block was read, 0 at the end of the file and -1 if the
+ * block is truncated.
+ */
+inline int read_spike_block(FILE* f, std::vector<double>& time, std::vector<std::int32_t>& gid) {
+    std::uint64_t n;
+    if (fread(&n, sizeof(n), 1, f) != 1) {
+        return 0;
+    }
+    time.resize(n);
+    gid.resize(n);
+    std::int32_t pad;
+    bool ok = fread(time.data(), sizeof(double), n, f) == n &&
+              fread(gid.data(), sizeof(std::int32_t), n, f) == n &&
+              (n % 2 == 0 || fread(&pad, sizeof(pad), 1, f) == 1);
+    return ok ? 1 : -1;
+}
+
+}  // namespace coreneuron
@@ -20,11 +20,13 @@ struct UserParams {
                int* gidgroups_,
                const char* path_,
                const char* restore_path_,
-               CheckPoints& checkPoints_)
+               CheckPoints& checkPoints_,
+               bool use_mmap_ = false)
         : ngroup(ngroup_)
         , gidgroups(gidgroups_)
         , path(path_)
         , restore_path(restore_path_)
+        , use_mmap(use_mmap_)
         , file_reader(ngroup_)
         , checkPoints(checkPoints_) {}
 
@@ -37,6 +39,10 @@ struct UserParams {
     const char* const path;
     /// Dataset path from where simulation is being restored
     const char* const restore_path;
+    /// Read the dataset files through a memory mapping
+    const bool use_mmap;
+    /// Threads available to set up the mechanisms of one cell group, see --setup-threads
+    int group_workers = 1;
     std::vector<FileHandler> file_reader;
     CheckPoints& checkPoints;
 };
@@ -16,6 +16,7 @@
 #include "coreneuron/mechanism/membfunc.hpp"
 #include "coreneuron/coreneuron.hpp"
 #include "coreneuron/utils/nrnoc_aux.hpp"
+#include "coreneuron/utils/profile/profiler_interface.h"
 
 namespace coreneuron {
 int secondorder = 0;
@@ -157,6 +158,7 @@ int register_mech(const char** m,
     memb_func[type].dparam_semantics = nullptr;
 #endif
     register_all_variables_offsets(type, &m[2]);
+    Instrumentor::mech_phase_names::register_mechanism(type, memb_func[type].sym);
     return type;
 }
 
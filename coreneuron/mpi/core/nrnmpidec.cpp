@@ -19,12 +19,32 @@ mpi_function<cnrn_make_integral_constant_t(nrnmpi_check_threading_support_impl)>
     nrnmpi_check_threading_support{"nrnmpi_check_threading_support_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_write_file_impl)> nrnmpi_write_file{
     "nrnmpi_write_file_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_file_stream_open_impl)>
+    nrnmpi_file_stream_open{"nrnmpi_file_stream_open_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_file_stream_write_impl)>
+    nrnmpi_file_stream_write{"nrnmpi_file_stream_write_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_file_stream_wait_impl)>
+    nrnmpi_file_stream_wait{"nrnmpi_file_stream_wait_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_file_stream_close_impl)>
+    nrnmpi_file_stream_close{"nrnmpi_file_stream_close_impl"};
 
 /* from mpispike.c */
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_impl)> nrnmpi_spike_exchange{
     "nrnmpi_spike_exchange_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_compressed_impl)>
     nrnmpi_spike_exchange_compressed{"nrnmpi_spike_exchange_compressed_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_post_impl)>
+    nrnmpi_spike_exchange_post{"nrnmpi_spike_exchange_post_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_test_impl)>
+    nrnmpi_spike_exchange_test{"nrnmpi_spike_exchange_test_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_wait_impl)>
+    nrnmpi_spike_exchange_wait{"nrnmpi_spike_exchange_wait_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_inline_impl)>
+    nrnmpi_spike_exchange_inline{"nrnmpi_spike_exchange_inline_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_sparse_exchange_setup_impl)>
+    nrnmpi_sparse_exchange_setup{"nrnmpi_sparse_exchange_setup_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_sparse_exchange_impl)> nrnmpi_sparse_exchange{
+    "nrnmpi_sparse_exchange_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_int_allmax_impl)> nrnmpi_int_allmax{
     "nrnmpi_int_allmax_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_int_allgather_impl)> nrnmpi_int_allgather{
@@ -35,6 +55,10 @@ mpi_function<cnrn_make_integral_constant_t(nrnmpi_int_alltoallv_impl)> nrnmpi_in
     "nrnmpi_int_alltoallv_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_alltoallv_impl)> nrnmpi_dbl_alltoallv{
     "nrnmpi_dbl_alltoallv_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_neighbor_exchange_post_impl)>
+    nrnmpi_dbl_neighbor_exchange_post{"nrnmpi_dbl_neighbor_exchange_post_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_neighbor_exchange_wait_impl)>
+    nrnmpi_dbl_neighbor_exchange_wait{"nrnmpi_dbl_neighbor_exchange_wait_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_allmin_impl)> nrnmpi_dbl_allmin{
     "nrnmpi_dbl_allmin_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_allmax_impl)> nrnmpi_dbl_allmax{
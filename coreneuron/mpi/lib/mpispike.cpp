@@ -18,6 +18,7 @@
 #include <mpi.h>
 
 #include <cstring>
+#include <vector>
 
 namespace coreneuron {
 extern MPI_Comm nrnmpi_comm;
@@ -25,7 +26,10 @@ extern MPI_Comm nrnmpi_comm;
 static int np;
 static int* displs{nullptr};
 static int* byteovfl; /* for the compressed transfer method */
+static int* ovflcnt;  /* for the run time sized inline buffer */
 static MPI_Datatype spike_type;
+static MPI_Comm overlap_comm{MPI_COMM_NULL}; /* overlapped exchange, see below */
+static MPI_Comm sparse_comm{MPI_COMM_NULL};  /* sparse exchange, see below */
 
 static void* emalloc(size_t size) {
     void* memptr = malloc(size);
@@ -50,6 +54,16 @@ void nrnmpi_spike_initialize() {
     MPI_Type_commit(&spike_type);
 }
 
+// Free the communicators of the overlapped and of the sparse exchange
+void nrnmpi_spike_finalize() {
+    if (overlap_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&overlap_comm);
+    }
+    if (sparse_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&sparse_comm);
+    }
+}
+
 #if nrn_spikebuf_size > 0
 
 static MPI_Datatype spikebuf_type;
@@ -156,6 +170,217 @@ int nrnmpi_spike_exchange_impl(int* nin,
     return n;
 }
 
+/*
+Allgather with an inline buffer sized at run time, see SpikebufTuner. This
+is the nrn_spikebuf_size method with the capacity as an argument. spbufout
+holds 1 + capacity spikes, the gid of the first one is the number of spikes of
+this rank and the following ones are its first spikes. spikeout holds all the
+nout spikes of this rank; those beyond capacity are gathered into spikein with
+an MPI_Allgatherv, only when some rank overflows. On return nin has the spike
+count of each rank and ovfl the number of spikes in spikein.
+*/
+int nrnmpi_spike_exchange_inline_impl(int capacity,
+                                      NRNMPI_Spike* spbufout,
+                                      NRNMPI_Spike* spbufin,
+                                      int* nin,
+                                      NRNMPI_Spike* spikeout,
+                                      int nout,
+                                      NRNMPI_Spike** spikein,
+                                      int& icapacity,
+                                      int& ovfl) {
+    nrn_assert(spikein);
+    Instrumentor::phase_begin("spike-exchange");
+
+    {
+        Instrumentor::phase p("imbalance");
+        wait_before_spike_exchange();
+    }
+
+    Instrumentor::phase_begin("communication");
+    if (!displs) {
+        np = nrnmpi_numprocs_;
+        displs = (int*) emalloc(np * sizeof(int));
+        displs[0] = 0;
+    }
+    if (!ovflcnt) {
+        ovflcnt = (int*) emalloc(np * sizeof(int));
+    }
+    MPI_Allgather(
+        spbufout, capacity + 1, spike_type, spbufin, capacity + 1, spike_type, nrnmpi_comm);
+    int n = 0;
+    int novfl = 0;
+    for (int i = 0; i < np; ++i) {
+        nin[i] = spbufin[i * (capacity + 1)].gid;
+        n += nin[i];
+        displs[i] = novfl;
+        ovflcnt[i] = nin[i] > capacity ? nin[i] - capacity : 0;
+        novfl += ovflcnt[i];
+    }
+    if (novfl) {
+        if (icapacity < novfl) {
+            icapacity = novfl + 10;
+            free(*spikein);
+            *spikein = (NRNMPI_Spike*) emalloc(icapacity * sizeof(NRNMPI_Spike));
+        }
+        int n1 = nout > capacity ? nout - capacity : 0;
+        MPI_Allgatherv(spikeout + (n1 ? capacity : 0),
+                       n1,
+                       spike_type,
+                       *spikein,
+                       ovflcnt,
+                       displs,
+                       spike_type,
+                       nrnmpi_comm);
+    }
+    ovfl = novfl;
+    Instrumentor::phase_end("communication");
+    Instrumentor::phase_end("spike-exchange");
+    return n;
+}
+
+/*
+Overlapped exchange. At the end of an interval the spike counts are gathered
+with MPI_Iallgather and the caller goes on integrating. As soon as the counts
+are known (nrnmpi_spike_exchange_test, called while integrating) the spikes are
+gathered with MPI_Iallgatherv. nrnmpi_spike_exchange_wait completes both and
+returns the number of spikes in spikein. nin and spikeout must not be touched
+by the caller between post and wait.
+The Iallgatherv is started at a different moment on each rank, possibly
+after other collectives of nrnmpi_comm (gap junction transfer, report
+reductions) were issued. Both requests use their own duplicate of
+nrnmpi_comm so that the collectives of each communicator stay in the same
+order on every rank.
+*/
+static MPI_Request count_request{MPI_REQUEST_NULL};
+static MPI_Request spike_request{MPI_REQUEST_NULL};
+static int* posted_nin;
+static int posted_nout;
+static int posted_n;
+static NRNMPI_Spike* posted_spikeout;
+
+void nrnmpi_spike_exchange_post_impl(int* nin, NRNMPI_Spike* spikeout, int nout) {
+    nrn_assert(count_request == MPI_REQUEST_NULL && spike_request == MPI_REQUEST_NULL);
+    if (!displs) {
+        np = nrnmpi_numprocs_;
+        displs = (int*) emalloc(np * sizeof(int));
+        displs[0] = 0;
+    }
+    if (overlap_comm == MPI_COMM_NULL) {
+        nrn_assert(MPI_Comm_dup(nrnmpi_comm, &overlap_comm) == MPI_SUCCESS);
+    }
+    posted_nin = nin;
+    posted_nout = nout;
+    posted_n = -1;
+    posted_spikeout = spikeout;
+    MPI_Iallgather(&posted_nout, 1, MPI_INT, nin, 1, MPI_INT, overlap_comm, &count_request);
+}
+
+/* once the counts are known, size spikein and start gathering the spikes */
+static void spike_exchange_post_spikes(NRNMPI_Spike** spikein, int& icapacity) {
+    int n = posted_nin[0];
+    for (int i = 1; i < np; ++i) {
+        displs[i] = n;
+        n += posted_nin[i];
+    }
+    if (n) {
+        if (icapacity < n) {
+            icapacity = n + 10;
+            free(*spikein);
+            *spikein = (NRNMPI_Spike*) emalloc(icapacity * sizeof(NRNMPI_Spike));
+        }
+        MPI_Iallgatherv(posted_spikeout,
+                        posted_nout,
+                        spike_type,
+                        *spikein,
+                        posted_nin,
+                        displs,
+                        spike_type,
+                        overlap_comm,
+                        &spike_request);
+    }
+    posted_n = n;
+}
+
+void nrnmpi_spike_exchange_test_impl(NRNMPI_Spike** spikein, int& icapacity) {
+    if (count_request != MPI_REQUEST_NULL) {
+        int flag = 0;
+        MPI_Test(&count_request, &flag, MPI_STATUS_IGNORE);
+        if (flag) {
+            spike_exchange_post_spikes(spikein, icapacity);
+        }
+    } else if (spike_request != MPI_REQUEST_NULL) {
+        int flag = 0;
+        MPI_Test(&spike_request, &flag, MPI_STATUS_IGNORE);
+    }
+}
+
+int nrnmpi_spike_exchange_wait_impl(NRNMPI_Spike** spikein, int& icapacity) {
+    nrn_assert(spikein);
+    Instrumentor::phase p_spike_exchange("spike-exchange");
+    {
+        Instrumentor::phase p("imbalance");
+        if (count_request != MPI_REQUEST_NULL) {
+            MPI_Wait(&count_request, MPI_STATUS_IGNORE);
+            spike_exchange_post_spikes(spikein, icapacity);
+        }
+    }
+    Instrumentor::phase p("communication");
+    MPI_Wait(&spike_request, MPI_STATUS_IGNORE);
+    return posted_n;
+}
+
+/*
+Sparse exchange. Spikes go only to the ranks that have an InputPreSyn for
+their gid. The neighbourhood is fixed at setup as a distributed graph
+communicator with an edge from each rank to the ranks that want some of its
+gids. sbuf holds the spikes for each destination rank, in the order of dests
+given to nrnmpi_sparse_exchange_setup, and rbuf receives the spikes from
+each source rank, in the order of srcs.
+*/
+void nrnmpi_sparse_exchange_setup_impl(int nsrc, int* srcs, int ndest, int* dests) {
+    if (sparse_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&sparse_comm);
+    }
+    MPI_Dist_graph_create_adjacent(nrnmpi_comm,
+                                   nsrc,
+                                   srcs,
+                                   MPI_UNWEIGHTED,
+                                   ndest,
+                                   dests,
+                                   MPI_UNWEIGHTED,
+                                   MPI_INFO_NULL,
+                                   0,
+                                   &sparse_comm);
+}
+
+int nrnmpi_sparse_exchange_impl(NRNMPI_Spike* sbuf,
+                                int* scnt,
+                                int* sdispl,
+                                NRNMPI_Spike** rbuf,
+                                int& rcapacity,
+                                int* rcnt,
+                                int* rdispl) {
+    nrn_assert(rbuf && sparse_comm != MPI_COMM_NULL);
+    Instrumentor::phase p_spike_exchange("spike-exchange");
+    Instrumentor::phase p("communication");
+    int indegree, outdegree, weighted;
+    MPI_Dist_graph_neighbors_count(sparse_comm, &indegree, &outdegree, &weighted);
+    MPI_Neighbor_alltoall(scnt, 1, MPI_INT, rcnt, 1, MPI_INT, sparse_comm);
+    int n = 0;
+    for (int i = 0; i < indegree; ++i) {
+        rdispl[i] = n;
+        n += rcnt[i];
+    }
+    if (rcapacity < n) {
+        rcapacity = n + 10;
+        free(*rbuf);
+        *rbuf = (NRNMPI_Spike*) emalloc(rcapacity * sizeof(NRNMPI_Spike));
+    }
+    MPI_Neighbor_alltoallv(
+        sbuf, scnt, sdispl, spike_type, *rbuf, rcnt, rdispl, spike_type, sparse_comm);
+    return n;
+}
+
 /*
 The compressed spike format is restricted to the fixed step method and is
 a sequence of unsigned char.
@@ -266,6 +491,55 @@ extern void nrnmpi_dbl_alltoallv_impl(double* s,
     MPI_Alltoallv(s, scnt, sdispl, MPI_DOUBLE, r, rcnt, rdispl, MPI_DOUBLE, nrnmpi_comm);
 }
 
+/*
+Neighbour exchange, used by the overlapped gap junction transfer. The counts
+and displacements are those of nrnmpi_dbl_alltoallv but only the ranks in
+sranks and rranks are sent to and received from, without any collective.
+The buffers must not be touched until nrnmpi_dbl_neighbor_exchange_wait.
+*/
+static std::vector<MPI_Request> neighbor_requests;
+static constexpr int neighbor_exchange_tag = 3;
+
+void nrnmpi_dbl_neighbor_exchange_post_impl(double* s,
+                                            const int* scnt,
+                                            const int* sdispl,
+                                            int nsend,
+                                            const int* sranks,
+                                            double* r,
+                                            const int* rcnt,
+                                            const int* rdispl,
+                                            int nrecv,
+                                            const int* rranks) {
+    nrn_assert(neighbor_requests.empty());
+    neighbor_requests.resize(nrecv + nsend);
+    MPI_Request* request = neighbor_requests.data();
+    for (int i = 0; i < nrecv; ++i) {
+        int rank = rranks[i];
+        MPI_Irecv(r + rdispl[rank],
+                  rcnt[rank],
+                  MPI_DOUBLE,
+                  rank,
+                  neighbor_exchange_tag,
+                  nrnmpi_comm,
+                  request++);
+    }
+    for (int i = 0; i < nsend; ++i) {
+        int rank = sranks[i];
+        MPI_Isend(s + sdispl[rank],
+                  scnt[rank],
+                  MPI_DOUBLE,
+                  rank,
+                  neighbor_exchange_tag,
+                  nrnmpi_comm,
+                  request++);
+    }
+}
+
+void nrnmpi_dbl_neighbor_exchange_wait_impl() {
+    MPI_Waitall(neighbor_requests.size(), neighbor_requests.data(), MPI_STATUSES_IGNORE);
+    neighbor_requests.clear();
+}
+
 /* following are for the partrans */
 
 void nrnmpi_int_allgather_impl(int* s, int* r, int n) {
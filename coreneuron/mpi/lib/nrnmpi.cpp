@@ -6,6 +6,7 @@
 # =============================================================================.
 */
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <tuple>
@@ -68,6 +69,7 @@ nrnmpi_init_ret_t nrnmpi_init_impl(int* pargc, char*** pargv, bool is_quiet) {
 void nrnmpi_finalize_impl(void) {
     if (nrnmpi_under_nrncontrol_) {
         if (nrnmpi_initialized_impl()) {
+            nrnmpi_spike_finalize();
             MPI_Comm_free(&nrnmpi_world_comm);
             MPI_Comm_free(&nrnmpi_comm);
             MPI_Finalize();
@@ -149,6 +151,9 @@ int nrnmpi_local_size_impl() {
  * @param filename Name of the file to write
  * @param buffer Buffer to write
  * @param length Length of the buffer to write
+ *
+ * MPI counts are int, so buffers larger than INT_MAX bytes are written
+ * with several collective calls. All ranks make the same number of calls.
  */
 void nrnmpi_write_file_impl(const std::string& filename, const char* buffer, size_t length) {
     MPI_File fh;
@@ -156,7 +161,13 @@ void nrnmpi_write_file_impl(const std::string& filename, const char* buffer, siz
 
     // global offset into file
     unsigned long offset = 0;
-    MPI_Exscan(&length, &offset, 1, MPI_UNSIGNED_LONG, MPI_SUM, nrnmpi_comm);
+    unsigned long ulength = length;
+    MPI_Exscan(&ulength, &offset, 1, MPI_UNSIGNED_LONG, MPI_SUM, nrnmpi_comm);
+
+    const size_t max_chunk = 1UL << 30;
+    unsigned long nchunk = (length + max_chunk - 1) / max_chunk;
+    unsigned long max_nchunk = 0;
+    MPI_Allreduce(&nchunk, &max_nchunk, 1, MPI_UNSIGNED_LONG, MPI_MAX, nrnmpi_comm);
 
     int op_status = MPI_File_open(
         nrnmpi_comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
@@ -165,12 +176,119 @@ void nrnmpi_write_file_impl(const std::string& filename, const char* buffer, siz
         abort();
     }
 
-    op_status = MPI_File_write_at_all(fh, offset, buffer, length, MPI_BYTE, &status);
+    for (unsigned long i = 0; i < max_nchunk; ++i) {
+        size_t begin = std::min(length, i * max_chunk);
+        int count = static_cast<int>(std::min(length - begin, max_chunk));
+        op_status = MPI_File_write_at_all(
+            fh, offset + begin, buffer + begin, count, MPI_BYTE, &status);
+        if (op_status != MPI_SUCCESS && nrnmpi_myid_ == 0) {
+            std::cerr << "Error while writing output " << std::endl;
+            abort();
+        }
+    }
+
+    MPI_File_close(&fh);
+}
+
+/// File written incrementally by the nrnmpi_file_stream_* functions
+struct FileStream {
+    MPI_File fh;
+    /// End of the data written so far
+    unsigned long offset = 0;
+    /// Pending writes of the two buffer slots
+    std::vector<MPI_Request> requests[2];
+};
+/// Indexed by the stream ids returned by nrnmpi_file_stream_open, closed ones are reused
+static std::vector<FileStream> streams;
+static std::vector<bool> stream_open;
+
+/**
+ * Open a new file to be written incrementally with nrnmpi_file_stream_write
+ *
+ * Several streams can be open at the same time. This is a collective across
+ * all ranks, which must open and close the streams in the same order.
+ *
+ * @param filename Name of the file to write
+ * @return Id of the stream
+ */
+int nrnmpi_file_stream_open_impl(const std::string& filename) {
+    int id = std::find(stream_open.begin(), stream_open.end(), false) - stream_open.begin();
+    if (id == static_cast<int>(streams.size())) {
+        streams.emplace_back();
+        stream_open.push_back(false);
+    }
+    FileStream& stream = streams[id];
+    int op_status = MPI_File_open(nrnmpi_comm,
+                                  filename.c_str(),
+                                  MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                                  MPI_INFO_NULL,
+                                  &stream.fh);
     if (op_status != MPI_SUCCESS && nrnmpi_myid_ == 0) {
-        std::cerr << "Error while writing output " << std::endl;
+        std::cerr << "Error while opening output file " << filename << std::endl;
         abort();
     }
+    stream.offset = 0;
+    stream_open[id] = true;
+    return id;
+}
 
-    MPI_File_close(&fh);
+/**
+ * Append buffers to the stream file without waiting for the write to complete
+ *
+ * Like nrnmpi_write_file, buffers of all ranks are written one after the
+ * other in rank order, after the data of the previous calls. This is a
+ * collective across all ranks. The caller alternates between two buffers
+ * (slot 0 and 1) and must not modify a buffer until nrnmpi_file_stream_wait
+ * has been called for its slot, so that i/o overlaps with computation.
+ *
+ * @param id Stream id
+ * @param slot Buffer slot, 0 or 1
+ * @param buffer Buffer to write
+ * @param length Length of the buffer to write
+ */
+void nrnmpi_file_stream_write_impl(int id, int slot, const char* buffer, size_t length) {
+    FileStream& stream = streams[id];
+    unsigned long ulength = length;
+    unsigned long offset = 0;
+    unsigned long total = 0;
+    MPI_Exscan(&ulength, &offset, 1, MPI_UNSIGNED_LONG, MPI_SUM, nrnmpi_comm);
+    MPI_Allreduce(&ulength, &total, 1, MPI_UNSIGNED_LONG, MPI_SUM, nrnmpi_comm);
+    if (nrnmpi_myid_ == 0) {
+        offset = 0;
+    }
+
+    const size_t max_chunk = 1UL << 30;
+    for (size_t begin = 0; begin < length; begin += max_chunk) {
+        int count = static_cast<int>(std::min(length - begin, max_chunk));
+        MPI_Request request;
+        int op_status = MPI_File_iwrite_at(
+            stream.fh, stream.offset + offset + begin, buffer + begin, count, MPI_BYTE, &request);
+        if (op_status != MPI_SUCCESS) {
+            std::cerr << "Error while writing output " << std::endl;
+            abort();
+        }
+        stream.requests[slot].push_back(request);
+    }
+    stream.offset += total;
+}
+
+/**
+ * Wait for the pending writes of the given buffer slot
+ *
+ * @param id Stream id
+ * @param slot Buffer slot, 0 or 1
+ */
+void nrnmpi_file_stream_wait_impl(int id, int slot) {
+    auto& requests = streams[id].requests[slot];
+    MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+    requests.clear();
+}
+
+/// Wait for all pending writes and close the stream file
+void nrnmpi_file_stream_close_impl(int id) {
+    nrnmpi_file_stream_wait_impl(id, 0);
+    nrnmpi_file_stream_wait_impl(id, 1);
+    MPI_File_close(&streams[id].fh);
+    stream_open[id] = false;
 }
 }  // namespace coreneuron
@@ -5,4 +5,5 @@ namespace coreneuron {
 extern int nrnmpi_numprocs_;
 extern int nrnmpi_myid_;
 void nrnmpi_spike_initialize();
+void nrnmpi_spike_finalize();
 }  // namespace coreneuron
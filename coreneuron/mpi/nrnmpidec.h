@@ -31,6 +31,19 @@ extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_check_threading_support
 // Write given buffer to a new file using MPI collective I/O
 extern "C" void nrnmpi_write_file_impl(const std::string& filename, const char* buffer, size_t length);
 extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_write_file_impl)> nrnmpi_write_file;
+// Write buffers to a file incrementally with non-blocking MPI I/O
+extern "C" int nrnmpi_file_stream_open_impl(const std::string& filename);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_file_stream_open_impl)>
+    nrnmpi_file_stream_open;
+extern "C" void nrnmpi_file_stream_write_impl(int id, int slot, const char* buffer, size_t length);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_file_stream_write_impl)>
+    nrnmpi_file_stream_write;
+extern "C" void nrnmpi_file_stream_wait_impl(int id, int slot);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_file_stream_wait_impl)>
+    nrnmpi_file_stream_wait;
+extern "C" void nrnmpi_file_stream_close_impl(int id);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_file_stream_close_impl)>
+    nrnmpi_file_stream_close;
 
 
 /* from mpispike.cpp */
@@ -40,6 +53,24 @@ extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_impl)>
 extern "C" int nrnmpi_spike_exchange_compressed_impl(int, unsigned char*, int, int*, int, unsigned char*, int, unsigned char*, int& ovfl);
 extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_compressed_impl)>
     nrnmpi_spike_exchange_compressed;
+extern "C" void nrnmpi_spike_exchange_post_impl(int* nin, NRNMPI_Spike* spikeout, int nout);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_post_impl)>
+    nrnmpi_spike_exchange_post;
+extern "C" void nrnmpi_spike_exchange_test_impl(NRNMPI_Spike** spikein, int& icapacity);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_test_impl)>
+    nrnmpi_spike_exchange_test;
+extern "C" int nrnmpi_spike_exchange_wait_impl(NRNMPI_Spike** spikein, int& icapacity);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_wait_impl)>
+    nrnmpi_spike_exchange_wait;
+extern "C" int nrnmpi_spike_exchange_inline_impl(int capacity, NRNMPI_Spike* spbufout, NRNMPI_Spike* spbufin, int* nin, NRNMPI_Spike* spikeout, int nout, NRNMPI_Spike** spikein, int& icapacity, int& ovfl);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_inline_impl)>
+    nrnmpi_spike_exchange_inline;
+extern "C" void nrnmpi_sparse_exchange_setup_impl(int nsrc, int* srcs, int ndest, int* dests);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_sparse_exchange_setup_impl)>
+    nrnmpi_sparse_exchange_setup;
+extern "C" int nrnmpi_sparse_exchange_impl(NRNMPI_Spike* sbuf, int* scnt, int* sdispl, NRNMPI_Spike** rbuf, int& rcapacity, int* rcnt, int* rdispl);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_sparse_exchange_impl)>
+    nrnmpi_sparse_exchange;
 extern "C" int nrnmpi_int_allmax_impl(int i);
 extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_int_allmax_impl)> nrnmpi_int_allmax;
 extern "C" void nrnmpi_int_allgather_impl(int* s, int* r, int n);
@@ -60,6 +91,21 @@ extern "C" void nrnmpi_dbl_alltoallv_impl(double* s,
                                       int* rcnt,
                                       int* rdispl);
 extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_alltoallv_impl)> nrnmpi_dbl_alltoallv;
+extern "C" void nrnmpi_dbl_neighbor_exchange_post_impl(double* s,
+                                                      const int* scnt,
+                                                      const int* sdispl,
+                                                      int nsend,
+                                                      const int* sranks,
+                                                      double* r,
+                                                      const int* rcnt,
+                                                      const int* rdispl,
+                                                      int nrecv,
+                                                      const int* rranks);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_neighbor_exchange_post_impl)>
+    nrnmpi_dbl_neighbor_exchange_post;
+extern "C" void nrnmpi_dbl_neighbor_exchange_wait_impl();
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_neighbor_exchange_wait_impl)>
+    nrnmpi_dbl_neighbor_exchange_wait;
 extern "C" double nrnmpi_dbl_allmin_impl(double x);
 extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_allmin_impl)> nrnmpi_dbl_allmin;
 extern "C" double nrnmpi_dbl_allmax_impl(double x);
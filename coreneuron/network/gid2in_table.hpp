@@ -0,0 +1,119 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace coreneuron {
+class InputPreSyn;
+
+/**
+ * \class Gid2InTable
+ * \brief Flat open addressing hash table from gid to InputPreSyn*
+ *
+ * The gid2in std::map is convenient during setup but every received spike
+ * goes through a pointer chasing red-black tree lookup. After
+ * determine_inputpresyn() the set of InputPreSyn is fixed, so the map is
+ * copied once into a power of two sized array of (gid, InputPreSyn*) slots
+ * with linear probing. The load factor is kept below 1/2 so that a probe
+ * sequence rarely leaves the cache line of the home slot.
+ *
+ * Only non-negative gids are stored (InputPreSyn never have negative gids),
+ * which allows -1 to mark an empty slot.
+ */
+class Gid2InTable {
+  public:
+    Gid2InTable() = default;
+
+    /// (Re)build the table from the content of a gid to InputPreSyn map
+    void build(const std::map<int, InputPreSyn*>& gid2in) {
+        std::size_t capacity = 16;
+        while (capacity < 2 * gid2in.size()) {
+            capacity <<= 1;
+        }
+        shift_ = 64;
+        for (std::size_t c = capacity; c > 1; c >>= 1) {
+            --shift_;
+        }
+        mask_ = capacity - 1;
+        slots_.assign(capacity, Slot{});
+        size_ = 0;
+        for (const auto& g: gid2in) {
+            insert(g.first, g.second);
+        }
+    }
+
+    /// Return the InputPreSyn for gid or nullptr if this rank has none
+    inline InputPreSyn* find(int gid) const {
+        if (slots_.empty()) {
+            return nullptr;
+        }
+        for (std::size_t i = home(gid);; i = (i + 1) & mask_) {
+            const Slot& s = slots_[i];
+            if (s.gid == gid) {
+                return s.ps;
+            }
+            if (s.gid == empty_gid) {
+                return nullptr;
+            }
+        }
+    }
+
+    void clear() {
+        slots_.clear();
+        slots_.shrink_to_fit();
+        size_ = 0;
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    /// Memory used by the slot array
+    std::size_t bytes() const {
+        return sizeof(*this) + slots_.capacity() * sizeof(Slot);
+    }
+
+  private:
+    static constexpr int empty_gid = -1;
+
+    struct Slot {
+        int gid = empty_gid;
+        InputPreSyn* ps = nullptr;
+    };
+
+    /// Fibonacci hashing: spreads consecutive gids over the whole table
+    inline std::size_t home(int gid) const {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(gid) *
+                                         UINT64_C(0x9E3779B97F4A7C15)) >>
+                                        shift_);
+    }
+
+    void insert(int gid, InputPreSyn* ps) {
+        std::size_t i = home(gid);
+        while (slots_[i].gid != empty_gid && slots_[i].gid != gid) {
+            i = (i + 1) & mask_;
+        }
+        if (slots_[i].gid == empty_gid) {
+            ++size_;
+        }
+        slots_[i].gid = gid;
+        slots_[i].ps = ps;
+    }
+
+    std::vector<Slot> slots_;
+    std::size_t mask_ = 0;
+    unsigned shift_ = 64;
+    std::size_t size_ = 0;
+};
+
+}  // namespace coreneuron
@@ -231,9 +231,8 @@ void Multisend_ReceiveBuffer::enqueue() {
     for (int i = 0; i < count_; ++i) {
         NRNMPI_Spike* spk = buffer_[i];
 
-        auto gid2in_it = gid2in.find(spk->gid);
-        assert(gid2in_it != gid2in.end());
-        InputPreSyn* ps = gid2in_it->second;
+        InputPreSyn* ps = gid2in_table.find(spk->gid);
+        assert(ps);
 
         if (use_phase2_ && ps->multisend_phase2_index_ >= 0) {
             Phase2Buffer& pb = phase2_buffer_[phase2_head_++];
@@ -266,9 +265,8 @@ void Multisend_ReceiveBuffer::enqueue1() {
     for (int i = 0; i < count_; ++i) {
         NRNMPI_Spike* spk = buffer_[i];
 
-        auto gid2in_it = gid2in.find(spk->gid);
-        assert(gid2in_it != gid2in.end());
-        InputPreSyn* ps = gid2in_it->second;
+        InputPreSyn* ps = gid2in_table.find(spk->gid);
+        assert(ps);
         psbuf_[i] = ps;
         if (use_phase2_ && ps->multisend_phase2_index_ >= 0) {
             Phase2Buffer& pb = phase2_buffer_[phase2_head_++];
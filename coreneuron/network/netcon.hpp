@@ -125,7 +125,7 @@ class PreSyn: public ConditionEvent {
     }
 
     virtual double value(NrnThread*) override;
-    void record(double t);
+    void record(double t, NrnThread* nt);
 #if NRN_MULTISEND
     int multisend_index_{-1};
 #endif
@@ -6,7 +6,9 @@
 # =============================================================================.
 */
 
+#include <algorithm>
 #include <float.h>
+#include <limits>
 #include <map>
 #include <mutex>
 
@@ -25,6 +27,7 @@
 #include "coreneuron/mechanism/membfunc.hpp"
 #include "coreneuron/coreneuron.hpp"
 #include "coreneuron/utils/nrnoc_aux.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
 
 #ifdef _OPENACC
 #include <openacc.h>
@@ -40,6 +43,8 @@ bool cvode_active_;
 
 /// Flag to use the bin queue
 bool nrn_use_bin_queue_ = 0;
+container nrn_event_queue_ = QTYPE;
+bool nrn_interthread_mutex_ = false;
 
 void mk_netcvode() {
     if (!net_cvode_instance) {
@@ -80,7 +85,7 @@ void net_sem_from_gpu(int sendtype,
 void net_send(void** v, int weight_index_, Point_process* pnt, double td, double flag) {
     NrnThread* nt = PP2NT(pnt);
     NetCvodeThreadData& p = net_cvode_instance->p[nt->id];
-    SelfEvent* se = new SelfEvent;
+    SelfEvent* se = p.selfevent_pool_.alloc();
     se->flag_ = flag;
     se->target_ = pnt;
     se->weight_index_ = weight_index_;
@@ -123,27 +128,63 @@ void net_event(Point_process* pnt, double time) {
 }
 
 NetCvodeThreadData::NetCvodeThreadData()
-    : tqe_{new TQueue<QTYPE>()} {
+    : tqe_{new TQueue<QTYPE>(nrn_event_queue_, &tqitem_pool_)} {
     inter_thread_events_.reserve(1000);
+    init_mailboxes(1);
 }
 
 NetCvodeThreadData::~NetCvodeThreadData() {
     delete tqe_;
 }
 
-/// If the PreSyn is on a different thread than the target,
-/// we have to lock the buffer
-void NetCvodeThreadData::interthread_send(double td, DiscreteEvent* db, NrnThread* /* nt */) {
-    std::lock_guard<OMP_Mutex> lock(mut);
-    inter_thread_events_.emplace_back(InterThreadEvent{db, td});
+void NetCvodeThreadData::init_mailboxes(int nthread) {
+    inter_thread_mailboxes_.clear();
+    for (int i = 0; i < nthread; ++i) {
+        inter_thread_mailboxes_.emplace_back(new InterThreadMailbox);
+    }
+}
+
+/// If the PreSyn is on a different thread than the target, the event goes
+/// through the mailbox of the sending thread (or the locked buffer)
+void NetCvodeThreadData::interthread_send(double td, DiscreteEvent* db, NrnThread* nt) {
+    if (nrn_interthread_mutex_) {
+        std::lock_guard<OMP_Mutex> lock(mut);
+        inter_thread_events_.emplace_back(InterThreadEvent{db, td});
+    } else {
+        int src = nt ? nt->id : 0;
+        assert(src < int(inter_thread_mailboxes_.size()));
+        inter_thread_mailboxes_[src]->push(InterThreadEvent{db, td});
+    }
 }
 
 void NetCvodeThreadData::enqueue(NetCvode* nc, NrnThread* nt) {
-    std::lock_guard<OMP_Mutex> lock(mut);
-    for (const auto& ite: inter_thread_events_) {
-        nc->bin_event(ite.t_, ite.de_, nt);
+    if (nrn_interthread_mutex_) {
+        std::lock_guard<OMP_Mutex> lock(mut);
+        for (const auto& ite: inter_thread_events_) {
+            nc->bin_event(ite.t_, ite.de_, nt);
+        }
+        inter_thread_events_.clear();
+    } else {
+        for (auto& mailbox: inter_thread_mailboxes_) {
+            mailbox->drain(
+                [&](const InterThreadEvent& ite) { nc->bin_event(ite.t_, ite.de_, nt); });
+        }
     }
+}
+
+std::size_t NetCvodeThreadData::n_inter_thread_events() const {
+    std::size_t n = inter_thread_events_.size();
+    for (const auto& mailbox: inter_thread_mailboxes_) {
+        n += mailbox->size();
+    }
+    return n;
+}
+
+void NetCvodeThreadData::clear_inter_thread_events() {
     inter_thread_events_.clear();
+    for (auto& mailbox: inter_thread_mailboxes_) {
+        mailbox->clear();
+    }
 }
 
 NetCvode::NetCvode() {
@@ -182,10 +223,14 @@ void NetCvode::p_construct(int n) {
             p = nullptr;
         }
 
-        if (n > 0)
+        if (n > 0) {
             p = new NetCvodeThreadData[n];
-        else
+            for (int i = 0; i < n; ++i) {
+                p[i].init_mailboxes(n);
+            }
+        } else {
             p = nullptr;
+        }
 
         pcnt_ = n;
     }
@@ -228,9 +273,12 @@ void NetCvode::clear_events() {
     for (int i = 0; i < nrn_nthread; ++i) {
         NetCvodeThreadData& d = p[i];
         delete d.tqe_;
-        d.tqe_ = new TQueue<QTYPE>();
+        // also reclaims the SelfEvent of the items that were still on the queue
+        d.tqitem_pool_.clear();
+        d.selfevent_pool_.clear();
+        d.tqe_ = new TQueue<QTYPE>(nrn_event_queue_, &d.tqitem_pool_);
         d.unreffed_event_cnt_ = 0;
-        d.inter_thread_events_.clear();
+        d.clear_inter_thread_events();
         d.tqe_->nshift_ = -1;
         d.tqe_->shift_bin(nrn_threads->_t);
     }
@@ -270,14 +318,15 @@ void NetCvode::init_events() {
 }
 
 bool NetCvode::deliver_event(double til, NrnThread* nt) {
-    TQItem* q = p[nt->id].tqe_->atomic_dq(til);
+    NetCvodeThreadData& d = p[nt->id];
+    TQItem* q = d.tqe_->atomic_dq(til);
     if (q == nullptr) {
         return false;
     }
 
     DiscreteEvent* de = (DiscreteEvent*) q->data_;
     double tt = q->t_;
-    delete q;
+    d.tqe_->release(q);
 #if PRINT_EVENT
     if (print_event_) {
         de->pr("deliver", tt, this);
@@ -287,7 +336,7 @@ bool NetCvode::deliver_event(double til, NrnThread* nt) {
 
     /// In case of a self event we need to delete the self event
     if (de->type() == SelfEventType)
-        delete (SelfEvent*) de;
+        d.selfevent_pool_.release((SelfEvent*) de);
 
     return true;
 }
@@ -337,13 +386,10 @@ void NetCvode::deliver_events(double til, NrnThread* nt) {
         ;
 }
 
-void PreSyn::record(double tt) {
-    spikevec_lock();
+void PreSyn::record(double tt, NrnThread* nt) {
     if (gid_ > -1) {
-        spikevec_gid.push_back(gid_);
-        spikevec_time.push_back(tt);
+        spikevec_record(nt->id, gid_, tt);
     }
-    spikevec_unlock();
 }
 
 bool ConditionEvent::check(NrnThread* nt) {
@@ -386,9 +432,7 @@ void NetCon::deliver(double tt, NetCvode* /* ns */, NrnThread* nt) {
     nt->_t = tt;
 
     // printf("NetCon::deliver t=%g tt=%g %s\n", t, tt, pnt_name(target_));
-    std::string ss("net-receive-");
-    ss += nrn_get_mechname(typ);
-    Instrumentor::phase p_get_pnt_receive(ss.c_str());
+    Instrumentor::phase p_get_pnt_receive(Instrumentor::mech_phase::net_receive, typ);
     (*corenrn.get_pnt_receive()[typ])(target_, u.weight_index_, 0);
 #ifdef DEBUG
     if (errno && nrn_errno_check(typ))
@@ -406,7 +450,7 @@ void NetCon::pr(const char* s, double tt, NetCvode* /* ns */) {
 }
 
 void PreSyn::send(double tt, NetCvode* ns, NrnThread* nt) {
-    record(tt);
+    record(tt, nt);
     for (int i = nc_cnt_ - 1; i >= 0; --i) {
         NetCon* d = netcon_in_presyn_order_[nc_index_ + i];
         if (d->active_ && d->target_) {
@@ -415,7 +459,7 @@ void PreSyn::send(double tt, NetCvode* ns, NrnThread* nt) {
             if (nt == n)
                 ns->bin_event(tt + d->delay_, d, n);
             else
-                ns->p[n->id].interthread_send(tt + d->delay_, d, n);
+                ns->p[n->id].interthread_send(tt + d->delay_, d, nt);
         }
     }
 
@@ -447,7 +491,7 @@ void InputPreSyn::send(double tt, NetCvode* ns, NrnThread* nt) {
             if (nt == n)
                 ns->bin_event(tt + d->delay_, d, n);
             else
-                ns->p[n->id].interthread_send(tt + d->delay_, d, n);
+                ns->p[n->id].interthread_send(tt + d->delay_, d, nt);
         }
     }
 }
@@ -487,7 +531,9 @@ void SelfEvent::pr(const char* s, double tt, NetCvode*) {
 void ncs2nrn_integrate(double tstop) {
     int total_sim_steps = static_cast<int>((tstop - nrn_threads->_t) / dt + 1e-9);
 
-    if (total_sim_steps > 3 && !nrn_have_gaps) {
+    if (total_sim_steps > 3 && corenrn_param.persistent_threads) {
+        nrn_fixed_step_persistent(total_sim_steps);
+    } else if (total_sim_steps > 3 && !nrn_have_gaps) {
         nrn_fixed_step_group_minimal(total_sim_steps);
     } else {
         nrn_fixed_single_steps_minimal(total_sim_steps, tstop);
@@ -521,14 +567,67 @@ double PreSyn::value(NrnThread* nt) {
     return nt->_actual_v[thvar_index_] - threshold_;
 }
 
+void nrn_threshold_table_setup(NrnThread& nt) {
+    // A real cell without a presyn watches node 0 with a threshold that is never reached.
+    nt.presyns_thvar_index = (int*) ecalloc_align(nt.ncell, sizeof(int));
+    nt.presyns_threshold = (double*) ecalloc_align(nt.ncell, sizeof(double));
+    for (int i = 0; i < nt.ncell; ++i) {
+        const PreSyn& ps = nt.presyns[i];
+        if (ps.thvar_index_ >= 0) {
+            nt.presyns_thvar_index[i] = ps.thvar_index_;
+            nt.presyns_threshold[i] = ps.threshold_;
+        } else {
+            nt.presyns_thvar_index[i] = 0;
+            nt.presyns_threshold[i] = std::numeric_limits<double>::infinity();
+        }
+    }
+}
+
+/// Branch free threshold detection over the SoA threshold table of a thread.
+/// Same semantics as pscheck: a cell fires when above threshold and its flag
+/// was off, and the flag follows the above state. The compare (with the
+/// gather of v) is done for a block of cells in a loop without dependences
+/// that the compiler can vectorize, then the indices of the firing cells are
+/// compacted into nsbuf. nsbuf must hold at least ncell entries.
+int nrn_threshold_compact(int ncell,
+                          const int* thvar_index,
+                          const double* threshold,
+                          const double* actual_v,
+                          PreSynHelper* presyns_helper,
+                          int* nsbuf) {
+    constexpr int block = 64;
+    unsigned char fire[block];
+    int cnt = 0;
+    for (int i0 = 0; i0 < ncell; i0 += block) {
+        int n = std::min(block, ncell - i0);
+        unsigned char any = 0;
+        for (int j = 0; j < n; ++j) {
+            int i = i0 + j;
+            int above = actual_v[thvar_index[i]] > threshold[i];
+            fire[j] = above & !presyns_helper[i].flag_;
+            any |= fire[j];
+            presyns_helper[i].flag_ = above;
+        }
+        // spikes are rare, most blocks have nothing to compact
+        if (any) {
+            for (int j = 0; j < n; ++j) {
+                nsbuf[cnt] = i0 + j;
+                cnt += fire[j];
+            }
+        }
+    }
+    return cnt;
+}
+
 void NetCvode::check_thresh(NrnThread* nt) {  // for default method
     Instrumentor::phase p("check-threshold");
     double teps = 1e-10;
 
     nt->_net_send_buffer_cnt = 0;
     int net_send_buf_count = 0;
-    PreSyn* presyns = nt->presyns;
     PreSynHelper* presyns_helper = nt->presyns_helper;
+    const int* thvar_index = nt->presyns_thvar_index;
+    const double* threshold = nt->presyns_threshold;
     double* actual_v = nt->_actual_v;
 
 #if defined(_OPENACC)
@@ -538,47 +637,38 @@ void NetCvode::check_thresh(NrnThread* nt) {  // for default method
     if (nt->ncell == 0)
         return;
 
-        //_net_send_buffer_cnt is no longer used in openacc kernel, remove this?
-        //#ifdef _OPENACC
-        //    if(nt->compute_gpu)
-        //        acc_update_device(&(nt->_net_send_buffer_cnt), sizeof(int));
-        //#endif
+    // _net_send_buffer_size is at least ncell (see phase2), so there is
+    // always room for all the cells
+    assert(nt->_net_send_buffer_size >= nt->ncell);
 
+    if (!nt->compute_gpu) {
+        net_send_buf_count = nrn_threshold_compact(
+            nt->ncell, thvar_index, threshold, actual_v, presyns_helper, nt->_net_send_buffer);
+    } else {
         // on GPU...
         // clang-format off
 
-    #pragma acc parallel loop present(                  \
-        nt[0:1], presyns_helper[0:nt->n_presyn],        \
-        presyns[0:nt->n_presyn], actual_v[0:nt->end])   \
-        copy(net_send_buf_count) if (nt->compute_gpu)   \
-        async(stream_id)
-    // clang-format on
-    for (int i = 0; i < nt->ncell; ++i) {
-        PreSyn* ps = presyns + i;
-        PreSynHelper* psh = presyns_helper + i;
-        int idx = 0;
-        int thidx = ps->thvar_index_;
-        double v = actual_v[thidx];
-        double threshold = ps->threshold_;
-        int* flag = &(psh->flag_);
-
-        if (pscheck(v, threshold, flag)) {
-#ifndef _OPENACC
-            nt->_net_send_buffer_cnt = net_send_buf_count;
-            if (nt->_net_send_buffer_cnt >= nt->_net_send_buffer_size) {
-                nt->_net_send_buffer_size *= 2;
-                nt->_net_send_buffer = (int*) erealloc(nt->_net_send_buffer,
-                                                       nt->_net_send_buffer_size * sizeof(int));
-            }
-#endif
+        #pragma acc parallel loop present(                           \
+            nt[0:1], presyns_helper[0:nt->n_presyn],                 \
+            thvar_index[0:nt->ncell], threshold[0:nt->ncell],        \
+            actual_v[0:nt->end])                                     \
+            copy(net_send_buf_count) if (nt->compute_gpu)            \
+            async(stream_id)
+        // clang-format on
+        for (int i = 0; i < nt->ncell; ++i) {
+            int idx = 0;
+            double v = actual_v[thvar_index[i]];
+            int* flag = &(presyns_helper[i].flag_);
 
-            // clang-format off
+            if (pscheck(v, threshold[i], flag)) {
+                // clang-format off
 
-            #pragma acc atomic capture
-            // clang-format on
-            idx = net_send_buf_count++;
+                #pragma acc atomic capture
+                // clang-format on
+                idx = net_send_buf_count++;
 
-            nt->_net_send_buffer[idx] = i;
+                nt->_net_send_buffer[idx] = i;
+            }
         }
     }
 
@@ -655,6 +745,11 @@ void NetCvode::deliver_net_events(NrnThread* nt) {  // for default method
     if (use_multisend_ && nt->id == 0) {
         nrn_multisend_advance();
     }
+#endif
+#if NRNMPI
+    if (nt->id == 0) {
+        nrn_spike_exchange_progress();
+    }
 #endif
     int tid = nt->id;
     double tsav = nt->_t;
@@ -681,7 +776,7 @@ tryagain:
             }
 #endif
 
-            delete q;
+            p[tid].tqe_->release(q);
             db->deliver(nt->_t, this, nt);
         }
         // assert(int(tm/nt->_dt)%1000 == p[tid].tqe_->nshift_);
@@ -702,9 +797,8 @@ tryagain:
     update_net_receive_buffer(nt);
 
     for (auto& net_buf_receive: corenrn.get_net_buf_receive()) {
-        std::string ss("net-buf-receive-");
-        ss += nrn_get_mechname(net_buf_receive.second);
-        Instrumentor::phase p_net_buf_receive(ss.c_str());
+        Instrumentor::phase p_net_buf_receive(Instrumentor::mech_phase::net_buf_receive,
+                                              net_buf_receive.second);
         (*net_buf_receive.first)(nt);
     }
 }
@@ -9,12 +9,19 @@
 #ifndef netcvode_h
 #define netcvode_h
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "coreneuron/network/netcon.hpp"
 #include "coreneuron/network/tqueue.hpp"
+#include "coreneuron/utils/object_pool.hpp"
 
 #define PRINT_EVENT 0
 
-/** QTYPE options include: spltree, pq_que
- *  STL priority queue is used instead of the splay tree by default.
+/** QTYPE options include: spltree, pq_que, calq
+ *  QTYPE is the default container, see nrn_event_queue_ to change it at runtime.
  *  @todo: check if stl queue works with move_event functions.
  */
 
@@ -32,27 +39,157 @@ extern void deliver_net_events(NrnThread*);
 extern void nrn_deliver_events(NrnThread*);
 extern void fixed_play_continuous(NrnThread*);
 
+struct PreSynHelper;
+/// SoA table of the thvar index and threshold of the real cells of a thread, for check_thresh
+extern void nrn_threshold_table_setup(NrnThread& nt);
+/// Threshold detection of check_thresh on the CPU: update the flags of the ncell cells and
+/// write the indices of the cells that fire to nsbuf. Returns the number of cells that fire.
+extern int nrn_threshold_compact(int ncell,
+                                 const int* thvar_index,
+                                 const double* threshold,
+                                 const double* actual_v,
+                                 PreSynHelper* presyns_helper,
+                                 int* nsbuf);
+
 class DiscreteEvent;
 class NetCvode;
 
 extern NetCvode* net_cvode_instance;
 
+/// container of the thread event queues, QTYPE unless set with --event-queue
+extern container nrn_event_queue_;
+
+/// use the mutex guarded inter_thread_events_ instead of the lock-free
+/// mailboxes, set from the --interthread-mutex option
+extern bool nrn_interthread_mutex_;
+
 struct InterThreadEvent {
     DiscreteEvent* de_;
     double t_;
 };
 
+/**
+ * \class InterThreadMailbox
+ * \brief Unbounded single producer single consumer queue of InterThreadEvent
+ *
+ * Events are appended to a linked list of fixed size blocks. The producer
+ * publishes each event with a release store of the block count and the
+ * consumer reads up to the count it acquires, so neither side ever locks.
+ * A drained block is handed back to the producer through spare_ for reuse,
+ * which avoids a malloc/free pair per block in steady state.
+ */
+class InterThreadMailbox {
+  public:
+    InterThreadMailbox()
+        : head_(new Block)
+        , tail_(head_) {}
+
+    ~InterThreadMailbox() {
+        while (head_) {
+            Block* b = head_->next.load(std::memory_order_relaxed);
+            delete head_;
+            head_ = b;
+        }
+        delete spare_.load(std::memory_order_relaxed);
+    }
+
+    InterThreadMailbox(const InterThreadMailbox&) = delete;
+    InterThreadMailbox& operator=(const InterThreadMailbox&) = delete;
+
+    /// producer side
+    void push(const InterThreadEvent& ite) {
+        std::size_t n = tail_->count.load(std::memory_order_relaxed);
+        if (n == block_size) {
+            Block* b = spare_.exchange(nullptr, std::memory_order_acquire);
+            if (!b) {
+                b = new Block;
+            }
+            tail_->next.store(b, std::memory_order_release);
+            tail_ = b;
+            n = 0;
+        }
+        tail_->events[n] = ite;
+        tail_->count.store(n + 1, std::memory_order_release);
+    }
+
+    /// consumer side, calls f on every published event in the order they were pushed
+    template <typename F>
+    void drain(F&& f) {
+        for (;;) {
+            std::size_t n = head_->count.load(std::memory_order_acquire);
+            for (; read_ < n; ++read_) {
+                f(head_->events[read_]);
+            }
+            if (read_ < block_size) {
+                return;
+            }
+            Block* next = head_->next.load(std::memory_order_acquire);
+            if (!next) {
+                return;
+            }
+            Block* b = head_;
+            head_ = next;
+            read_ = 0;
+            b->count.store(0, std::memory_order_relaxed);
+            b->next.store(nullptr, std::memory_order_relaxed);
+            delete spare_.exchange(b, std::memory_order_release);
+        }
+    }
+
+    /// number of events not yet drained. Only exact when neither side is active
+    std::size_t size() const {
+        std::size_t n = 0;
+        for (const Block* b = head_; b; b = b->next.load(std::memory_order_acquire)) {
+            n += b->count.load(std::memory_order_acquire);
+        }
+        return n - read_;
+    }
+
+    /// drop all events. Only when neither side is active
+    void clear() {
+        drain([](const InterThreadEvent&) {});
+    }
+
+  private:
+    static constexpr std::size_t block_size = 256;
+    struct Block {
+        InterThreadEvent events[block_size];
+        std::atomic<std::size_t> count{0};
+        std::atomic<Block*> next{nullptr};
+    };
+
+    /// consumer
+    Block* head_;
+    std::size_t read_ = 0;
+    /// producer, on its own cache line
+    alignas(64) Block* tail_;
+    alignas(64) std::atomic<Block*> spare_{nullptr};
+};
+
 class NetCvodeThreadData {
   public:
     int unreffed_event_cnt_ = 0;
+    /// TQItem (including bin queue items) and SelfEvent of this thread, reclaimed
+    /// wholesale by NetCvode::clear_events()
+    ObjectPool<TQItem> tqitem_pool_;
+    ObjectPool<SelfEvent> selfevent_pool_;
     TQueue<QTYPE>* tqe_;
+    /// events from other threads when nrn_interthread_mutex_ is set
     std::vector<InterThreadEvent> inter_thread_events_;
     OMP_Mutex mut;
+    /// lock-free events from other threads, one mailbox per sending thread
+    std::vector<std::unique_ptr<InterThreadMailbox>> inter_thread_mailboxes_;
 
     NetCvodeThreadData();
     virtual ~NetCvodeThreadData();
-    void interthread_send(double, DiscreteEvent*, NrnThread*);
+    /// one mailbox per thread that can send to this one
+    void init_mailboxes(int nthread);
+    /// called from the thread of the sender nt, which may be nullptr for thread 0
+    void interthread_send(double, DiscreteEvent*, NrnThread* nt);
     void enqueue(NetCvode*, NrnThread*);
+    /// number of events sent by other threads and not yet enqueued
+    std::size_t n_inter_thread_events() const;
+    void clear_inter_thread_events();
 };
 
 class NetCvode {
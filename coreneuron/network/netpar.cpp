@@ -6,6 +6,7 @@
 # =============================================================================.
 */
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <map>
@@ -19,9 +20,12 @@
 
 #include "coreneuron/network/netcon.hpp"
 #include "coreneuron/network/netcvode.hpp"
+#include "coreneuron/network/netpar.hpp"
 #include "coreneuron/nrniv/nrniv_decl.h"
 #include "coreneuron/utils/ivocvect.hpp"
 #include "coreneuron/network/multisend.hpp"
+#include "coreneuron/network/sparse_exchange.hpp"
+#include "coreneuron/network/spikebuf_tuner.hpp"
 #include "coreneuron/utils/nrn_assert.h"
 #include "coreneuron/utils/nrnoc_aux.hpp"
 #include "coreneuron/utils/profile/profiler_interface.h"
@@ -65,7 +69,8 @@ void nrn2ncs_outputevent(int netcon_output_index, double firetime);
 // for compressed gid info during spike exchange
 bool nrn_use_localgid_;
 void nrn_outputevent(unsigned char localgid, double firetime);
-std::vector<std::map<int, InputPreSyn*>> localmaps;
+/// localmaps[rank][localgid] is the InputPreSyn (or nullptr) for a compressed gid
+std::vector<std::vector<InputPreSyn*>> localmaps;
 
 static int ocapacity_;  // for spikeout
 // require it to be smaller than  min_interprocessor_delay.
@@ -76,6 +81,26 @@ static int spfixout_capacity_;
 static int idxout_;
 static void nrn_spike_exchange_compressed(NrnThread*);
 
+// overlapped allgather, see --overlap-exchange
+static bool use_overlap_;
+static bool exchange_posted_;
+static NRNMPI_Spike* spikeout_posted_;  // spikeout of the exchange in flight
+static int ocapacity_posted_;
+static void nrn_spike_exchange_overlap(NrnThread*);
+static void nrn_spike_exchange_sparse(NrnThread*);
+
+// allgather with a run time sized inline buffer, see --adaptive-spikebuf
+static bool use_adaptive_spikebuf_;
+static SpikebufTuner spikebuf_tuner_;
+static std::vector<NRNMPI_Spike> spikebuf_out_;  // count, then capacity spikes
+static std::vector<NRNMPI_Spike> spikebuf_in_;   // the spikebuf_out_ of all the ranks
+static void nrn_spike_exchange_adaptive(NrnThread*);
+
+// totals reported by nrn_spike_exchange_stats
+static long nexchange_;
+static long bytes_received_;
+static double exchange_time_;
+
 #endif  // NRNMPI
 
 static bool active_ = false;
@@ -99,6 +124,8 @@ static void alloc_mpi_space() {
         icapacity = 100;
         spikein = (NRNMPI_Spike*) malloc(icapacity * sizeof(NRNMPI_Spike));
         nrnmpi_nin_ = (int*) emalloc(nrnmpi_numprocs * sizeof(int));
+        ocapacity_posted_ = 100;
+        spikeout_posted_ = (NRNMPI_Spike*) emalloc(ocapacity_posted_ * sizeof(NRNMPI_Spike));
 #if nrn_spikebuf_size > 0
         spbufout = (NRNMPI_Spikebuf*) emalloc(sizeof(NRNMPI_Spikebuf));
         spbufin = (NRNMPI_Spikebuf*) emalloc(nrnmpi_numprocs * sizeof(NRNMPI_Spikebuf));
@@ -244,6 +271,37 @@ void nrn_spike_exchange_init() {
     if (use_multisend_ && n_multisend_interval == 2) {
         usable_mindelay_ *= 0.5;
     }
+#endif
+#if NRNMPI
+    // an exchange left in flight by a previous run is of no use anymore
+    if (exchange_posted_) {
+        nrnmpi_spike_exchange_wait(&spikein, icapacity);
+        exchange_posted_ = false;
+    }
+    // The spikes of an interval are received at the end of the next one, so
+    // the interval is half the min delay as for two multisend subintervals.
+    use_overlap_ = corenrn_param.mpi_enable && corenrn_param.overlap_exchange && !use_compress_ &&
+                   !use_sparse_exchange_ && nrn_spikebuf_size == 0;
+#if NRN_MULTISEND
+    use_overlap_ = use_overlap_ && !use_multisend_;
+#endif
+    if (use_overlap_) {
+        usable_mindelay_ *= 0.5;
+    }
+    use_adaptive_spikebuf_ = corenrn_param.mpi_enable && corenrn_param.adaptive_spikebuf &&
+                             !use_compress_ && !use_sparse_exchange_ && !use_overlap_ &&
+                             nrn_spikebuf_size == 0;
+#if NRN_MULTISEND
+    use_adaptive_spikebuf_ = use_adaptive_spikebuf_ && !use_multisend_;
+#endif
+    if (use_adaptive_spikebuf_) {
+        spikebuf_tuner_ = SpikebufTuner();
+        spikebuf_out_.resize(spikebuf_tuner_.capacity() + 1);
+        spikebuf_in_.resize(nrnmpi_numprocs * (spikebuf_tuner_.capacity() + 1));
+    }
+    nexchange_ = 0;
+    bytes_received_ = 0;
+    exchange_time_ = 0.;
 #endif
     if (nrn_nthread > 1) {
         usable_mindelay_ -= dt;
@@ -301,6 +359,16 @@ void nrn_spike_exchange_init() {
 }
 
 #if NRNMPI
+/// Send the first n received spikes of spikein to their InputPreSyn
+static void deliver_spikein(int n, NrnThread* nt) {
+    for (int i = 0; i < n; ++i) {
+        InputPreSyn* ps = gid2in_table.find(spikein[i].gid);
+        if (ps) {
+            ps->send(spikein[i].spiketime, net_cvode_instance, nt);
+        }
+    }
+}
+
 void nrn_spike_exchange(NrnThread* nt) {
     Instrumentor::phase p_spike_exchange("spike-exchange");
     if (!active_) {
@@ -316,6 +384,18 @@ void nrn_spike_exchange(NrnThread* nt) {
         nrn_spike_exchange_compressed(nt);
         return;
     }
+    if (use_sparse_exchange_) {
+        nrn_spike_exchange_sparse(nt);
+        return;
+    }
+    if (use_overlap_) {
+        nrn_spike_exchange_overlap(nt);
+        return;
+    }
+    if (use_adaptive_spikebuf_) {
+        nrn_spike_exchange_adaptive(nt);
+        return;
+    }
 #if TBUFSIZE
     nrnmpi_barrier();
 #endif
@@ -329,6 +409,13 @@ void nrn_spike_exchange(NrnThread* nt) {
         nrnmpi_nin_, spikeout, icapacity, &spikein, ovfl, nout, spbufout, spbufin);
 
     wt_ = nrn_wtime() - wt;
+    ++nexchange_;
+    exchange_time_ += wt_;
+#if nrn_spikebuf_size > 0
+    bytes_received_ += nrnmpi_numprocs * sizeof(NRNMPI_Spikebuf) + ovfl * sizeof(NRNMPI_Spike);
+#else
+    bytes_received_ += nrnmpi_numprocs * sizeof(int) + n * sizeof(NRNMPI_Spike);
+#endif
     wt = nrn_wtime();
 #if TBUFSIZE
     tbuf_[itbuf_++] = (unsigned long) nout;
@@ -350,23 +437,118 @@ void nrn_spike_exchange(NrnThread* nt) {
             nn = nrn_spikebuf_size;
         }
         for (int j = 0; j < nn; ++j) {
-            auto gid2in_it = gid2in.find(spbufin[i].gid[j]);
-            if (gid2in_it != gid2in.end()) {
-                InputPreSyn* ps = gid2in_it->second;
+            InputPreSyn* ps = gid2in_table.find(spbufin[i].gid[j]);
+            if (ps) {
                 ps->send(spbufin[i].spiketime[j], net_cvode_instance, nt);
             }
         }
     }
     n = ovfl;
 #endif  // nrn_spikebuf_size > 0
-    for (int i = 0; i < n; ++i) {
-        auto gid2in_it = gid2in.find(spikein[i].gid);
-        if (gid2in_it != gid2in.end()) {
-            InputPreSyn* ps = gid2in_it->second;
-            ps->send(spikein[i].spiketime, net_cvode_instance, nt);
+    deliver_spikein(n, nt);
+    wt1_ = nrn_wtime() - wt;
+}
+
+/// Receive and deliver the spikes of the previous interval, post the spikes of
+/// this one and return without waiting for them. Spikes of the previous
+/// interval are not due before the end of this one as usable_mindelay_ is half
+/// the min delay.
+static void nrn_spike_exchange_overlap(NrnThread* nt) {
+    double wt = nrn_wtime();
+    int n = 0;
+    if (exchange_posted_) {
+        n = nrnmpi_spike_exchange_wait(&spikein, icapacity);
+        ++nexchange_;
+        bytes_received_ += nrnmpi_numprocs * sizeof(int) + n * sizeof(NRNMPI_Spike);
+    }
+    wt_ = nrn_wtime() - wt;
+    exchange_time_ += wt_;
+
+    // the send buffer of the completed exchange takes the new spikes
+    std::swap(spikeout, spikeout_posted_);
+    std::swap(ocapacity_, ocapacity_posted_);
+    nrnmpi_spike_exchange_post(nrnmpi_nin_, spikeout_posted_, nout);
+    exchange_posted_ = true;
+    nout = 0;
+
+    wt = nrn_wtime();
+    deliver_spikein(n, nt);
+    wt1_ = nrn_wtime() - wt;
+}
+
+/// Send the spikes to the ranks that want them only, see sparse_exchange.cpp
+static void nrn_spike_exchange_sparse(NrnThread* nt) {
+    double wt = nrn_wtime();
+    int n = nrn_sparse_exchange(spikeout, nout, &spikein, icapacity, bytes_received_);
+    wt_ = nrn_wtime() - wt;
+    ++nexchange_;
+    exchange_time_ += wt_;
+    nout = 0;
+
+    wt = nrn_wtime();
+    deliver_spikein(n, nt);
+    wt1_ = nrn_wtime() - wt;
+}
+
+/// Allgather of the first spikes of each rank in an inline buffer whose
+/// capacity follows the spike counts, the others go in a second collective.
+/// Every rank takes the same resize decision from the same counts after the
+/// exchange, the new capacity is used from the next one.
+static void nrn_spike_exchange_adaptive(NrnThread* nt) {
+    int capacity = spikebuf_tuner_.capacity();
+    spikebuf_out_[0].gid = nout;
+    std::copy(spikeout, spikeout + std::min(nout, capacity), spikebuf_out_.begin() + 1);
+
+    double wt = nrn_wtime();
+    nrnmpi_spike_exchange_inline(capacity,
+                                 spikebuf_out_.data(),
+                                 spikebuf_in_.data(),
+                                 nrnmpi_nin_,
+                                 spikeout,
+                                 nout,
+                                 &spikein,
+                                 icapacity,
+                                 ovfl);
+    wt_ = nrn_wtime() - wt;
+    ++nexchange_;
+    exchange_time_ += wt_;
+    bytes_received_ += (nrnmpi_numprocs * (capacity + 1) + ovfl) * sizeof(NRNMPI_Spike);
+    nout = 0;
+
+    wt = nrn_wtime();
+    for (int i = 0; i < nrnmpi_numprocs; ++i) {
+        const NRNMPI_Spike* spbuf = spikebuf_in_.data() + i * (capacity + 1) + 1;
+        int nn = std::min(nrnmpi_nin_[i], capacity);
+        for (int j = 0; j < nn; ++j) {
+            InputPreSyn* ps = gid2in_table.find(spbuf[j].gid);
+            if (ps) {
+                ps->send(spbuf[j].spiketime, net_cvode_instance, nt);
+            }
         }
     }
+    deliver_spikein(ovfl, nt);
     wt1_ = nrn_wtime() - wt;
+
+    if (spikebuf_tuner_.update(nrnmpi_nin_, nrnmpi_numprocs, sizeof(NRNMPI_Spike))) {
+        capacity = spikebuf_tuner_.capacity();
+        spikebuf_out_.resize(capacity + 1);
+        spikebuf_in_.resize(nrnmpi_numprocs * (capacity + 1));
+    }
+}
+
+void nrn_spike_exchange_progress() {
+    if (exchange_posted_) {
+        nrnmpi_spike_exchange_test(&spikein, icapacity);
+    }
+}
+
+void nrn_spike_exchange_complete(NrnThread* nt) {
+    if (!exchange_posted_) {
+        return;
+    }
+    int n = nrnmpi_spike_exchange_wait(&spikein, icapacity);
+    exchange_posted_ = false;
+    deliver_spikein(n, nt);
 }
 
 void nrn_spike_exchange_compressed(NrnThread* nt) {
@@ -393,6 +575,9 @@ void nrn_spike_exchange_compressed(NrnThread* nt) {
                                              spikein_fixed,
                                              ovfl);
     wt_ = nrn_wtime() - wt;
+    ++nexchange_;
+    exchange_time_ += wt_;
+    bytes_received_ += nrnmpi_numprocs * ag_send_size + ovfl * (1 + localgid_size_);
     wt = nrn_wtime();
 #if TBUFSIZE
     tbuf_[itbuf_++] = (unsigned long) nout;
@@ -420,7 +605,7 @@ void nrn_spike_exchange_compressed(NrnThread* nt) {
                     }
                     continue;
                 }
-                std::map<int, InputPreSyn*> gps = localmaps[i];
+                const std::vector<InputPreSyn*>& gps = localmaps[i];
                 if (nn > ag_send_nspike) {
                     nnn = ag_send_nspike;
                 } else {
@@ -432,9 +617,8 @@ void nrn_spike_exchange_compressed(NrnThread* nt) {
                     double firetime = spikein_fixed[idx++] * dt + t_exchange_;
                     int lgid = (int) spikein_fixed[idx];
                     idx += localgid_size_;
-                    auto gid2in_it = gps.find(lgid);
-                    if (gid2in_it != gps.end()) {
-                        InputPreSyn* ps = gid2in_it->second;
+                    InputPreSyn* ps = gps[lgid];
+                    if (ps) {
                         ps->send(firetime + 1e-10, net_cvode_instance, nt);
                     }
                 }
@@ -442,9 +626,8 @@ void nrn_spike_exchange_compressed(NrnThread* nt) {
                     double firetime = spfixin_ovfl_[idxov++] * dt + t_exchange_;
                     int lgid = (int) spfixin_ovfl_[idxov];
                     idxov += localgid_size_;
-                    auto gid2in_it = gps.find(lgid);
-                    if (gid2in_it != gps.end()) {
-                        InputPreSyn* ps = gid2in_it->second;
+                    InputPreSyn* ps = gps[lgid];
+                    if (ps) {
                         ps->send(firetime + 1e-10, net_cvode_instance, nt);
                     }
                 }
@@ -462,9 +645,8 @@ void nrn_spike_exchange_compressed(NrnThread* nt) {
                 double firetime = spikein_fixed[idx++] * dt + t_exchange_;
                 int gid = spupk(spikein_fixed + idx);
                 idx += localgid_size_;
-                auto gid2in_it = gid2in.find(gid);
-                if (gid2in_it != gid2in.end()) {
-                    InputPreSyn* ps = gid2in_it->second;
+                InputPreSyn* ps = gid2in_table.find(gid);
+                if (ps) {
                     ps->send(firetime + 1e-10, net_cvode_instance, nt);
                 }
             }
@@ -475,9 +657,8 @@ void nrn_spike_exchange_compressed(NrnThread* nt) {
             double firetime = spfixin_ovfl_[idx++] * dt + t_exchange_;
             int gid = spupk(spfixin_ovfl_ + idx);
             idx += localgid_size_;
-            auto gid2in_it = gid2in.find(gid);
-            if (gid2in_it != gid2in.end()) {
-                InputPreSyn* ps = gid2in_it->second;
+            InputPreSyn* ps = gid2in_table.find(gid);
+            if (ps) {
                 ps->send(firetime + 1e-10, net_cvode_instance, nt);
             }
         }
@@ -526,9 +707,8 @@ static void mk_localgid_rep() {
     delete[] sbuf;
     errno = 0;
 
-    // create the maps
-    // there is a lot of potential for efficiency here. i.e. use of
-    // perfect hash functions, or even simple Vectors.
+    // create the maps. The local gid is an index < 256 so a dense
+    // vector per rank is the perfect hash.
     localmaps.clear();
     localmaps.resize(nrnmpi_numprocs);
 
@@ -537,11 +717,9 @@ static void mk_localgid_rep() {
         if (i != nrnmpi_myid) {
             sbuf = rbuf + i * (ngidmax + 1);
             ngid = *(sbuf++);
+            localmaps[i].assign(ngid, nullptr);
             for (int k = 0; k < ngid; ++k) {
-                auto gid2in_it = gid2in.find(int(sbuf[k]));
-                if (gid2in_it != gid2in.end()) {
-                    localmaps[i][k] = gid2in_it->second;
-                }
+                localmaps[i][k] = gid2in_table.find(int(sbuf[k]));
             }
         }
 
@@ -564,10 +742,8 @@ static void mk_localgid_rep() {
 // high so that they do not themselves generate spikes.
 // Can only be called by thread 0 because of the ps->send.
 void nrn_fake_fire(int gid, double spiketime, int fake_out) {
-    auto gid2in_it = gid2in.find(gid);
-    if (gid2in_it != gid2in.end()) {
-        InputPreSyn* psi = gid2in_it->second;
-        assert(psi);
+    InputPreSyn* psi = gid2in_table.find(gid);
+    if (psi) {
         // printf("nrn_fake_fire %d %g\n", gid, spiketime);
         psi->send(spiketime, net_cvode_instance, nrn_threads);
     } else if (fake_out) {
@@ -608,6 +784,7 @@ void BBS_netpar_solve(double tstop) {
         nrn_timeout(timeout_);
         ncs2nrn_integrate(tstop * (1. + 1e-11));
         nrn_spike_exchange(nrn_threads);
+        nrn_spike_exchange_complete(nrn_threads);
         nrn_timeout(0);
         if (!npe_.empty()) {
             npe_[0].wx_ = npe_[0].ws_ = 0.;
@@ -627,6 +804,32 @@ void BBS_netpar_solve(double tstop) {
     }
 }
 
+SpikeExchangeStats nrn_spike_exchange_stats() {
+    SpikeExchangeStats stats;
+#if NRNMPI
+    if (use_multisend_) {
+        stats.method = "multisend";
+    } else if (use_compress_) {
+        stats.method = "compressed allgather";
+    } else if (use_sparse_exchange_) {
+        stats.method = "sparse";
+    } else if (use_overlap_) {
+        stats.method = "overlapped allgather";
+    } else if (use_adaptive_spikebuf_) {
+        stats.method = "adaptive allgather";
+        stats.spikebuf_capacity = spikebuf_tuner_.capacity();
+        stats.spikebuf_resizes = spikebuf_tuner_.nresize();
+        stats.spikebuf_overflows = spikebuf_tuner_.noverflow();
+    } else {
+        stats.method = "allgather";
+    }
+    stats.nexchange = nexchange_;
+    stats.bytes_received = bytes_received_;
+    stats.time = exchange_time_;
+#endif
+    return stats;
+}
+
 double set_mindelay(double maxdelay) {
     double mindelay = maxdelay;
     last_maxstep_arg_ = maxdelay;
@@ -15,4 +15,20 @@ namespace coreneuron {
 
 extern void nrn_spike_exchange_init(void);
 extern void nrn_spike_exchange(NrnThread* nt);
+/// Advance an overlapped spike exchange in flight, see --overlap-exchange
+extern void nrn_spike_exchange_progress();
+/// Receive and deliver the spikes of an overlapped exchange still in flight
+extern void nrn_spike_exchange_complete(NrnThread* nt);
+
+/// Totals of the spike exchanges of this rank since nrn_spike_exchange_init
+struct SpikeExchangeStats {
+    const char* method = "none";
+    long nexchange = 0;       ///< number of exchanges
+    long bytes_received = 0;  ///< spikes and counts received, not counted for multisend
+    double time = 0.;         ///< seconds spent in the exchanges, waiting included
+    int spikebuf_capacity = -1;   ///< inline buffer capacity, -1 without --adaptive-spikebuf
+    long spikebuf_resizes = 0;    ///< number of capacity changes
+    long spikebuf_overflows = 0;  ///< exchanges that needed the second collective
+};
+extern SpikeExchangeStats nrn_spike_exchange_stats();
 }  // namespace coreneuron
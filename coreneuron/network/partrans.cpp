@@ -6,12 +6,15 @@
 # =============================================================================
 */
 
+#include <algorithm>
+
 #include "coreneuron/nrnconf.h"
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/mpi/nrnmpi.h"
 #include "coreneuron/mpi/core/nrnmpi.hpp"
 #include "coreneuron/network/partrans.hpp"
 #include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/utils/nrn_assert.h"
 
 // This is the computational code for src->target transfer (e.g. gap junction)
 // simulation.
@@ -31,6 +34,12 @@ int* nrn_partrans::insrccnt_;
 int* nrn_partrans::insrcdspl_;
 int* nrn_partrans::outsrccnt_;
 int* nrn_partrans::outsrcdspl_;
+std::vector<int> nrn_partrans::insrc_ranks_;
+std::vector<int> nrn_partrans::outsrc_ranks_;
+bool nrn_partrans::targets_current_only_;
+
+bool nrn_gap_overlap;
+static bool transfer_pending_;
 
 void nrnmpi_v_transfer() {
     // copy source values to outsrc_buf_ and mpi transfer to insrc_buf
@@ -136,6 +145,71 @@ void nrnthread_v_transfer(NrnThread* _nt) {
     }
 }
 
+void nrnthread_v_transfer_pack(NrnThread* nt) {
+    // threads write disjoint elements of outsrc_buf_
+    TransferThreadData& ttd = transfer_thread_data_[nt->id];
+    size_t n_outsrc_indices = ttd.outsrc_indices.size();
+    const int* outsrc_indices = ttd.outsrc_indices.data();
+    const int* src_indices = ttd.src_indices.data();
+    const int* src_gather_indices = ttd.gather2outsrc_indices.data();
+    const double* src_data = nt->_data;
+    for (size_t i = 0; i < n_outsrc_indices; ++i) {
+        outsrc_buf_[outsrc_indices[i]] = src_data[src_indices[src_gather_indices[i]]];
+    }
+}
+
+void nrnmpi_v_transfer_post() {
+    // outsrc_buf_ is filled by nrnthread_v_transfer_pack of every thread
+    nrn_assert(!transfer_pending_);
+    int me = corenrn_param.mpi_enable ? nrnmpi_myid : 0;
+    std::copy(outsrc_buf_ + outsrcdspl_[me],
+              outsrc_buf_ + outsrcdspl_[me] + outsrccnt_[me],
+              insrc_buf_ + insrcdspl_[me]);
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        nrnmpi_dbl_neighbor_exchange_post(outsrc_buf_,
+                                          outsrccnt_,
+                                          outsrcdspl_,
+                                          int(outsrc_ranks_.size()),
+                                          outsrc_ranks_.data(),
+                                          insrc_buf_,
+                                          insrccnt_,
+                                          insrcdspl_,
+                                          int(insrc_ranks_.size()),
+                                          insrc_ranks_.data());
+        transfer_pending_ = true;
+    }
+#endif
+    if (!nrn_gap_transfer_deferred()) {
+        nrnmpi_v_transfer_wait();
+    }
+}
+
+void nrnmpi_v_transfer_wait() {
+#if NRNMPI
+    if (transfer_pending_) {
+        nrnmpi_dbl_neighbor_exchange_wait();
+        transfer_pending_ = false;
+    }
+#endif
+}
+
+bool nrn_gap_transfer_deferred() {
+    return nrn_gap_overlap && targets_current_only_;
+}
+
+void nrnmpi_v_transfer_complete() {
+    if (!nrn_have_gaps || !nrn_gap_overlap) {
+        return;
+    }
+    nrnmpi_v_transfer_wait();
+    if (nrn_gap_transfer_deferred()) {
+        for (int tid = 0; tid < nrn_nthread; ++tid) {
+            nrnthread_v_transfer(nrn_threads + tid);
+        }
+    }
+}
+
 void nrn_partrans::gap_update_indices() {
     // Ensure index vectors, src_gather, and insrc_buf_ are on the gpu.
     if (insrcdspl_) {
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "coreneuron/sim/multicore.hpp"
 
 #ifndef NRNLONGSGID
@@ -27,6 +29,29 @@ extern bool nrn_have_gaps;
 extern void nrnmpi_v_transfer();
 extern void nrnthread_v_transfer(NrnThread*);
 
+/**
+ * Overlapped transfer (--overlap-gap-transfer): no barrier and no collective.
+ *
+ * Each thread copies its own sources to outsrc_buf_ at the end of its step
+ * (nrnthread_v_transfer_pack), then the master thread sends them to the ranks
+ * that want them and receives from the ranks that have them only
+ * (nrnmpi_v_transfer_post). If the targets are only read by the currents of
+ * their mechanism (no state, NET_RECEIVE or BEFORE/AFTER block), the transfer
+ * is completed at the start of the next step: nrnmpi_v_transfer_wait before
+ * the threads start, and nrnthread_v_transfer by each thread before
+ * computing its currents. The exchange then overlaps with the states, the
+ * event delivery, the spike exchange and the reports of the step.
+ * Otherwise nrnmpi_v_transfer_post waits for the exchange itself.
+ */
+extern bool nrn_gap_overlap;
+extern void nrnthread_v_transfer_pack(NrnThread*);
+extern void nrnmpi_v_transfer_post();
+extern void nrnmpi_v_transfer_wait();
+/// The targets are copied at the start of the next step instead of in nonvint
+extern bool nrn_gap_transfer_deferred();
+/// Complete a deferred transfer, after the last step
+extern void nrnmpi_v_transfer_complete();
+
 namespace nrn_partrans {
 
 /** The basic problem is to copy sources to targets.
@@ -113,5 +138,9 @@ extern void gap_cleanup();
 extern double* insrc_buf_;   // Receive buffer for gap voltages
 extern double* outsrc_buf_;  // Send buffer for gap voltages
 extern int *insrccnt_, *insrcdspl_, *outsrccnt_, *outsrcdspl_;
+// other ranks with something to receive from / to send to, for the overlapped transfer
+extern std::vector<int> insrc_ranks_, outsrc_ranks_;
+// no target is read outside of the currents of its mechanism
+extern bool targets_current_only_;
 }  // namespace nrn_partrans
 }  // namespace coreneuron
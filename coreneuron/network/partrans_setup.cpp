@@ -136,6 +136,33 @@ void nrn_partrans::gap_mpi_setup(int ngroup) {
     }
 #endif
 
+    // neighbour ranks of the overlapped transfer, this rank copies its own values
+    insrc_ranks_.clear();
+    outsrc_ranks_.clear();
+    for (int i = 0; i < nhost; ++i) {
+        if (i != nrnmpi_myid && insrccnt_[i]) {
+            insrc_ranks_.push_back(i);
+        }
+        if (i != nrnmpi_myid && outsrccnt_[i]) {
+            outsrc_ranks_.push_back(i);
+        }
+    }
+
+    // can the copy to the targets wait until their mechanism computes its current
+    targets_current_only_ = true;
+    for (int tid = 0; tid < ngroup; ++tid) {
+        for (int type: setup_info_[tid].tar_type) {
+            bool current_only = type > 0 && !corenrn.get_memb_func(type).state &&
+                                !corenrn.get_pnt_receive()[type];
+            for (auto bam: corenrn.get_bamech()) {
+                for (; bam; bam = bam->next) {
+                    current_only = current_only && bam->type != type;
+                }
+            }
+            targets_current_only_ = targets_current_only_ && current_only;
+        }
+    }
+
     // clean up a little
     delete[] have;
     delete[] want;
@@ -287,6 +314,8 @@ void nrn_partrans::gap_cleanup() {
         delete[] outsrcdspl_;
         outsrcdspl_ = nullptr;
     }
+    insrc_ranks_.clear();
+    outsrc_ranks_.clear();
 }
 
 }  // namespace coreneuron
@@ -0,0 +1,160 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <unordered_map>
+#include <vector>
+
+#include "coreneuron/nrnconf.h"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/mpi/nrnmpidec.h"
+#include "coreneuron/network/sparse_exchange.hpp"
+#include "coreneuron/nrniv/nrniv_decl.h"
+
+#if NRNMPI
+#define HAVEWANT_t         int
+#define HAVEWANT_alltoallv nrnmpi_int_alltoallv
+#define HAVEWANT2Int       std::unordered_map<int, int>
+#include "coreneuron/network/have2want.h"
+#endif
+
+namespace coreneuron {
+bool use_sparse_exchange_;
+
+#if NRNMPI
+/// for an output gid, the first and one past the last entry in dest_index_
+static std::unordered_map<int, std::pair<int, int>> gid2dest_;
+/// indices in dest_ranks_ of the ranks that want each output gid
+static std::vector<int> dest_index_;
+static std::vector<int> dest_ranks_;
+static std::vector<int> src_ranks_;
+/// spikes sorted by destination and their counts and displacements
+static std::vector<NRNMPI_Spike> sbuf_;
+static std::vector<int> scnt_;
+static std::vector<int> sdispl_;
+static std::vector<int> rcnt_;
+static std::vector<int> rdispl_;
+
+void nrn_sparse_exchange_cleanup() {
+    gid2dest_.clear();
+    dest_index_.clear();
+    dest_ranks_.clear();
+    src_ranks_.clear();
+    sbuf_.clear();
+}
+
+void nrn_sparse_exchange_setup() {
+    nrn_sparse_exchange_cleanup();
+
+    // have: the output gids of this rank, want: the gids of its InputPreSyn
+    std::vector<int> have;
+    have.reserve(gid2out.size());
+    for (const auto& g: gid2out) {
+        have.push_back(g.first);
+    }
+    std::vector<int> want;
+    want.reserve(gid2in.size());
+    for (const auto& g: gid2in) {
+        want.push_back(g.first);
+    }
+    int *send_to_want, *send_to_want_cnt, *send_to_want_displ;
+    int *recv_from_have, *recv_from_have_cnt, *recv_from_have_displ;
+    have_to_want(have.data(),
+                 have.size(),
+                 want.data(),
+                 want.size(),
+                 send_to_want,
+                 send_to_want_cnt,
+                 send_to_want_displ,
+                 recv_from_have,
+                 recv_from_have_cnt,
+                 recv_from_have_displ,
+                 default_rendezvous);
+
+    // the ranks that want something from us, and for each of our gids the
+    // ranks that want it
+    std::unordered_map<int, std::vector<int>> gid2ranks;
+    for (int r = 0; r < nrnmpi_numprocs; ++r) {
+        if (send_to_want_cnt[r] == 0) {
+            continue;
+        }
+        int idest = dest_ranks_.size();
+        dest_ranks_.push_back(r);
+        for (int i = send_to_want_displ[r]; i < send_to_want_displ[r + 1]; ++i) {
+            gid2ranks[send_to_want[i]].push_back(idest);
+        }
+    }
+    for (const auto& g: gid2ranks) {
+        int begin = dest_index_.size();
+        dest_index_.insert(dest_index_.end(), g.second.begin(), g.second.end());
+        gid2dest_[g.first] = {begin, int(dest_index_.size())};
+    }
+    for (int r = 0; r < nrnmpi_numprocs; ++r) {
+        if (recv_from_have_cnt[r] > 0) {
+            src_ranks_.push_back(r);
+        }
+    }
+
+    delete[] send_to_want;
+    delete[] send_to_want_cnt;
+    delete[] send_to_want_displ;
+    delete[] recv_from_have;
+    delete[] recv_from_have_cnt;
+    delete[] recv_from_have_displ;
+
+    scnt_.assign(dest_ranks_.size() + 1, 0);
+    sdispl_.assign(dest_ranks_.size() + 1, 0);
+    rcnt_.assign(src_ranks_.size() + 1, 0);
+    rdispl_.assign(src_ranks_.size() + 1, 0);
+    nrnmpi_sparse_exchange_setup(src_ranks_.size(),
+                                 src_ranks_.data(),
+                                 dest_ranks_.size(),
+                                 dest_ranks_.data());
+}
+
+int nrn_sparse_exchange(NRNMPI_Spike* spikeout,
+                        int nout,
+                        NRNMPI_Spike** spikein,
+                        int& icapacity,
+                        long& bytes_received) {
+    int ndest = dest_ranks_.size();
+    std::fill(scnt_.begin(), scnt_.end(), 0);
+    for (int i = 0; i < nout; ++i) {
+        auto it = gid2dest_.find(spikeout[i].gid);
+        if (it != gid2dest_.end()) {
+            for (int j = it->second.first; j < it->second.second; ++j) {
+                ++scnt_[dest_index_[j]];
+            }
+        }
+    }
+    int n = 0;
+    for (int i = 0; i < ndest; ++i) {
+        sdispl_[i] = n;
+        n += scnt_[i];
+        scnt_[i] = 0;  // recount while filling
+    }
+    sbuf_.resize(n + 1);
+    for (int i = 0; i < nout; ++i) {
+        auto it = gid2dest_.find(spikeout[i].gid);
+        if (it != gid2dest_.end()) {
+            for (int j = it->second.first; j < it->second.second; ++j) {
+                int d = dest_index_[j];
+                sbuf_[sdispl_[d] + scnt_[d]++] = spikeout[i];
+            }
+        }
+    }
+
+    n = nrnmpi_sparse_exchange(
+        sbuf_.data(), scnt_.data(), sdispl_.data(), spikein, icapacity, rcnt_.data(), rdispl_.data());
+    bytes_received += n * sizeof(NRNMPI_Spike) + src_ranks_.size() * sizeof(int);
+    return n;
+}
+#else
+void nrn_sparse_exchange_setup() {}
+void nrn_sparse_exchange_cleanup() {}
+#endif  // NRNMPI
+}  // namespace coreneuron
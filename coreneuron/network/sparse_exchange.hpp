@@ -0,0 +1,30 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include "coreneuron/mpi/nrnmpi.h"
+
+namespace coreneuron {
+/// Send spikes only to the ranks that want them, see --sparse-exchange
+extern bool use_sparse_exchange_;
+
+/// Build the per destination send lists from gid2out and gid2in with
+/// have_to_want and the neighbourhood communicator. Collective.
+void nrn_sparse_exchange_setup();
+void nrn_sparse_exchange_cleanup();
+
+/// Send the nout spikes of spikeout to the ranks that want them. The received
+/// spikes are returned in spikein (grown as needed) and their number returned.
+/// bytes_received is incremented by the received spikes and counts.
+int nrn_sparse_exchange(NRNMPI_Spike* spikeout,
+                        int nout,
+                        NRNMPI_Spike** spikein,
+                        int& icapacity,
+                        long& bytes_received);
+}  // namespace coreneuron
@@ -0,0 +1,124 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+namespace coreneuron {
+
+/**
+ * \class SpikebufTuner
+ * \brief Chooses the inline buffer size of the Allgather spike exchange
+ *
+ * With --adaptive-spikebuf every rank sends 1 + capacity spikes in the
+ * Allgather and the spikes beyond capacity go through a second Allgatherv.
+ * Too small a capacity pays for the second collective on most intervals, too
+ * large a capacity sends mostly empty buffers.
+ *
+ * After an exchange every rank knows the spike count of every rank, so all the
+ * ranks feed the same counts to update() and take the same decision. The
+ * resize is collective without any extra communication and is applied at the
+ * next exchange.
+ *
+ * For each candidate capacity (0 and the powers of two) the tuner accumulates
+ * what the exchanges of the current window would have cost with it, in bytes:
+ * the inline buffers of all the ranks and, when a rank overflows, its overflow
+ * plus a fixed cost for the second collective. At the end of each window the
+ * cheapest candidate becomes the capacity.
+ */
+class SpikebufTuner {
+  public:
+    /// 0, 1, 2, 4, ..., 65536
+    static constexpr int ncandidate = 18;
+    /// number of exchanges between two decisions
+    static constexpr int window = 32;
+    /// a second collective costs about as much as sending this many bytes
+    static constexpr long collective_cost = 8192;
+
+    explicit SpikebufTuner(int capacity = 8)
+        : capacity_(capacity) {}
+
+    static int candidate(int i) {
+        return i == 0 ? 0 : 1 << (i - 1);
+    }
+
+    /// Account for one exchange given the spike count of each of the nrank
+    /// ranks. Returns true when the capacity changed.
+    bool update(const int* nin, int nrank, std::size_t spike_size) {
+        ++nexchange_;
+        int maxcnt = 0;
+        for (int i = 0; i < nrank; ++i) {
+            maxcnt = std::max(maxcnt, nin[i]);
+        }
+        if (maxcnt > capacity_) {
+            ++noverflow_;
+        }
+        for (int c = 0; c < ncandidate; ++c) {
+            long cap = candidate(c);
+            long over = 0;
+            if (maxcnt > cap) {
+                for (int i = 0; i < nrank; ++i) {
+                    over += std::max(nin[i] - cap, 0L);
+                }
+            }
+            cost_[c] += nrank * (cap + 1) * static_cast<long>(spike_size);
+            if (over) {
+                cost_[c] += collective_cost + over * static_cast<long>(spike_size);
+            }
+        }
+        if (++nwindow_ < window) {
+            return false;
+        }
+
+        int best = 0;
+        for (int c = 1; c < ncandidate; ++c) {
+            if (cost_[c] < cost_[best]) {
+                best = c;
+            }
+        }
+        std::fill(cost_, cost_ + ncandidate, 0L);
+        nwindow_ = 0;
+        if (candidate(best) == capacity_) {
+            return false;
+        }
+        capacity_ = candidate(best);
+        ++nresize_;
+        return true;
+    }
+
+    int capacity() const {
+        return capacity_;
+    }
+
+    /// number of exchanges accounted for
+    long nexchange() const {
+        return nexchange_;
+    }
+
+    /// number of exchanges that needed the second collective
+    long noverflow() const {
+        return noverflow_;
+    }
+
+    /// number of capacity changes
+    long nresize() const {
+        return nresize_;
+    }
+
+  private:
+    int capacity_;
+    int nwindow_ = 0;
+    long nexchange_ = 0;
+    long noverflow_ = 0;
+    long nresize_ = 0;
+    long cost_[ncandidate] = {};
+};
+
+}  // namespace coreneuron
@@ -10,6 +10,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cstdarg>
+#include <algorithm>
 
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/network/tqueue.hpp"
@@ -124,6 +125,141 @@ void BinQ::remove(TQItem* q) {
     }
 }
 
+CalQ::CalQ(double width)
+    : width_(width)
+    , min_width_(1.e-3 * width)
+    , rev_width_(1. / width)
+    , heads_(min_nbucket_, nullptr)
+    , tails_(min_nbucket_, nullptr)
+    , mask_(min_nbucket_ - 1) {
+    assert(width > 0.);
+}
+
+CalQ::~CalQ() {
+    assert(size_ == 0);
+}
+
+// put q in its bucket after all items with the same time
+void CalQ::link(TQItem* q) {
+    std::size_t i = index_of(bucket_of(q->t_));
+    q->cnt_ = static_cast<int>(i);
+    TQItem* p = tails_[i];
+    // most events are later than the ones already in the bucket
+    while (p && p->t_ > q->t_) {
+        p = p->left_;
+    }
+    q->left_ = p;
+    if (p) {
+        q->right_ = p->right_;
+        p->right_ = q;
+    } else {
+        q->right_ = heads_[i];
+        heads_[i] = q;
+    }
+    if (q->right_) {
+        q->right_->left_ = q;
+    } else {
+        tails_[i] = q;
+    }
+}
+
+void CalQ::unlink(TQItem* q) {
+    std::size_t i = static_cast<std::size_t>(q->cnt_);
+    if (q->left_) {
+        q->left_->right_ = q->right_;
+    } else {
+        heads_[i] = q->right_;
+    }
+    if (q->right_) {
+        q->right_->left_ = q->left_;
+    } else {
+        tails_[i] = q->left_;
+    }
+    q->left_ = q->right_ = nullptr;
+}
+
+void CalQ::enqueue(TQItem* q) {
+    std::int64_t b = bucket_of(q->t_);
+    if (size_ == 0 || b < cur_) {
+        cur_ = b;
+    }
+    link(q);
+    if (++size_ > 2 * heads_.size()) {
+        resize(2 * heads_.size());
+    }
+}
+
+TQItem* CalQ::first() {
+    if (size_ == 0) {
+        return nullptr;
+    }
+    // scan at most one year (a turn of the ring) from the current bucket
+    for (std::size_t n = 0; n < heads_.size(); ++n, ++cur_) {
+        TQItem* q = heads_[index_of(cur_)];
+        if (q && bucket_of(q->t_) <= cur_) {
+            return q;
+        }
+    }
+    // all the items are more than a year ahead, direct search
+    TQItem* least = nullptr;
+    for (TQItem* q: heads_) {
+        if (q && (!least || q->t_ < least->t_)) {
+            least = q;
+        }
+    }
+    cur_ = bucket_of(least->t_);
+    return least;
+}
+
+TQItem* CalQ::dequeue() {
+    TQItem* q = first();
+    if (q) {
+        remove(q);
+    }
+    return q;
+}
+
+void CalQ::remove(TQItem* q) {
+    unlink(q);
+    --size_;
+    if (heads_.size() > min_nbucket_ && size_ < heads_.size() / 4) {
+        resize(heads_.size() / 2);
+    }
+}
+
+void CalQ::resize(std::size_t nbucket) {
+    std::vector<TQItem*> items;
+    items.reserve(size_);
+    for (TQItem* h: heads_) {
+        for (TQItem* q = h; q; q = q->right_) {
+            items.push_back(q);
+        }
+    }
+    // new width from the average separation of the next events
+    const std::size_t nsample = std::min<std::size_t>(items.size(), 25);
+    std::vector<double> times(items.size());
+    std::transform(items.begin(), items.end(), times.begin(), [](const TQItem* q) {
+        return q->t_;
+    });
+    std::partial_sort(times.begin(), times.begin() + nsample, times.end());
+    if (nsample > 1) {
+        double sep = (times[nsample - 1] - times[0]) / (nsample - 1);
+        if (sep > 0.) {
+            width_ = std::max(3. * sep, min_width_);
+            rev_width_ = 1. / width_;
+        }
+    }
+    heads_.assign(nbucket, nullptr);
+    tails_.assign(nbucket, nullptr);
+    mask_ = nbucket - 1;
+    for (TQItem* q: items) {
+        link(q);
+    }
+    if (!items.empty()) {
+        cur_ = bucket_of(times.front());
+    }
+}
+
 //#include "coreneuron/nrniv/sptree.h"
 
 /*
@@ -29,11 +29,15 @@
 
 #include <cstdio>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
 #include <queue>
 #include <vector>
 #include <map>
 #include <utility>
 #include "coreneuron/utils/nrnmutdec.h"
+#include "coreneuron/utils/object_pool.hpp"
 
 namespace coreneuron {
 #define STRCMP(a, b) (a - b)
@@ -118,14 +122,77 @@ class BinQ {
     std::vector<std::vector<TQItem*>> vec_bins;
 };
 
-enum container { spltree, pq_que };
+/**
+ * \class CalQ
+ * \brief Calendar queue (R. Brown, CACM 31(10), 1988) helper class for the TQueue
+ *
+ * Items are hashed by time into a ring of buckets. Each bucket is a time
+ * sorted doubly linked list (left_ is the previous item, right_ the next one
+ * and cnt_ the bucket index). The least item is found by scanning forward from
+ * the current bucket, so with a bucket width close to the average separation
+ * of the next events, enqueue and dequeue are amortized O(1) instead of the
+ * O(log n) of the splay tree and the STL priority queue. The initial width is
+ * the simulation dt; the number of buckets follows the number of items and
+ * the width is re-estimated from the head of the queue on every resize.
+ */
+class CalQ {
+  public:
+    explicit CalQ(double width);
+    ~CalQ();
+    void enqueue(TQItem*);
+    /// least item, or nullptr if empty. The item stays in the queue
+    TQItem* first();
+    /// remove and return the least item, or nullptr if empty
+    TQItem* dequeue();
+    void remove(TQItem*);
+    std::size_t size() const {
+        return size_;
+    }
+
+  private:
+    std::int64_t bucket_of(double t) const {
+        return static_cast<std::int64_t>(std::floor(t * rev_width_));
+    }
+    std::size_t index_of(std::int64_t b) const {
+        return static_cast<std::size_t>(b) & mask_;
+    }
+    void link(TQItem*);
+    void unlink(TQItem*);
+    void resize(std::size_t nbucket);
 
+    static constexpr std::size_t min_nbucket_ = 16;
+    double width_, min_width_, rev_width_;
+    std::vector<TQItem*> heads_, tails_;
+    std::size_t mask_;
+    std::size_t size_ = 0;
+    /// bucket number (time / width) of the current bucket. No item in the
+    /// queue has a smaller bucket number
+    std::int64_t cur_ = 0;
+};
+
+/// Containers for the events of the TQueue
+enum container { spltree, pq_que, calq };
+
+/**
+ * \class TQueue
+ * \brief Event queue of a thread: the least item plus a container for the others
+ *
+ * The template argument is only the default container. The actual one is chosen
+ * at construction so that the queue can be selected at runtime.
+ *
+ * If a pool is given, the TQItem are allocated from it and the items returned by
+ * atomic_dq() and dequeue_bin() must be given back with release() instead of delete.
+ */
 template <container C = spltree>
 class TQueue {
   public:
-    TQueue();
+    explicit TQueue(container kind = C, ObjectPool<TQItem>* pool = nullptr);
     ~TQueue();
 
+    inline container kind() const {
+        return kind_;
+    }
+
     inline TQItem* least() {
         return least_;
     }
@@ -145,6 +212,14 @@ class TQueue {
     inline TQItem* atomic_dq(double til);
     inline void remove(TQItem*);
     inline void move(TQItem*, double tnew);
+    /// give back an item that is no longer in the queue
+    inline void release(TQItem* q) {
+        if (pool_) {
+            pool_->release(q);
+        } else {
+            delete q;
+        }
+    }
     int nshift_;
 
     /// Priority queue of vectors for queuing the events. enqueuing for move() and
@@ -162,7 +237,17 @@ class TQueue {
         }
     }
     void move_least_nolock(double tnew);
+    inline TQItem* alloc_item() {
+        return pool_ ? pool_->alloc() : new TQItem;
+    }
+    /// container dispatch, the least_ item is never in the container
+    inline void enqueue_nolock(TQItem*);
+    inline TQItem* first_nolock();
+    inline TQItem* dequeue_nolock();
+    container kind_;
     SPTREE* sptree_;
+    CalQ* calq_;
+    ObjectPool<TQItem>* pool_;
 
   public:
     BinQ* binq_;
@@ -30,11 +30,14 @@ of struct _spblk, we are really using TQItem
 */
 
 template <container C>
-TQueue<C>::TQueue() {
+TQueue<C>::TQueue(container kind, ObjectPool<TQItem>* pool)
+    : kind_(kind)
+    , pool_(pool) {
     MUTCONSTRUCT(0)
     nshift_ = 0;
     sptree_ = new SPTREE;
     spinit(sptree_);
+    calq_ = kind_ == calq ? new CalQ(dt > 0. ? dt : 0.025) : nullptr;
     binq_ = new BinQ;
     least_ = 0;
 }
@@ -46,34 +49,42 @@ TQueue<C>::~TQueue() {
     for (q = binq_->first(); q; q = q2) {
         q2 = binq_->next(q);
         binq_->remove(q);
-        delete q;
+        release(q);
     }
     delete binq_;
 
     if (least_) {
-        delete least_;
+        release(least_);
         least_ = nullptr;
     }
 
     /// Clear the splay tree
     while ((q = spdeq(&sptree_->root)) != nullptr) {
-        delete q;
+        release(q);
     }
     delete sptree_;
 
     /// Clear the priority queue
     while (pq_que_.size()) {
-        delete pq_que_.top().second;
+        release(pq_que_.top().second);
         pq_que_.pop();
     }
 
+    /// Clear the calendar queue
+    if (calq_) {
+        while ((q = calq_->dequeue()) != nullptr) {
+            release(q);
+        }
+        delete calq_;
+    }
+
     MUTDESTRUCT
 }
 
 template <container C>
 TQItem* TQueue<C>::enqueue_bin(double td, void* d) {
     MUTLOCK
-    TQItem* i = new TQItem;
+    TQItem* i = alloc_item();
     i->data_ = d;
     i->t_ = td;
     binq_->enqueue(td, i);
@@ -81,111 +92,112 @@ TQItem* TQueue<C>::enqueue_bin(double td, void* d) {
     return i;
 }
 
-/// Splay tree priority queue implementation
-template <>
-inline void TQueue<spltree>::move_least_nolock(double tnew) {
-    TQItem* b = least();
-    if (b) {
-        b->t_ = tnew;
-        TQItem* nl;
-        nl = sphead(sptree_);
-        if (nl && (tnew > nl->t_)) {
-            least_ = spdeq(&sptree_->root);
-            spenq(b, sptree_);
+template <container C>
+inline void TQueue<C>::enqueue_nolock(TQItem* i) {
+    switch (kind_) {
+        case spltree:
+            spenq(i, sptree_);
+            break;
+        case pq_que:
+            pq_que_.push(make_TQPair(i));
+            break;
+        case calq:
+            calq_->enqueue(i);
+            break;
+    }
+}
+
+template <container C>
+inline TQItem* TQueue<C>::first_nolock() {
+    switch (kind_) {
+        case spltree:
+            return sphead(sptree_);
+        case pq_que:
+            /// This while loop is to delete events whose times have been moved with the ::move
+            /// function, but in fact events were left in the queue since the only function
+            /// available is pop
+            while (pq_que_.size() && pq_que_.top().second->t_ < 0.) {
+                release(pq_que_.top().second);
+                pq_que_.pop();
+            }
+            return pq_que_.size() ? pq_que_.top().second : nullptr;
+        case calq:
+            return calq_->first();
+    }
+    return nullptr;
+}
+
+template <container C>
+inline TQItem* TQueue<C>::dequeue_nolock() {
+    switch (kind_) {
+        case spltree:
+            return sptree_->root ? spdeq(&sptree_->root) : nullptr;
+        case pq_que: {
+            TQItem* q = first_nolock();
+            if (q) {
+                pq_que_.pop();
+            }
+            return q;
         }
+        case calq:
+            return calq_->dequeue();
     }
+    return nullptr;
 }
 
-/// STL priority queue implementation
-template <>
-inline void TQueue<pq_que>::move_least_nolock(double tnew) {
+template <container C>
+void TQueue<C>::move_least_nolock(double tnew) {
     TQItem* b = least();
     if (b) {
         b->t_ = tnew;
-        TQItem* nl;
-        nl = pq_que_.top().second;
+        TQItem* nl = first_nolock();
         if (nl && (tnew > nl->t_)) {
-            least_ = nl;
-            pq_que_.pop();
-            pq_que_.push(make_TQPair(b));
+            least_ = dequeue_nolock();
+            enqueue_nolock(b);
         }
     }
 }
 
-/// Splay tree priority queue implementation
-template <>
-inline void TQueue<spltree>::move(TQItem* i, double tnew) {
-    MUTLOCK
-    if (i == least_) {
-        move_least_nolock(tnew);
-    } else if (tnew < least_->t_) {
-        spdelete(i, sptree_);
-        i->t_ = tnew;
-        spenq(least_, sptree_);
-        least_ = i;
-    } else {
-        spdelete(i, sptree_);
-        i->t_ = tnew;
-        spenq(i, sptree_);
-    }
-    MUTUNLOCK
-}
-
-/// STL priority queue implementation
-template <>
-inline void TQueue<pq_que>::move(TQItem* i, double tnew) {
+template <container C>
+inline void TQueue<C>::move(TQItem* i, double tnew) {
     MUTLOCK
     if (i == least_) {
         move_least_nolock(tnew);
-    } else if (tnew < least_->t_) {
-        TQItem* qmove = new TQItem;
+    } else if (kind_ == pq_que) {
+        /// An item cannot be taken out of the STL priority queue: a copy is
+        /// enqueued and the original is flagged to be deleted when popped
+        TQItem* qmove = alloc_item();
         qmove->data_ = i->data_;
         qmove->t_ = tnew;
         qmove->cnt_ = i->cnt_;
         i->t_ = -1.;
-        pq_que_.push(make_TQPair(least_));
-        least_ = qmove;
-    } else {
-        TQItem* qmove = new TQItem;
-        qmove->data_ = i->data_;
-        qmove->t_ = tnew;
-        qmove->cnt_ = i->cnt_;
-        i->t_ = -1.;
-        pq_que_.push(make_TQPair(qmove));
-    }
-    MUTUNLOCK
-}
-
-/// Splay tree priority queue implementation
-template <>
-inline TQItem* TQueue<spltree>::insert(double tt, void* d) {
-    MUTLOCK
-    TQItem* i = new TQItem;
-    i->data_ = d;
-    i->t_ = tt;
-    i->cnt_ = -1;
-    if (tt < least_t_nolock()) {
-        if (least_) {
-            /// Probably storing both time and event which has the time is redundant, but the event
-            /// is then returned
-            /// to the upper level call stack function. If we were to eliminate i->t_ and i->cnt_
-            /// fields,
-            /// we need to make sure we are not braking anything.
-            spenq(least_, sptree_);
+        if (tnew < least_->t_) {
+            pq_que_.push(make_TQPair(least_));
+            least_ = qmove;
+        } else {
+            pq_que_.push(make_TQPair(qmove));
         }
-        least_ = i;
     } else {
-        spenq(i, sptree_);
+        if (kind_ == spltree) {
+            spdelete(i, sptree_);
+        } else {
+            calq_->remove(i);
+        }
+        i->t_ = tnew;
+        if (tnew < least_->t_) {
+            enqueue_nolock(least_);
+            least_ = i;
+        } else {
+            enqueue_nolock(i);
+        }
     }
     MUTUNLOCK
-    return i;
 }
 
-/// STL priority queue implementation
-template <>
-inline TQItem* TQueue<pq_que>::insert(double tt, void* d) {
+template <container C>
+inline TQItem* TQueue<C>::insert(double tt, void* d) {
     MUTLOCK
-    TQItem* i = new TQItem;
+    TQItem* i = alloc_item();
     i->data_ = d;
     i->t_ = tt;
     i->cnt_ = -1;
@@ -196,93 +208,45 @@ inline TQItem* TQueue<pq_que>::insert(double tt, void* d) {
             /// to the upper level call stack function. If we were to eliminate i->t_ and i->cnt_
             /// fields,
             /// we need to make sure we are not braking anything.
-            pq_que_.push(make_TQPair(least_));
+            enqueue_nolock(least_);
         }
         least_ = i;
     } else {
-        pq_que_.push(make_TQPair(i));
+        enqueue_nolock(i);
     }
     MUTUNLOCK
     return i;
 }
 
-/// Splay tree priority queue implementation
-template <>
-inline void TQueue<spltree>::remove(TQItem* q) {
+template <container C>
+inline void TQueue<C>::remove(TQItem* q) {
     MUTLOCK
     if (q) {
         if (q == least_) {
-            if (sptree_->root) {
-                least_ = spdeq(&sptree_->root);
-            } else {
-                least_ = nullptr;
-            }
+            least_ = dequeue_nolock();
+            release(q);
+        } else if (kind_ == pq_que) {
+            /// deleted when it reaches the top of the priority queue
+            q->t_ = -1.;
         } else {
-            spdelete(q, sptree_);
-        }
-        delete q;
-    }
-    MUTUNLOCK
-}
-
-/// STL priority queue implementation
-template <>
-inline void TQueue<pq_que>::remove(TQItem* q) {
-    MUTLOCK
-    if (q) {
-        if (q == least_) {
-            if (pq_que_.size()) {
-                least_ = pq_que_.top().second;
-                pq_que_.pop();
+            if (kind_ == spltree) {
+                spdelete(q, sptree_);
             } else {
-                least_ = nullptr;
+                calq_->remove(q);
             }
-        } else {
-            q->t_ = -1.;
+            release(q);
         }
     }
     MUTUNLOCK
 }
 
-/// Splay tree priority queue implementation
-template <>
-inline TQItem* TQueue<spltree>::atomic_dq(double tt) {
-    TQItem* q = nullptr;
-    MUTLOCK
-    if (least_ && least_->t_ <= tt) {
-        q = least_;
-        if (sptree_->root) {
-            least_ = spdeq(&sptree_->root);
-        } else {
-            least_ = nullptr;
-        }
-    }
-    MUTUNLOCK
-    return q;
-}
-
-/// STL priority queue implementation
-template <>
-inline TQItem* TQueue<pq_que>::atomic_dq(double tt) {
+template <container C>
+inline TQItem* TQueue<C>::atomic_dq(double tt) {
     TQItem* q = nullptr;
     MUTLOCK
     if (least_ && least_->t_ <= tt) {
         q = least_;
-        //        int qsize = pq_que_.size();
-        //        printf("map size: %d\n", msize);
-        /// This while loop is to delete events whose times have been moved with the ::move
-        /// function,
-        /// but in fact events were left in the queue since the only function available is pop
-        while (pq_que_.size() && pq_que_.top().second->t_ < 0.) {
-            delete pq_que_.top().second;
-            pq_que_.pop();
-        }
-        if (pq_que_.size()) {
-            least_ = pq_que_.top().second;
-            pq_que_.pop();
-        } else {
-            least_ = nullptr;
-        }
+        least_ = dequeue_nolock();
     }
     MUTUNLOCK
     return q;
@@ -12,6 +12,7 @@
 #include <vector>
 #include <map>
 #include "coreneuron/network/netcon.hpp"
+#include "coreneuron/network/gid2in_table.hpp"
 namespace coreneuron {
 
 /// Mechanism type to be used from stdindex2ptr and nrn_dblpntr2nrncore (in Neuron)
@@ -25,6 +26,8 @@ extern std::vector<std::map<int, PreSyn*>> neg_gid2out;
 /// Maps for ouput and input presyns
 extern std::map<int, PreSyn*> gid2out;
 extern std::map<int, InputPreSyn*> gid2in;
+/// Flat copy of gid2in used on the spike receive path, built by determine_inputpresyn
+extern Gid2InTable gid2in_table;
 
 /// InputPreSyn.nc_index_ to + InputPreSyn.nc_cnt_ give the NetCon*
 extern std::vector<NetCon*> netcon_in_presyn_order_;
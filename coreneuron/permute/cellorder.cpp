@@ -7,6 +7,7 @@
 */
 
 #include <set>
+#include <vector>
 
 #include "coreneuron/nrnconf.h"
 #include "coreneuron/sim/multicore.hpp"
@@ -174,8 +175,8 @@ static void print_quality1(int iwarp, InterleaveInfo& ii, int ncell, int* p) {
     int pc = ((iwarp == 0) || iwarp == (ii.nwarp - 1));  // warp not to skip printing
     pc = 0;                                              // turn off printing.
     int* stride = ii.stride;
-    int cellbegin = iwarp * warpsize;
-    int cellend = cellbegin + warpsize;
+    int cellbegin = iwarp * interleave_warpsize();
+    int cellend = cellbegin + interleave_warpsize();
     cellend = (cellend < stride[0]) ? cellend : stride[0];
 
     int ncycle = 0;
@@ -202,7 +203,7 @@ static void print_quality1(int iwarp, InterleaveInfo& ii, int ncell, int* p) {
         int lastp = -2;
         if (pc)
             printf("  ");
-        for (int icore = 0; icore < warpsize; ++icore) {
+        for (int icore = 0; icore < interleave_warpsize(); ++icore) {
             char ch = '.';
             if (icore < ncell_in_warp && icore >= sbegin) {
                 int par = p[inode + icore];
@@ -340,7 +341,7 @@ int* interleave_order(int ith, int ncell, int nnode, int* parent) {
             ii.cache_access = new size_t[nwarp];
             ii.child_race = new size_t[nwarp];
             for (int i = 0; i < nwarp; ++i) {
-                if (interleave_permute_type == 1) {
+                if (interleave_permute_type == 1 || interleave_permute_type == 3) {
                     print_quality1(i, interleave_info[ith], ncell, p);
                 }
                 if (interleave_permute_type == 2) {
@@ -355,6 +356,35 @@ int* interleave_order(int ith, int ncell, int nnode, int* parent) {
     return order;
 }
 
+int* cell_contiguous_order(int ncell, int nnode, const int* parent) {
+    // cell of every node, the parent of a non root node comes before it
+    std::vector<int> cell(nnode);
+    bool contiguous = true;
+    for (int i = 0; i < nnode; ++i) {
+        cell[i] = i < ncell ? i : cell[parent[i]];
+        if (i > ncell && cell[i] < cell[i - 1]) {
+            contiguous = false;
+        }
+    }
+    if (contiguous) {
+        return nullptr;
+    }
+    // roots stay in place, the other nodes are grouped by cell keeping their order
+    std::vector<int> next(ncell + 1, 0);
+    for (int i = ncell; i < nnode; ++i) {
+        ++next[cell[i] + 1];
+    }
+    next[0] = ncell;
+    for (int i = 0; i < ncell; ++i) {
+        next[i + 1] += next[i];
+    }
+    int* order = new int[nnode];
+    for (int i = 0; i < nnode; ++i) {
+        order[i] = i < ncell ? i : next[cell[i]]++;
+    }
+    return order;
+}
+
 #if INTERLEAVE_DEBUG  // only the cell per core style
 static int** cell_indices_debug(NrnThread& nt, InterleaveInfo& ii) {
     int ncell = nt.ncell;
@@ -680,11 +710,87 @@ void solve_interleaved1(int ith) {
 #endif
 }
 
+// With the interleave1 ordering the nodes of a cycle are contiguous, one per cell
+// (cells with fewer nodes have none): [ncell + sum(stride[0:icycle]), + stride[icycle]).
+// Two nodes of a cycle never share a parent and can be solved by the lanes of
+// the same vector instruction.
+static void triang_interleaved_simd(NrnThread* nt, int nstride, int* stride) {
+    double* a = nt->_actual_a;
+    double* b = nt->_actual_b;
+    double* d = nt->_actual_d;
+    double* rhs = nt->_actual_rhs;
+    int* parent = nt->_v_parent_index;
+    int cycleend = nt->end;
+    for (int icycle = nstride - 1; icycle >= 0; --icycle) {
+        int cyclebegin = cycleend - stride[icycle];
+        // clang-format off
+        #pragma omp simd simdlen(simd_lanes)
+        // clang-format on
+        for (int i = cyclebegin; i < cycleend; ++i) {
+            int ip = parent[i];
+            double p = a[i] / d[i];
+            d[ip] -= p * b[i];
+            rhs[ip] -= p * rhs[i];
+        }
+        cycleend = cyclebegin;
+    }
+}
+
+static void bksub_interleaved_simd(NrnThread* nt, int nstride, int* stride) {
+    int ncell = nt->ncell;
+    double* b = nt->_actual_b;
+    double* d = nt->_actual_d;
+    double* rhs = nt->_actual_rhs;
+    int* parent = nt->_v_parent_index;
+    // clang-format off
+    #pragma omp simd simdlen(simd_lanes)
+    // clang-format on
+    for (int icell = 0; icell < ncell; ++icell) {
+        rhs[icell] /= d[icell];  // the roots
+    }
+    int cyclebegin = ncell;
+    for (int icycle = 0; icycle < nstride; ++icycle) {
+        int cycleend = cyclebegin + stride[icycle];
+        // clang-format off
+        #pragma omp simd simdlen(simd_lanes)
+        // clang-format on
+        for (int i = cyclebegin; i < cycleend; ++i) {
+            rhs[i] -= b[i] * rhs[parent[i]];
+            rhs[i] /= d[i];
+        }
+        cyclebegin = cycleend;
+    }
+}
+
+/**
+ * \brief Solve Hines matrices/cells on the CPU, simd_lanes cells per vector instruction.
+ *
+ * Uses the ordering of interleave_permute_type == 1. Every cycle is a single
+ * contiguous sweep over the cells that have a node in it, so that the memory
+ * is streamed in order like with triang/bksub while the cells of a warp are
+ * solved by the lanes of one vector instruction.
+ */
+void solve_interleaved_simd(int ith) {
+    NrnThread* nt = nrn_threads + ith;
+    if (nt->ncell == 0) {
+        return;
+    }
+    InterleaveInfo& ii = interleave_info[ith];
+    triang_interleaved_simd(nt, ii.nstride, ii.stride);
+    bksub_interleaved_simd(nt, ii.nstride, ii.stride);
+}
+
 void solve_interleaved(int ith) {
-    if (interleave_permute_type != 1) {
+    if (interleave_permute_type == 3) {
+        solve_interleaved_simd(ith);
+    } else if (interleave_permute_type != 1) {
         solve_interleaved2(ith);
     } else {
         solve_interleaved1(ith);
     }
 }
+
+int interleave_warpsize() {
+    return interleave_permute_type == 3 ? simd_lanes : warpsize;
+}
 }  // namespace coreneuron
@@ -26,19 +26,50 @@ namespace coreneuron {
  */
 int* interleave_order(int ith, int ncell, int nnode, int* parent);
 
+/**
+ * \brief Permutation that makes the non root nodes of every cell contiguous.
+ *
+ * Roots keep their place and the other nodes are grouped by cell, in cell
+ * order, without changing their order within a cell. Used by the cell blocks
+ * of the fixed step (see cell_blocks.hpp).
+ *
+ * \return int* : a permutation of length nnode, nullptr if the nodes of
+ *         every cell are already contiguous
+ */
+int* cell_contiguous_order(int ncell, int nnode, const int* parent);
+
 void create_interleave_info();
 void destroy_interleave_info();
 
 /**
  *
- * \brief Solve the Hines matrices based on the interleave_permute_type (1 or 2).
+ * \brief Solve the Hines matrices based on the interleave_permute_type (1, 2 or 3).
  *
  * For interleave_permute_type == 1 : Naive interleaving -> Each execution thread deals with one
  * Hines matrix (cell) For interleave_permute_type == 2 : Advanced interleaving -> Each Hines matrix
  * is solved by multiple execution threads (with coalesced memory access as well)
+ * For interleave_permute_type == 3 : Naive interleaving solved on the CPU, simd_lanes cells per
+ * vector instruction
  */
 extern void solve_interleaved(int ith);
 
+/**
+ * \brief Number of cells solved together by interleave_permute_type == 3.
+ *
+ * Doubles of two vector registers of the host: the second one hides the
+ * latency of the gathers and scatters of the parent values.
+ */
+#if defined(__AVX512F__)
+constexpr int simd_lanes = 16;
+#elif defined(__AVX__)
+constexpr int simd_lanes = 8;
+#else
+constexpr int simd_lanes = 4;
+#endif
+
+/// Number of cells of a warp: simd_lanes for interleave_permute_type == 3, warpsize otherwise
+int interleave_warpsize();
+
 class InterleaveInfo;  // forward declaration
 /**
  *
@@ -335,7 +335,7 @@ int* node_order(int ncell,
     level_from_root(nodevec);
 
     // nodevec[ncell:nnode] cells are interleaved in nodevec[0:ncell] cell order
-    if (interleave_permute_type == 1) {
+    if (interleave_permute_type == 1 || interleave_permute_type == 3) {
         node_interleave_order(ncell, nodevec);
     } else {
         group_order2(nodevec, groupsize, ncell);
@@ -361,7 +361,7 @@ int* node_order(int ncell,
     }
 
     // administrative statistics for gauss elimination
-    if (interleave_permute_type == 1) {
+    if (interleave_permute_type == 1 || interleave_permute_type == 3) {
         admin1(ncell, nodevec, nwarp, nstride, stride, firstnode, lastnode, cellsize);
     } else {
         //  admin2(ncell, nodevec, nwarp, nstride, stridedispl, stride, rootbegin, nodebegin,
@@ -521,7 +521,7 @@ static void admin1(int ncell,
     lastnode = (int*) ecalloc_align(ncell, sizeof(int));
     cellsize = (int*) ecalloc_align(ncell, sizeof(int));
 
-    nwarp = (ncell % warpsize == 0) ? (ncell / warpsize) : (ncell / warpsize + 1);
+    nwarp = (ncell + interleave_warpsize() - 1) / interleave_warpsize();
 
     for (int i = 0; i < ncell; ++i) {
         firstnode[i] = -1;
@@ -0,0 +1,368 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <unistd.h>
+#include <vector>
+
+#include "coreneuron/sim/cell_blocks.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/coreneuron.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/network/partrans.hpp"
+#include "coreneuron/nrnconf.h"
+#include "coreneuron/nrniv/nrniv_decl.h"
+#include "coreneuron/sim/fast_imem.hpp"
+#include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/utils/profile/profiler_interface.h"
+
+namespace coreneuron {
+bool nrn_cell_blocks;
+
+namespace {
+/// Instances of a mechanism in one node range of a block
+struct BlockMech {
+    int type;
+    Memb_list ml;  /// view of the Memb_list of the thread
+};
+
+/// Whole cells, their roots and their other nodes
+struct CellBlock {
+    int root_begin, root_end;
+    int node_begin, node_end;
+    std::vector<BlockMech> mechs;  /// in the order of the thread mechanisms
+};
+
+struct ThreadBlocks {
+    std::vector<CellBlock> blocks;
+    /// mechanisms without nodes (artificial cells) with a state, run once per step
+    std::vector<NrnThreadMembList*> unblocked;
+};
+}  // namespace
+
+static std::vector<ThreadBlocks> thread_blocks;
+
+std::size_t nrn_cell_block_default_bytes() {
+    long l2 = 0;
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    if (l2 <= 0) {
+        l2 = 1024 * 1024;
+    }
+    // the other half for the data of the mechanism kernels and the next block
+    return l2 / 2;
+}
+
+std::vector<int> nrn_cell_block_partition(const std::vector<std::size_t>& cell_bytes,
+                                          std::size_t block_bytes) {
+    std::vector<int> first;
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < cell_bytes.size(); ++i) {
+        if (first.empty() || bytes + cell_bytes[i] > block_bytes) {
+            first.push_back(i);
+            bytes = 0;
+        }
+        bytes += cell_bytes[i];
+    }
+    first.push_back(cell_bytes.size());
+    return first;
+}
+
+/// View of the instances [begin, end) of a Memb_list
+static Memb_list memb_list_view(const Memb_list& ml, int type, int begin, int end) {
+    Memb_list view = ml;
+    // with SoA the variables of an instance stay _nodecount_padded apart
+    bool soa = corenrn.get_mech_data_layout()[type] == Layout::SoA;
+    int psize = soa ? 1 : corenrn.get_prop_param_size()[type];
+    int dpsize = soa ? 1 : corenrn.get_prop_dparam_size()[type];
+    view.nodeindices = ml.nodeindices + begin;
+    view.data = ml.data + begin * psize;
+    if (ml.pdata) {
+        view.pdata = ml.pdata + begin * dpsize;
+    }
+    view._permute = nullptr;
+    view.nodecount = end - begin;
+    return view;
+}
+
+/// Check that the thread can be blocked, collect its mechanisms without nodes
+static bool thread_blockable(NrnThread& nt, ThreadBlocks& tb) {
+    if (nt.ncell == 0 || nt.n_vecplay) {
+        return false;
+    }
+    std::vector<int> cell(nt.end);
+    for (int i = 0; i < nt.end; ++i) {
+        cell[i] = i < nt.ncell ? i : cell[nt._v_parent_index[i]];
+        if (i > nt.ncell && cell[i] < cell[i - 1]) {
+            return false;
+        }
+    }
+    for (auto tml = nt.tml; tml; tml = tml->next) {
+        const Memb_list* ml = tml->ml;
+        if (corenrn.get_is_artificial()[tml->index] || !ml->nodeindices) {
+            if (corenrn.get_memb_func(tml->index).state) {
+                tb.unblocked.push_back(tml);
+            }
+            continue;
+        }
+        if (ml->instance || !std::is_sorted(ml->nodeindices, ml->nodeindices + ml->nodecount)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void thread_blocks_setup(NrnThread& nt, ThreadBlocks& tb, std::size_t block_bytes) {
+    // bytes streamed per step by the nodes and the mechanism instances of each cell
+    int nnode_array = nt.nrn_fast_imem ? 8 : 6;  // v, rhs, d, a, b, area, fast_imem
+    std::vector<std::size_t> node_bytes(nt.end, nnode_array * sizeof(double) + sizeof(int));
+    for (auto tml = nt.tml; tml; tml = tml->next) {
+        const Memb_list* ml = tml->ml;
+        if (corenrn.get_is_artificial()[tml->index] || !ml->nodeindices) {
+            continue;
+        }
+        std::size_t bytes = corenrn.get_prop_param_size()[tml->index] * sizeof(double) +
+                            corenrn.get_prop_dparam_size()[tml->index] * sizeof(int) + sizeof(int);
+        for (int i = 0; i < ml->nodecount; ++i) {
+            node_bytes[ml->nodeindices[i]] += bytes;
+        }
+    }
+    // cells are contiguous and in order, see thread_blockable
+    std::vector<int> cell(nt.end);
+    std::vector<std::size_t> cell_bytes(nt.ncell, 0);
+    std::vector<int> cell_node_end(nt.ncell, nt.ncell);
+    for (int i = 0; i < nt.end; ++i) {
+        cell[i] = i < nt.ncell ? i : cell[nt._v_parent_index[i]];
+        cell_bytes[cell[i]] += node_bytes[i];
+        if (i >= nt.ncell) {
+            cell_node_end[cell[i]] = i + 1;
+        }
+    }
+    // a cell without non root nodes ends where the previous one ends
+    for (int c = 1; c < nt.ncell; ++c) {
+        cell_node_end[c] = std::max(cell_node_end[c], cell_node_end[c - 1]);
+    }
+
+    std::vector<int> first = nrn_cell_block_partition(cell_bytes, block_bytes);
+    for (std::size_t k = 0; k + 1 < first.size(); ++k) {
+        CellBlock b;
+        b.root_begin = first[k];
+        b.root_end = first[k + 1];
+        b.node_begin = b.root_begin ? cell_node_end[b.root_begin - 1] : nt.ncell;
+        b.node_end = cell_node_end[b.root_end - 1];
+        for (auto tml = nt.tml; tml; tml = tml->next) {
+            Memb_list* ml = tml->ml;
+            if (corenrn.get_is_artificial()[tml->index] || !ml->nodeindices) {
+                continue;
+            }
+            const int* ni = ml->nodeindices;
+            for (auto range: {std::make_pair(b.root_begin, b.root_end),
+                              std::make_pair(b.node_begin, b.node_end)}) {
+                int begin = std::lower_bound(ni, ni + ml->nodecount, range.first) - ni;
+                int end = std::lower_bound(ni, ni + ml->nodecount, range.second) - ni;
+                if (begin < end) {
+                    b.mechs.push_back({tml->index, memb_list_view(*ml, tml->index, begin, end)});
+                }
+            }
+        }
+        tb.blocks.push_back(std::move(b));
+    }
+}
+
+void nrn_cell_blocks_setup(std::size_t block_bytes) {
+    nrn_cell_blocks_cleanup();
+    if (nrn_have_gaps || secondorder || interleave_permute_type || corenrn_param.gpu) {
+        if (nrnmpi_myid == 0) {
+            printf(
+                " WARNING : --cell-blocks needs no gap junctions, secondorder 0, --cell-permute "
+                "0 and CPU execution. Ignoring it.\n");
+        }
+        return;
+    }
+    thread_blocks.resize(nrn_nthread);
+    int nblocked = 0;
+    std::size_t nblock = 0;
+    for (int i = 0; i < nrn_nthread; ++i) {
+        ThreadBlocks& tb = thread_blocks[i];
+        if (thread_blockable(nrn_threads[i], tb)) {
+            thread_blocks_setup(nrn_threads[i], tb, block_bytes);
+            nblock += tb.blocks.size();
+            ++nblocked;
+        } else {
+            tb = ThreadBlocks{};
+        }
+    }
+    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        printf(" Cell blocks of %zu KiB: %zu blocks in %d of %d threads\n",
+               block_bytes / 1024,
+               nblock,
+               nblocked,
+               nrn_nthread);
+    }
+}
+
+void nrn_cell_blocks_cleanup() {
+    thread_blocks.clear();
+}
+
+bool nrn_cell_blocks_active(const NrnThread* nt) {
+    return nt->id < static_cast<int>(thread_blocks.size()) &&
+           !thread_blocks[nt->id].blocks.empty();
+}
+
+/// Apply f to the roots and then to the other nodes of a block
+template <typename F>
+static void for_block_nodes(const CellBlock& b, F&& f) {
+    for (int i = b.root_begin; i < b.root_end; ++i) {
+        f(i);
+    }
+    for (int i = b.node_begin; i < b.node_end; ++i) {
+        f(i);
+    }
+}
+
+/// nrn_rhs of treeset_core.cpp for the nodes of a block
+static void block_rhs(NrnThread* nt, CellBlock& b) {
+    double* vec_rhs = nt->_actual_rhs;
+    double* vec_d = nt->_actual_d;
+    double* vec_a = nt->_actual_a;
+    double* vec_b = nt->_actual_b;
+    double* vec_v = nt->_actual_v;
+    int* parent_index = nt->_v_parent_index;
+    NrnFastImem* fast_imem = nt->nrn_fast_imem;
+
+    for_block_nodes(b, [=](int i) {
+        vec_rhs[i] = 0.;
+        vec_d[i] = 0.;
+    });
+    if (fast_imem) {
+        for_block_nodes(b, [=](int i) {
+            fast_imem->nrn_sav_d[i] = 0.;
+            fast_imem->nrn_sav_rhs[i] = 0.;
+        });
+    }
+    for (auto& m: b.mechs) {
+        if (mod_f_t cur = corenrn.get_memb_func(m.type).current) {
+            (*cur)(nt, &m.ml, m.type);
+        }
+    }
+    if (fast_imem) {
+        for_block_nodes(b, [=](int i) { fast_imem->nrn_sav_rhs[i] -= vec_rhs[i]; });
+    }
+    for (int i = b.node_begin; i < b.node_end; ++i) {
+        double dv = vec_v[parent_index[i]] - vec_v[i];
+        vec_rhs[i] -= vec_b[i] * dv;
+        vec_rhs[parent_index[i]] += vec_a[i] * dv;
+    }
+}
+
+/// nrn_lhs of treeset_core.cpp for the nodes of a block
+static void block_lhs(NrnThread* nt, CellBlock& b) {
+    double* vec_d = nt->_actual_d;
+    double* vec_a = nt->_actual_a;
+    double* vec_b = nt->_actual_b;
+    int* parent_index = nt->_v_parent_index;
+
+    for (auto& m: b.mechs) {
+        if (mod_f_t jacob = corenrn.get_memb_func(m.type).jacob) {
+            (*jacob)(nt, &m.ml, m.type);
+        }
+    }
+    for (auto& m: b.mechs) {
+        if (m.type == CAP) {
+            nrn_jacob_capacitance(nt, &m.ml, m.type);
+        }
+    }
+    if (NrnFastImem* fast_imem = nt->nrn_fast_imem) {
+        for_block_nodes(b, [=](int i) { fast_imem->nrn_sav_d[i] += vec_d[i]; });
+    }
+    for (int i = b.node_begin; i < b.node_end; ++i) {
+        vec_d[i] -= vec_b[i];
+        vec_d[parent_index[i]] -= vec_a[i];
+    }
+}
+
+/// triang and bksub of solve_core.cpp for the cells of a block
+static void block_solve(NrnThread* nt, const CellBlock& b) {
+    double* vec_a = nt->_actual_a;
+    double* vec_b = nt->_actual_b;
+    double* vec_d = nt->_actual_d;
+    double* vec_rhs = nt->_actual_rhs;
+    int* parent_index = nt->_v_parent_index;
+
+    for (int i = b.node_end - 1; i >= b.node_begin; --i) {
+        double p = vec_a[i] / vec_d[i];
+        vec_d[parent_index[i]] -= p * vec_b[i];
+        vec_rhs[parent_index[i]] -= p * vec_rhs[i];
+    }
+    for (int i = b.root_begin; i < b.root_end; ++i) {
+        vec_rhs[i] /= vec_d[i];
+    }
+    for (int i = b.node_begin; i < b.node_end; ++i) {
+        vec_rhs[i] -= vec_b[i] * vec_rhs[parent_index[i]];
+        vec_rhs[i] /= vec_d[i];
+    }
+}
+
+/// update of fadvance_core.cpp for the nodes of a block, secondorder is 0
+static void block_update(NrnThread* nt, CellBlock& b) {
+    double* vec_v = nt->_actual_v;
+    double* vec_rhs = nt->_actual_rhs;
+    double* vec_area = nt->_actual_area;
+
+    for_block_nodes(b, [=](int i) { vec_v[i] += vec_rhs[i]; });
+    for (auto& m: b.mechs) {
+        if (m.type == CAP) {
+            nrn_cur_capacitance(nt, &m.ml, m.type);
+        }
+    }
+    if (NrnFastImem* fast_imem = nt->nrn_fast_imem) {
+        double* fast_imem_d = fast_imem->nrn_sav_d;
+        double* fast_imem_rhs = fast_imem->nrn_sav_rhs;
+        for_block_nodes(b, [=](int i) {
+            fast_imem_rhs[i] = (fast_imem_d[i] * vec_rhs[i] + fast_imem_rhs[i]) * vec_area[i] *
+                               0.01;
+        });
+    }
+}
+
+static void block_states(NrnThread* nt, CellBlock& b) {
+    for (auto& m: b.mechs) {
+        if (mod_f_t state = corenrn.get_memb_func(m.type).state) {
+            (*state)(nt, &m.ml, m.type);
+        }
+    }
+}
+
+void nrn_fixed_step_cell_blocks(NrnThread* nt) {
+    ThreadBlocks& tb = thread_blocks[nt->id];
+    Instrumentor::phase p("cell-blocks");
+    double t_half = nt->_t;
+    double t_end = t_half + 0.5 * nt->_dt;
+    errno = 0;
+
+    nrn_ba(nt, BEFORE_BREAKPOINT);
+    for (auto& b: tb.blocks) {
+        nt->_t = t_half;
+        block_rhs(nt, b);
+        block_lhs(nt, b);
+        block_solve(nt, b);
+        block_update(nt, b);
+        nt->_t = t_end;
+        block_states(nt, b);
+    }
+    for (auto tml: tb.unblocked) {
+        (*corenrn.get_memb_func(tml->index).state)(nt, tml->ml, tml->index);
+    }
+    nt->_t = t_half;
+}
+
+}  // namespace coreneuron
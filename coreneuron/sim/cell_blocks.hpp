@@ -0,0 +1,73 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+/**
+ * \file
+ * \brief Cache blocked fixed step over blocks of whole cells (--cell-blocks)
+ *
+ * The fixed step streams all the data of a thread several times: the
+ * currents of every mechanism, the matrix solve, the voltage update and the
+ * states of every mechanism. With 10^5 nodes or more per thread, each pass
+ * evicts the data of the previous one from the cache. In blocked mode a
+ * thread is split into blocks of whole cells whose node and mechanism data
+ * fit in the cache budget, and the whole sequence runs for a block before
+ * the next one. Cells do not share nodes, so a block only needs its own data.
+ *
+ * A block is a range of roots and the range of the other nodes of the same
+ * cells: the non root nodes of every cell must be contiguous, in cell order.
+ * Phase2 applies cell_contiguous_order when the order read from the model
+ * files is not. The mechanisms are run on views of their Memb_list that
+ * cover the instances of a block, instances must be sorted by node.
+ *
+ * A thread keeps the whole thread step when it plays continuous vectors or
+ * when one of its mechanisms is not sorted by node or uses an instance
+ * struct. Blocking is disabled altogether with gap junctions (the voltages
+ * of other threads are needed before the currents), with second order
+ * (ion currents are corrected after the solve of the whole thread), with
+ * --cell-permute (interleaved cells) and on GPU.
+ */
+
+#include <cstddef>
+#include <vector>
+
+namespace coreneuron {
+
+struct NrnThread;
+
+/// Cells are permuted and the fixed step is blocked, set before reading the model
+extern bool nrn_cell_blocks;
+
+/// Default cache budget of a block: half the L2 cache size of the host
+std::size_t nrn_cell_block_default_bytes();
+
+/**
+ * Split consecutive cells into blocks of at most block_bytes, a cell larger
+ * than block_bytes gets a block of its own.
+ *
+ * @return the first cell of every block followed by the number of cells
+ */
+std::vector<int> nrn_cell_block_partition(const std::vector<std::size_t>& cell_bytes,
+                                          std::size_t block_bytes);
+
+/// Set up the blocks of all the threads, after the model is read
+void nrn_cell_blocks_setup(std::size_t block_bytes);
+void nrn_cell_blocks_cleanup();
+
+/// True if the fixed step of the thread runs over cell blocks
+bool nrn_cell_blocks_active(const NrnThread* nt);
+
+/**
+ * Matrix setup, solve, voltage update and states of all the blocks of a
+ * thread, called at t + dt/2 instead of setup_tree_matrix_minimal, the solve,
+ * update and the nonvint of nrn_fixed_step_lastpart. The states see t + dt.
+ */
+void nrn_fixed_step_cell_blocks(NrnThread* nt);
+
+}  // namespace coreneuron
@@ -6,21 +6,29 @@
 # =============================================================================.
 */
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 #include "coreneuron/coreneuron.hpp"
 #include "coreneuron/nrnconf.h"
 #include "coreneuron/apps/corenrn_parameters.hpp"
 #include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/sim/cell_blocks.hpp"
 #include "coreneuron/mpi/nrnmpi.h"
 #include "coreneuron/sim/fast_imem.hpp"
 #include "coreneuron/gpu/nrn_acc_manager.hpp"
+#include "coreneuron/io/output_spikes.hpp"
 #include "coreneuron/io/reports/nrnreport.hpp"
 #include "coreneuron/network/netcvode.hpp"
 #include "coreneuron/network/netpar.hpp"
 #include "coreneuron/network/partrans.hpp"
 #include "coreneuron/utils/nrnoc_aux.hpp"
 #include "coreneuron/utils/progressbar/progressbar.hpp"
+#include "coreneuron/utils/spin_barrier.hpp"
 #include "coreneuron/utils/profile/profiler_interface.h"
 #include "coreneuron/io/nrn2core_direct.h"
 
@@ -95,26 +103,38 @@ void nrn_fixed_step_minimal() { /* not so minimal anymore with gap junctions */
         dt2thread(dt);
     }
     nrn_thread_table_check();
-    nrn_multithread_job(nrn_fixed_step_thread);
+    if (nrn_have_gaps && nrn_gap_overlap) {
+        // the transfer posted at the end of the previous step
+        Instrumentor::phase p_gap("gap-v-transfer");
+        nrnmpi_v_transfer_wait();
+    }
+    nrn_multithread_job_balanced(nrn_fixed_step_thread);
     if (nrn_have_gaps) {
         {
             Instrumentor::phase p_gap("gap-v-transfer");
-            nrnmpi_v_transfer();
+            if (nrn_gap_overlap) {
+                nrnmpi_v_transfer_post();
+            } else {
+                nrnmpi_v_transfer();
+            }
         }
-        nrn_multithread_job(nrn_fixed_step_lastpart);
+        nrn_multithread_job_balanced(nrn_fixed_step_lastpart);
     }
 #if NRNMPI
     if (nrn_threads[0]._stop_stepping) {
         nrn_spike_exchange(nrn_threads);
     }
 #endif
+    if (nrn_threads[0]._stop_stepping) {
+        Instrumentor::phase p("flush_spikes");
+        output_spikes_flush(nrn_threads[0]._t);
+        nrn_thread_balance_update();
+    }
 
-#if defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
     {
         Instrumentor::phase p("flush_reports");
         nrn_flush_reports(nrn_threads[0]._t);
     }
-#endif
     t = nrn_threads[0]._t;
 }
 
@@ -141,6 +161,7 @@ void nrn_fixed_single_steps_minimal(int total_sim_steps, double tstop) {
         }
         progress_bar.step(nrn_threads[0]._t);
     }
+    nrnmpi_v_transfer_complete();
 }
 
 
@@ -153,20 +174,23 @@ void nrn_fixed_step_group_minimal(int total_sim_steps) {
 
     ProgressBar progress_bar(step_group_n);
     while (step_group_end < step_group_n) {
-        nrn_multithread_job(nrn_fixed_step_group_thread,
-                            step_group_n,
-                            step_group_begin,
-                            step_group_end);
+        nrn_multithread_job_balanced(nrn_fixed_step_group_thread,
+                                     step_group_n,
+                                     step_group_begin,
+                                     step_group_end);
+        nrn_thread_balance_update();
 #if NRNMPI
         nrn_spike_exchange(nrn_threads);
 #endif
+        {
+            Instrumentor::phase p("flush_spikes");
+            output_spikes_flush(nrn_threads[0]._t);
+        }
 
-#if defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
         {
             Instrumentor::phase p("flush_reports");
             nrn_flush_reports(nrn_threads[0]._t);
         }
-#endif
         if (stoprun) {
             break;
         }
@@ -176,6 +200,138 @@ void nrn_fixed_step_group_minimal(int total_sim_steps) {
     t = nrn_threads[0]._t;
 }
 
+/* the threads live for the whole simulation instead of being forked and
+joined for each step (twice per step with gap junctions). They synchronize
+only where there is a dependency: the gap junction transfer of each step and
+the spike exchange and flushes at the end of each min delay interval. The
+MPI calls are made by the master thread in the serial part of a barrier.
+Without gap junctions, the NrnThreads can be handed out dynamically for
+each interval (nrn_dynamic_threads).
+*/
+void nrn_fixed_step_persistent(int total_sim_steps) {
+    dt2thread(dt);
+    nrn_thread_table_check();
+    int nworker = 1;
+#if defined(_OPENMP)
+    nworker = std::min(nrn_nthread, omp_get_max_threads());
+#endif
+    SpinBarrier barrier(nworker);
+    int step_begin = 0;  // first step of the current interval
+    int step_end = 0;    // first step of the next interval
+    bool stop = false;
+    std::atomic<int> gap_received{0};  // steps whose deferred gap transfer completed
+    std::atomic<int> next_thread{0};   // with nrn_dynamic_threads, in nrn_thread_order
+
+    ProgressBar progress_bar(total_sim_steps);
+    auto end_interval = [&] {
+#if NRNMPI
+        nrn_spike_exchange(nrn_threads);
+#endif
+        {
+            Instrumentor::phase p("flush_spikes");
+            output_spikes_flush(nrn_threads[0]._t);
+        }
+        {
+            Instrumentor::phase p("flush_reports");
+            nrn_flush_reports(nrn_threads[0]._t);
+        }
+        stop = stoprun;
+        step_begin = step_end;
+        progress_bar.update(step_end, nrn_threads[0]._t);
+        nrn_thread_balance_update();
+        next_thread.store(0, std::memory_order_relaxed);
+    };
+    auto gap_transfer = [] {
+        Instrumentor::phase p_gap("gap-v-transfer");
+        if (nrn_gap_overlap) {
+            nrnmpi_v_transfer_post();
+        } else {
+            nrnmpi_v_transfer();
+        }
+    };
+
+    double start = nrn_thread_clock();
+    // clang-format off
+
+    #pragma omp parallel num_threads(nworker) shared(nrn_threads, nrn_nthread)
+    // clang-format on
+    {
+        int worker = 0;
+#if defined(_OPENMP)
+        nrn_assert(omp_get_num_threads() == nworker);
+        worker = omp_get_thread_num();
+#endif
+        auto run = [worker](int id, auto&& job) {
+            double start = nrn_thread_clock();
+            job(nrn_threads + id);
+            nrn_thread_cost_add(worker, id, nrn_thread_clock() - start);
+        };
+        // the master thread owns nrn_threads[0], which makes MPI calls, in both modes
+        bool master = worker == 0;
+        bool sense = false;
+        if (!nrn_have_gaps) {
+            auto interval = [&](NrnThread* nth) {
+                nrn_fixed_step_group_thread(nth, total_sim_steps, step_begin, step_end);
+            };
+            while (step_begin < total_sim_steps && !stop) {
+                if (nrn_dynamic_threads) {
+                    // a whole interval per NrnThread, no dependency between them.
+                    // nrn_threads[0] makes MPI calls, it stays on the master
+                    if (master) {
+                        run(0, interval);
+                    }
+                    for (int k; (k = next_thread.fetch_add(1)) < nrn_nthread - 1;) {
+                        run(nrn_thread_order[k], interval);
+                    }
+                } else {
+                    for (int i = worker; i < nrn_nthread; i += nworker) {
+                        run(i, interval);
+                    }
+                }
+                barrier.wait(sense, master, end_interval);
+            }
+        } else {
+            // each step depends on the previous one of the same NrnThread, which
+            // is not followed by a barrier: the NrnThreads stay with their worker
+            bool deferred = nrn_gap_transfer_deferred();
+            for (int step = 0; step < total_sim_steps && !stop;) {
+                Instrumentor::phase p_timestep("timestep");
+                if (deferred) {
+                    // the targets are copied by nrn_fixed_step_thread
+                    spin_until(
+                        [&] { return gap_received.load(std::memory_order_acquire) >= step; });
+                }
+                for (int i = worker; i < nrn_nthread; i += nworker) {
+                    run(i, nrn_fixed_step_thread);
+                }
+                barrier.wait(sense, master, gap_transfer);
+                for (int i = worker; i < nrn_nthread; i += nworker) {
+                    run(i, nrn_fixed_step_lastpart);
+                }
+                ++step;
+                if (master && nrn_gap_overlap) {
+                    nrnmpi_v_transfer_wait();
+                    gap_received.store(step, std::memory_order_release);
+                }
+                // all the threads deliver the NetParEvent of the interval at the same step
+                bool interval_end = nrn_threads[worker]._stop_stepping || step == total_sim_steps;
+                if (interval_end) {
+                    for (int i = worker; i < nrn_nthread; i += nworker) {
+                        nrn_threads[i]._stop_stepping = 0;
+                    }
+                    if (master) {
+                        step_end = step;
+                    }
+                    barrier.wait(sense, master, end_interval);
+                }
+            }
+        }
+    }
+    nrn_thread_jobs_time_add(nrn_thread_clock() - start);
+    nrnmpi_v_transfer_complete();
+    t = nrn_threads[0]._t;
+}
+
 static void nrn_fixed_step_group_thread(NrnThread* nth,
                                         int step_group_max,
                                         int step_group_begin,
@@ -240,7 +396,7 @@ void update(NrnThread* _nt) {
 }
 
 void nonvint(NrnThread* _nt) {
-    if (nrn_have_gaps) {
+    if (nrn_have_gaps && !nrn_gap_transfer_deferred()) {
         Instrumentor::phase p("gap-v-transfer");
         nrnthread_v_transfer(_nt);
     }
@@ -250,10 +406,8 @@ void nonvint(NrnThread* _nt) {
     for (auto tml = _nt->tml; tml; tml = tml->next)
         if (corenrn.get_memb_func(tml->index).state) {
             mod_f_t s = corenrn.get_memb_func(tml->index).state;
-            std::string ss("state-");
-            ss += nrn_get_mechname(tml->index);
             {
-                Instrumentor::phase p(ss.c_str());
+                Instrumentor::phase p(Instrumentor::mech_phase::state, tml->index);
                 (*s)(_nt, tml->ml, tml->index);
             }
 #ifdef DEBUG
@@ -362,26 +516,39 @@ static void* nrn_fixed_step_thread(NrnThread* nth) {
 #endif
         fixed_play_continuous(nth);
 
-        {
-            Instrumentor::phase p("setup-tree-matrix");
-            setup_tree_matrix_minimal(nth);
+        if (nrn_have_gaps && nrn_gap_transfer_deferred()) {
+            Instrumentor::phase p("gap-v-transfer");
+            nrnthread_v_transfer(nth);
         }
 
-        {
-            Instrumentor::phase p("matrix-solver");
-            nrn_solve_minimal(nth);
-        }
+        if (nrn_cell_blocks_active(nth)) {
+            // up to the states, block by block
+            nrn_fixed_step_cell_blocks(nth);
+        } else {
+            {
+                Instrumentor::phase p("setup-tree-matrix");
+                setup_tree_matrix_minimal(nth);
+            }
 
-        {
-            Instrumentor::phase p("second-order-cur");
-            second_order_cur(nth, secondorder);
-        }
+            {
+                Instrumentor::phase p("matrix-solver");
+                nrn_solve_minimal(nth);
+            }
 
-        {
-            Instrumentor::phase p("update");
-            update(nth);
+            {
+                Instrumentor::phase p("second-order-cur");
+                second_order_cur(nth, secondorder);
+            }
+
+            {
+                Instrumentor::phase p("update");
+                update(nth);
+            }
         }
     }
+    if (nrn_have_gaps && nrn_gap_overlap) {
+        nrnthread_v_transfer_pack(nth);
+    }
     if (!nrn_have_gaps) {
         nrn_fixed_step_lastpart(nth);
     }
@@ -400,7 +567,9 @@ void* nrn_fixed_step_lastpart(NrnThread* nth) {
         // clang-format on
 
         fixed_play_continuous(nth);
-        nonvint(nth);
+        if (!nrn_cell_blocks_active(nth)) {
+            nonvint(nth);
+        }
         nrncore2nrn_send_values(nth);
         nrn_ba(nth, AFTER_SOLVE);
         nrn_ba(nth, BEFORE_STEP);
@@ -6,7 +6,9 @@
 # =============================================================================.
 */
 
+#include <algorithm>
 #include <cstdlib>
+#include <numeric>
 #include <vector>
 
 #include "coreneuron/nrnconf.h"
@@ -56,6 +58,61 @@ int nrn_nthread = 0;
 NrnThread* nrn_threads = nullptr;
 void (*nrn_mk_transfer_thread_data_)();
 
+bool nrn_dynamic_threads;
+std::vector<int> nrn_thread_order;
+
+namespace {
+/// one cache line per worker, they are updated concurrently
+struct alignas(64) WorkerTime {
+    double busy = 0.0;
+};
+std::vector<double> thread_cost;  // since the last nrn_thread_balance_update
+std::vector<WorkerTime> worker_time;
+double jobs_time;
+}  // namespace
+
+void nrn_thread_balance_init() {
+    thread_cost.assign(nrn_nthread, 0.0);
+    // NrnThread 0 stays on the master thread
+    nrn_thread_order.resize(std::max(nrn_nthread - 1, 0));
+    std::iota(nrn_thread_order.begin(), nrn_thread_order.end(), 1);
+    int nworker = 1;
+#if defined(_OPENMP)
+    nworker = omp_get_max_threads();
+#endif
+    worker_time.assign(nworker, WorkerTime{});
+    jobs_time = 0.0;
+}
+
+void nrn_thread_cost_add(int worker, int id, double seconds) {
+    thread_cost[id] += seconds;
+    nrn_threads[id]._ctime += seconds;
+    worker_time[worker].busy += seconds;
+}
+
+void nrn_thread_jobs_time_add(double seconds) {
+    jobs_time += seconds;
+}
+
+void nrn_thread_balance_update() {
+    std::stable_sort(nrn_thread_order.begin(), nrn_thread_order.end(), [](int a, int b) {
+        return thread_cost[a] > thread_cost[b];
+    });
+    std::fill(thread_cost.begin(), thread_cost.end(), 0.0);
+}
+
+double nrn_thread_jobs_time() {
+    return jobs_time;
+}
+
+std::vector<double> nrn_worker_idle_time() {
+    std::vector<double> idle;
+    for (const auto& w: worker_time) {
+        idle.push_back(std::max(jobs_time - w.busy, 0.0));
+    }
+    return idle;
+}
+
 /// --> CoreNeuron class
 static int table_check_cnt_;
 static ThreadDatum* table_check_;
@@ -14,8 +14,12 @@
 #include "coreneuron/mpi/nrnmpi.h"
 #include "coreneuron/mpi/core/nrnmpi.hpp"
 #include "coreneuron/io/reports/nrnreport.hpp"
+#include <chrono>
 #include <vector>
 #include <memory>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 namespace coreneuron {
 class NetCon;
@@ -81,6 +85,9 @@ struct NrnThread: public MemoryManaged {
     Point_process* pntprocs = nullptr;  // synapses and artificial cells with and without gid
     PreSyn* presyns = nullptr;          // all the output PreSyn with and without gid
     PreSynHelper* presyns_helper = nullptr;
+    // SoA copy of PreSyn thvar_index_ and threshold_ of the ncell real cells for check_thresh
+    int* presyns_thvar_index = nullptr;
+    double* presyns_threshold = nullptr;
     int** pnt2presyn_ix = nullptr;  // eliminates Point_process._presyn used only by net_event
                                     // sender.
     NetCon* netcons = nullptr;
@@ -126,7 +133,7 @@ struct NrnThread: public MemoryManaged {
     char* _sp13mat = nullptr;              /* handle to general sparse matrix */
     Memb_list* _ecell_memb_list = nullptr; /* normally nullptr */
 
-    double _ctime = 0.0; /* computation time in seconds (using nrnmpi_wtime) */
+    double _ctime = 0.0; /* computation time in seconds (see nrn_thread_cost_add) */
 
     NrnThreadBAList* tbl[BEFORE_AFTER_SIZE]; /* wasteful since almost all empty */
 
@@ -166,6 +173,88 @@ void nrn_multithread_job(F&& job, Args&&... args) {
     // clang-format on
 }
 
+/**
+ * Load balance of the NrnThreads over the OpenMP threads (workers)
+ *
+ * The jobs of the simulation loop measure the time spent in every NrnThread
+ * and by every worker. With --dynamic-threads a NrnThread is not bound to a
+ * worker: the NrnThreads are handed out dynamically, the most expensive of
+ * the last interval first, so that a model written with more cell groups
+ * than threads balances itself. NrnThread 0 always runs on the master
+ * thread, because it makes the MPI calls of the event delivery and MPI is
+ * initialised with MPI_THREAD_FUNNELED. The idle time of the workers, the
+ * time of the parallel jobs not spent in a NrnThread, is reported at the end
+ * of the run.
+ */
+extern bool nrn_dynamic_threads;
+/// NrnThread ids but 0, the most expensive since the last nrn_thread_balance_update first
+extern std::vector<int> nrn_thread_order;
+/// Reset the costs and the idle times, before the simulation loop
+extern void nrn_thread_balance_init();
+/// Add to the cost of NrnThread id and to the busy time of worker
+extern void nrn_thread_cost_add(int worker, int id, double seconds);
+/// Add to the time of the parallel jobs
+extern void nrn_thread_jobs_time_add(double seconds);
+/// Sort nrn_thread_order by the costs since the previous call
+extern void nrn_thread_balance_update();
+/// Time of the parallel jobs
+extern double nrn_thread_jobs_time();
+/// Time of the parallel jobs not spent in a NrnThread, for each worker
+extern std::vector<double> nrn_worker_idle_time();
+
+inline double nrn_thread_clock() {
+    using seconds = std::chrono::duration<double>;
+    return seconds(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline int nrn_worker_id() {
+#if defined(_OPENMP)
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/// nrn_multithread_job for the simulation loop, timed and balanced as described above
+template <typename F, typename... Args>
+void nrn_multithread_job_balanced(F&& job, Args&&... args) {
+    auto run = [&](int id) {
+        double start = nrn_thread_clock();
+        job(nrn_threads + id, args...);
+        nrn_thread_cost_add(nrn_worker_id(), id, nrn_thread_clock() - start);
+    };
+    double start = nrn_thread_clock();
+    int i;
+    if (nrn_dynamic_threads) {
+        int n = nrn_thread_order.size();
+        // clang-format off
+
+        #pragma omp parallel private(i) shared(nrn_thread_order, run, n)
+        // clang-format on
+        {
+            if (nrn_worker_id() == 0 && nrn_nthread) {
+                run(0);
+            }
+            // clang-format off
+
+            #pragma omp for schedule(dynamic, 1) nowait
+            // clang-format on
+            for (i = 0; i < n; ++i) {
+                run(nrn_thread_order[i]);
+            }
+        }
+    } else {
+        // clang-format off
+
+        #pragma omp parallel for private(i) shared(nrn_nthread, run) schedule(static, 1)
+        // clang-format on
+        for (i = 0; i < nrn_nthread; ++i) {
+            run(i);
+        }
+    }
+    nrn_thread_jobs_time_add(nrn_thread_clock() - start);
+}
+
 extern void nrn_thread_table_check(void);
 
 extern void nrn_threads_free(void);
@@ -183,6 +272,7 @@ extern void* setup_tree_matrix_minimal(NrnThread*);
 extern void nrncore2nrn_send_values(NrnThread*);
 extern void nrn_fixed_step_group_minimal(int total_sim_steps);
 extern void nrn_fixed_single_steps_minimal(int total_sim_steps, double tstop);
+extern void nrn_fixed_step_persistent(int total_sim_steps);
 extern void nrn_fixed_step_minimal(void);
 extern void nrn_finitialize(int setv, double v);
 extern void direct_mode_initialize();
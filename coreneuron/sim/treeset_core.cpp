@@ -60,9 +60,7 @@ static void nrn_rhs(NrnThread* _nt) {
     for (auto tml = _nt->tml; tml; tml = tml->next)
         if (corenrn.get_memb_func(tml->index).current) {
             mod_f_t s = corenrn.get_memb_func(tml->index).current;
-            std::string ss("cur-");
-            ss += nrn_get_mechname(tml->index);
-            Instrumentor::phase p(ss.c_str());
+            Instrumentor::phase p(Instrumentor::mech_phase::cur, tml->index);
             (*s)(_nt, tml->ml, tml->index);
 #ifdef DEBUG
             if (errno) {
@@ -121,9 +119,7 @@ static void nrn_lhs(NrnThread* _nt) {
     for (auto tml = _nt->tml; tml; tml = tml->next)
         if (corenrn.get_memb_func(tml->index).jacob) {
             mod_f_t s = corenrn.get_memb_func(tml->index).jacob;
-            std::string ss("cur-");
-            ss += nrn_get_mechname(tml->index);
-            Instrumentor::phase p(ss.c_str());
+            Instrumentor::phase p(Instrumentor::mech_phase::cur, tml->index);
             (*s)(_nt, tml->ml, tml->index);
 #ifdef DEBUG
             if (errno) {
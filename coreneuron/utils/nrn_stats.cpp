@@ -21,6 +21,7 @@
 #include "coreneuron/mpi/nrnmpi.h"
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/network/netcvode.hpp"
+#include "coreneuron/network/netpar.hpp"
 #include "coreneuron/network/partrans.hpp"
 #include "coreneuron/io/output_spikes.hpp"
 #include "coreneuron/apps/corenrn_parameters.hpp"
@@ -44,11 +45,14 @@ void report_cell_stats() {
             stat_array[12] += n;  // number of transfer sources
         }
     }
-    stat_array[5] = spikevec_gid.size();  // number of spikes
+    spikevec_merge();
+    // spikes already written by --spikes-flush are no longer in spikevec
+    stat_array[5] = spikevec_gid.size() + spikevec_flushed;  // number of spikes
 
+    // only spikes of non-negative gids are recorded, flushed ones included
     stat_array[6] = std::count_if(spikevec_gid.cbegin(), spikevec_gid.cend(), [](const int& s) {
         return s > -1;
-    });  // number of non-negative gid spikes
+    }) + spikevec_flushed;  // number of non-negative gid spikes
 
 #if NRNMPI
     long gstat_array[NUM_STATS];
@@ -75,5 +79,102 @@ void report_cell_stats() {
         printf(" Number of spikes: %ld\n", gstat_array[5]);
         printf(" Number of spikes with non negative gid-s: %ld\n", gstat_array[6]);
     }
+
+    // the tuner takes the same decisions on all the ranks, no reduction needed
+    SpikeExchangeStats exchange = nrn_spike_exchange_stats();
+    if (nrnmpi_myid == 0 && exchange.spikebuf_capacity >= 0) {
+        printf(" Spike buffer capacity: %d\n", exchange.spikebuf_capacity);
+        printf(" Number of spike buffer resizes: %ld\n", exchange.spikebuf_resizes);
+        printf(" Number of spike buffer overflows: %ld of %ld exchanges\n",
+               exchange.spikebuf_overflows,
+               exchange.nexchange);
+    }
+}
+
+void report_event_stats() {
+    const int NUM_EVENT_STATS = 6;
+    long stat_array[NUM_EVENT_STATS] = {0, 0, 0, 0, 0, 0};
+
+    if (net_cvode_instance) {
+        for (int ith = 0; ith < nrn_nthread; ++ith) {
+            const NetCvodeThreadData& d = net_cvode_instance->p[ith];
+            stat_array[0] += d.tqitem_pool_.n_alloc();     // TQItem allocations
+            stat_array[1] += d.tqitem_pool_.n_slab();      // TQItem slabs from the heap
+            stat_array[2] += d.tqitem_pool_.n_peak();      // TQItem peak in use
+            stat_array[3] += d.selfevent_pool_.n_alloc();  // SelfEvent allocations
+            stat_array[4] += d.selfevent_pool_.n_slab();   // SelfEvent slabs from the heap
+            stat_array[5] += d.selfevent_pool_.n_peak();   // SelfEvent peak in use
+        }
+    }
+
+#if NRNMPI
+    long gstat_array[NUM_EVENT_STATS];
+    if (corenrn_param.mpi_enable) {
+        nrnmpi_long_allreduce_vec(stat_array, gstat_array, NUM_EVENT_STATS, 1);
+    } else {
+        std::memcpy(gstat_array, stat_array, sizeof(stat_array));
+    }
+#else
+    const long(&gstat_array)[NUM_EVENT_STATS] = stat_array;
+#endif
+
+    if (nrnmpi_myid == 0) {
+        printf("\n Event Allocation Statistics\n");
+        printf(" Number of TQItem allocations: %ld\n", gstat_array[0]);
+        printf(" Number of TQItem pool slabs: %ld\n", gstat_array[1]);
+        printf(" Peak number of TQItem in use: %ld\n", gstat_array[2]);
+        printf(" Number of SelfEvent allocations: %ld\n", gstat_array[3]);
+        printf(" Number of SelfEvent pool slabs: %ld\n", gstat_array[4]);
+        printf(" Peak number of SelfEvent in use: %ld\n", gstat_array[5]);
+    }
+}
+
+void report_spike_exchange_stats() {
+    SpikeExchangeStats stats = nrn_spike_exchange_stats();
+#if NRNMPI
+    if (!corenrn_param.mpi_enable || stats.nexchange == 0) {
+        return;
+    }
+    long bytes;
+    nrnmpi_long_allreduce_vec(&stats.bytes_received, &bytes, 1, 1);
+    double time_sum = nrnmpi_dbl_allreduce(stats.time, 1);
+    double time_max = nrnmpi_dbl_allreduce(stats.time, 2);
+
+    if (nrnmpi_myid == 0) {
+        double nexchange = stats.nexchange;
+        printf("\n Spike Exchange Statistics\n");
+        printf(" Method: %s\n", stats.method);
+        printf(" Number of exchanges: %ld\n", stats.nexchange);
+        printf(" Bytes received per rank and exchange: %.1lf\n",
+               bytes / (nexchange * nrnmpi_numprocs));
+        printf(" Time per exchange: %.3lf ms (mean rank) %.3lf ms (slowest rank)\n",
+               1e3 * time_sum / (nexchange * nrnmpi_numprocs),
+               1e3 * time_max / nexchange);
+    }
+#endif
+}
+
+void report_thread_idle_stats() {
+    std::vector<double> idle = nrn_worker_idle_time();
+    double jobs_time = nrn_thread_jobs_time();
+    double max_fraction = 0.0;
+    if (jobs_time > 0.0) {
+        for (double t: idle) {
+            max_fraction = std::max(max_fraction, t / jobs_time);
+        }
+    }
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        max_fraction = nrnmpi_dbl_allreduce(max_fraction, 2);
+    }
+#endif
+    if (nrnmpi_myid == 0 && idle.size() > 1 && jobs_time > 0.0) {
+        printf("\n Thread Idle Time on rank 0 (%s cell groups)\n",
+               nrn_dynamic_threads ? "dynamic" : "static");
+        for (std::size_t i = 0; i < idle.size(); ++i) {
+            printf(" Thread %zu: %.3lf s (%.1lf%%)\n", i, idle[i], 100. * idle[i] / jobs_time);
+        }
+        printf(" Largest idle fraction of a thread over the ranks: %.1lf%%\n", 100. * max_fraction);
+    }
 }
 }  // namespace coreneuron
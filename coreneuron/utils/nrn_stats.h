@@ -24,5 +24,22 @@ namespace coreneuron {
  */
 void report_cell_stats();
 
+/** @brief Reports global event allocation statistics of the simulation
+ *
+ *  This routine prints the number of TQItem and SelfEvent allocations and
+ *  how many of them actually went to the heap through the per thread pools
+ */
+void report_event_stats();
+
+/** @brief Reports the number of spike exchanges, bytes received per rank and
+ *  time per exchange, to compare the exchange methods on the same model
+ */
+void report_spike_exchange_stats();
+
+/** @brief Reports the idle time of every thread in the parallel parts of the
+ *  simulation loop, on rank 0, and the largest idle fraction over the ranks
+ */
+void report_thread_idle_stats();
+
 }  // namespace coreneuron
 #endif /* ifndef _H_NRN_STATS_ */
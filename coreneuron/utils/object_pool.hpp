@@ -0,0 +1,126 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace coreneuron {
+
+/**
+ * \class ObjectPool
+ * \brief Slab allocator for small objects of a single type
+ *
+ * Objects are carved out of slabs of slab_size objects and released objects
+ * are kept on a free list for reuse, so that in steady state alloc() and
+ * release() never call malloc/free. The pool is not thread safe: it is meant
+ * to be owned by a single thread (e.g. one per NetCvodeThreadData).
+ *
+ * clear() reclaims every object at once, without running destructors, and
+ * keeps the slabs for reuse. It must only be used for types whose destructor
+ * has no side effect.
+ */
+template <typename T>
+class ObjectPool {
+  public:
+    explicit ObjectPool(std::size_t slab_size = 4096)
+        : slab_size_(slab_size) {}
+
+    ~ObjectPool() {
+        for (Slot* s: slabs_) {
+            ::operator delete(s);
+        }
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename... Args>
+    T* alloc(Args&&... args) {
+        void* p;
+        if (free_) {
+            p = free_;
+            free_ = free_->next;
+        } else {
+            if (bump_ == end_) {
+                next_slab();
+            }
+            p = bump_++;
+        }
+        ++n_alloc_;
+        if (++n_in_use_ > n_peak_) {
+            n_peak_ = n_in_use_;
+        }
+        return new (p) T(std::forward<Args>(args)...);
+    }
+
+    void release(T* p) {
+        p->~T();
+        Slot* s = reinterpret_cast<Slot*>(p);
+        s->next = free_;
+        free_ = s;
+        --n_in_use_;
+    }
+
+    /// Reclaim all objects at once, the slabs are kept for reuse
+    void clear() {
+        nslab_used_ = 0;
+        bump_ = end_ = nullptr;
+        free_ = nullptr;
+        n_in_use_ = 0;
+    }
+
+    /// Number of objects handed out since construction
+    std::size_t n_alloc() const {
+        return n_alloc_;
+    }
+    /// Number of slabs, i.e. of actual allocations from the heap
+    std::size_t n_slab() const {
+        return slabs_.size();
+    }
+    std::size_t n_in_use() const {
+        return n_in_use_;
+    }
+    /// Maximum number of objects simultaneously in use
+    std::size_t n_peak() const {
+        return n_peak_;
+    }
+    std::size_t bytes() const {
+        return slabs_.size() * slab_size_ * sizeof(Slot);
+    }
+
+  private:
+    union Slot {
+        Slot* next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type obj;
+    };
+
+    void next_slab() {
+        if (nslab_used_ == slabs_.size()) {
+            slabs_.push_back(static_cast<Slot*>(::operator new(slab_size_ * sizeof(Slot))));
+        }
+        bump_ = slabs_[nslab_used_++];
+        end_ = bump_ + slab_size_;
+    }
+
+    std::size_t slab_size_;
+    std::vector<Slot*> slabs_;
+    std::size_t nslab_used_ = 0;
+    Slot* bump_ = nullptr;
+    Slot* end_ = nullptr;
+    Slot* free_ = nullptr;
+    std::size_t n_alloc_ = 0;
+    std::size_t n_in_use_ = 0;
+    std::size_t n_peak_ = 0;
+};
+
+}  // namespace coreneuron
@@ -0,0 +1,48 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include "coreneuron/utils/profile/profiler_interface.h"
+
+namespace coreneuron {
+namespace Instrumentor {
+
+mech_phase_names::names_t& mech_phase_names::names() {
+    static names_t names_;
+    return names_;
+}
+
+const char* mech_phase_names::prefix(mech_phase kind) {
+    switch (kind) {
+        case mech_phase::net_receive:
+            return "net-receive-";
+        case mech_phase::net_buf_receive:
+            return "net-buf-receive-";
+        case mech_phase::cur:
+            return "cur-";
+        case mech_phase::state:
+            return "state-";
+        default:
+            return "";
+    }
+}
+
+void mech_phase_names::register_mechanism(int type, const char* mechname) {
+    if (type < 0 || !mechname) {
+        return;
+    }
+    auto& n = names();
+    if (static_cast<std::size_t>(type) >= n.size()) {
+        n.resize(type + 1);
+    }
+    for (std::size_t k = 0; k < static_cast<std::size_t>(mech_phase::count); ++k) {
+        n[type][k] = std::string(prefix(static_cast<mech_phase>(k))) + mechname;
+    }
+}
+
+}  // namespace Instrumentor
+}  // namespace coreneuron
@@ -8,8 +8,11 @@
 
 #pragma once
 
+#include <array>
 #include <initializer_list>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 #if defined(CORENEURON_CALIPER)
 #include <caliper/cali.h>
@@ -286,12 +289,50 @@ using InstrumentorImpl = detail::Instrumentor<
 }  // namespace detail
 
 namespace Instrumentor {
+/*! \enum mech_phase
+ *  \brief Kinds of per-mechanism phases, see mech_phase_names.
+ */
+enum class mech_phase : std::size_t { net_receive = 0, net_buf_receive, cur, state, count };
+
+/*! \class mech_phase_names
+ *  \brief Registry of the per-mechanism phase names.
+ *
+ *  Phase names like "cur-hh" or "net-receive-ExpSyn" are built once when
+ *  the mechanism is registered instead of being concatenated into a
+ *  std::string every time an event is delivered or a mechanism function
+ *  is called in the timestep loop.
+ */
+class mech_phase_names {
+  public:
+    /// Build the names of all mech_phase kinds of mechanism type
+    static void register_mechanism(int type, const char* mechname);
+
+    /// Precomputed name, or the bare prefix if type was never registered
+    static const char* get(mech_phase kind, int type) {
+        const auto& n = names();
+        if (type >= 0 && static_cast<std::size_t>(type) < n.size() &&
+            !n[type][static_cast<std::size_t>(kind)].empty()) {
+            return n[type][static_cast<std::size_t>(kind)].c_str();
+        }
+        return prefix(kind);
+    }
+
+  private:
+    static constexpr std::size_t nkind = static_cast<std::size_t>(mech_phase::count);
+    using names_t = std::vector<std::array<std::string, nkind>>;
+    static names_t& names();
+    static const char* prefix(mech_phase kind);
+};
+
 struct phase {
     const char* phase_name;
     phase(const char* name)
         : phase_name(name) {
         detail::InstrumentorImpl::phase_begin(phase_name);
     }
+    /// Phase of mechanism type using the name precomputed at registration
+    phase(mech_phase kind, int type)
+        : phase(mech_phase_names::get(kind, type)) {}
     ~phase() {
         detail::InstrumentorImpl::phase_end(phase_name);
     }
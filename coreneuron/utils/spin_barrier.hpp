@@ -0,0 +1,72 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+namespace coreneuron {
+
+/// Busy wait until done() is true, yielding after a while
+template <typename Done>
+void spin_until(Done&& done) {
+    constexpr int spin_count = 4096;
+    for (int i = 0; !done(); ++i) {
+        if (i >= spin_count) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * Sense-reversing barrier for the threads of a persistent parallel region
+ *
+ * One of the threads is the master: it waits for all the others, runs the
+ * serial part of the barrier (e.g. MPI calls, which must be made by the
+ * master thread) and then releases them by flipping the shared sense. The
+ * other threads only increment a counter and spin on the sense, so a barrier
+ * costs one atomic increment per thread and no system call.
+ */
+class SpinBarrier {
+  public:
+    explicit SpinBarrier(int nthread)
+        : nthread_(nthread) {}
+
+    SpinBarrier(const SpinBarrier&) = delete;
+    SpinBarrier& operator=(const SpinBarrier&) = delete;
+
+    /**
+     * Wait until all the threads reached the barrier. local_sense belongs
+     * to the calling thread and must be false before its first wait.
+     */
+    template <typename F>
+    void wait(bool& local_sense, bool master, F&& serial) {
+        local_sense = !local_sense;
+        if (master) {
+            spin_until([this] { return arrived_.load(std::memory_order_acquire) == nthread_ - 1; });
+            arrived_.store(0, std::memory_order_relaxed);
+            serial();
+            sense_.store(local_sense, std::memory_order_release);
+        } else {
+            arrived_.fetch_add(1, std::memory_order_acq_rel);
+            spin_until([&] { return sense_.load(std::memory_order_acquire) == local_sense; });
+        }
+    }
+
+    void wait(bool& local_sense, bool master) {
+        wait(local_sense, master, [] {});
+    }
+
+  private:
+    const int nthread_;
+    std::atomic<int> arrived_{0};
+    std::atomic<bool> sense_{false};
+};
+
+}  // namespace coreneuron
@@ -0,0 +1,150 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#if defined(__linux__)
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include "coreneuron/utils/thread_affinity.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/mpi/core/nrnmpi.hpp"
+
+namespace coreneuron {
+
+/// cpus of the rank once its threads are pinned
+static std::vector<int> rank_cpus;
+
+#if defined(__linux__)
+static std::vector<int> thread_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t mask;
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &mask)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+static bool set_thread_cpus(const std::vector<int>& cpus) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int cpu: cpus) {
+        CPU_SET(cpu, &mask);
+    }
+    return sched_setaffinity(0, sizeof(mask), &mask) == 0;
+}
+#endif
+
+std::vector<int> pin_omp_threads(int local_rank, int local_size) {
+    std::vector<int> placement;
+#if defined(__linux__) && defined(_OPENMP)
+    std::vector<int> cpus = thread_cpus();
+    // not bound by the launcher: share the cpus of the node among its ranks
+    long nonline = sysconf(_SC_NPROCESSORS_ONLN);
+    if (local_size > 1 && static_cast<long>(cpus.size()) == nonline &&
+        static_cast<int>(cpus.size()) >= local_size) {
+        int share = cpus.size() / local_size;
+        cpus = std::vector<int>(cpus.begin() + local_rank * share,
+                                cpus.begin() + (local_rank + 1) * share);
+    }
+    if (cpus.empty()) {
+        return placement;
+    }
+    rank_cpus = cpus;
+    placement.resize(omp_get_max_threads(), -1);
+    // clang-format off
+
+    #pragma omp parallel shared(placement, cpus)
+    // clang-format on
+    {
+        int id = omp_get_thread_num();
+        int cpu = cpus[id % cpus.size()];
+        if (set_thread_cpus({cpu})) {
+            placement[id] = cpu;
+        }
+    }
+#else
+    (void) local_rank;
+    (void) local_size;
+#endif
+    return placement;
+}
+
+RankAffinityScope::RankAffinityScope(bool widen) {
+#if defined(__linux__)
+    if (!widen || rank_cpus.empty()) {
+        return;
+    }
+    saved = thread_cpus();
+    if (saved == rank_cpus || !set_thread_cpus(rank_cpus)) {
+        saved.clear();
+    }
+#else
+    (void) widen;
+#endif
+}
+
+RankAffinityScope::~RankAffinityScope() {
+#if defined(__linux__)
+    if (!saved.empty()) {
+        set_thread_cpus(saved);
+    }
+#endif
+}
+
+int cpu_numa_node(int cpu) {
+#if defined(__linux__)
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        return -1;
+    }
+    int node = -1;
+    while (dirent* entry = readdir(dir)) {
+        if (sscanf(entry->d_name, "node%d", &node) == 1) {
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+#else
+    (void) cpu;
+    return -1;
+#endif
+}
+
+void report_thread_placement(const std::vector<int>& cpus) {
+    if (nrnmpi_myid != 0) {
+        return;
+    }
+    if (cpus.empty()) {
+        printf(" WARNING : --pin-threads is not supported on this platform, threads not pinned.\n");
+        return;
+    }
+    printf("\n Thread placement (rank 0)\n");
+    for (std::size_t i = 0; i < cpus.size(); ++i) {
+        if (cpus[i] < 0) {
+            printf(" Thread %zu: not pinned\n", i);
+        } else {
+            printf(" Thread %zu: cpu %d, NUMA node %d\n", i, cpus[i], cpu_numa_node(cpus[i]));
+        }
+    }
+}
+
+}  // namespace coreneuron
@@ -0,0 +1,56 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+namespace coreneuron {
+
+/**
+ * Pin the OpenMP threads of the rank to one cpu each (--pin-threads)
+ *
+ * The cpus are taken in order from the affinity mask of the process. If
+ * the mask holds all the cpus of the node and several ranks share the node,
+ * each rank takes its own contiguous share of them. Pinning happens before
+ * the model is read, so that the data of a NrnThread, first touched by the
+ * thread that integrates it, stays on the NUMA node of that thread.
+ *
+ * @return the cpu of each OpenMP thread, empty if pinning is not supported
+ */
+std::vector<int> pin_omp_threads(int local_rank, int local_size);
+
+/**
+ * Widen the affinity of the calling thread to all the cpus of the rank, as
+ * chosen by pin_omp_threads, until the end of the scope. No-op when the
+ * threads are not pinned.
+ *
+ * Threads created by a pinned thread inherit its single cpu. The setup
+ * worker pool, which can be larger than the OpenMP team, and the nested
+ * workers of Phase2::populate run their work in this scope so that they
+ * spread over the cpus of the rank. With widen false, e.g. when the nested
+ * region runs serially on the pinned thread, the affinity is left as is.
+ */
+class RankAffinityScope {
+  public:
+    explicit RankAffinityScope(bool widen = true);
+    ~RankAffinityScope();
+    RankAffinityScope(const RankAffinityScope&) = delete;
+    RankAffinityScope& operator=(const RankAffinityScope&) = delete;
+
+  private:
+    std::vector<int> saved;  /// cpus of the thread before the scope, empty if unchanged
+};
+
+/// NUMA node of a cpu, -1 if unknown
+int cpu_numa_node(int cpu);
+
+/// Print the cpu and NUMA node of the threads of rank 0
+void report_thread_placement(const std::vector<int>& cpus);
+
+}  // namespace coreneuron
@@ -0,0 +1,81 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#define BOOST_TEST_MODULE BuiltinReportTest
+#define BOOST_TEST_MAIN
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "coreneuron/io/reports/builtin_report.hpp"
+#include "coreneuron/io/reports/report_file.hpp"
+
+using namespace coreneuron;
+
+// Record a report over several flush intervals, as the simulation would, and
+// read it back. Gid 7 has two elements, gid 3 one, added out of gid order.
+BOOST_AUTO_TEST_CASE(write_and_read_back) {
+    const std::string name = "builtin_report_test";
+    const double dt = 0.025;
+    const double report_dt = 0.1;
+    const int steps_per_row = 4;
+    const int min_steps = 5;  // rows per flush interval
+    const int nrow = 50;
+    double v[3] = {};
+    builtin_report_create(name, dt, 0., nrow * report_dt, report_dt, 4);
+    builtin_report_add_var(name, 7, 10, &v[0]);
+    builtin_report_add_var(name, 3, 0, &v[1]);
+    builtin_report_add_var(name, 7, 11, &v[2]);
+    builtin_report_set_buffer_size_hint(0);  // smallest chunks, min_steps + 2 rows
+    builtin_report_setup(min_steps);
+
+    const int gids[2] = {7, 3};
+    const int interval = min_steps * steps_per_row;
+    for (int step = 0; step <= nrow * steps_per_row; ++step) {
+        v[0] = step;
+        v[1] = -step;
+        v[2] = 0.5 * step;
+        builtin_report_record(step, 2, gids, name);
+        if ((step + 1) % interval == 0) {
+            builtin_report_end_iteration((step + 1) * dt);
+        }
+    }
+    builtin_report_flush(nrow * report_dt);
+
+    FILE* f = fopen((name + ".rpt").c_str(), "rb");
+    BOOST_REQUIRE(f);
+    ReportFileLayout layout;
+    BOOST_REQUIRE(read_report_file_layout(f, layout));
+    BOOST_CHECK_EQUAL(layout.header.nrow, nrow);
+    BOOST_CHECK_EQUAL(layout.header.ncol, 3);
+    BOOST_CHECK_EQUAL(layout.header.chunk_rows, min_steps + 2);
+    BOOST_CHECK_EQUAL(layout.columns[0].gid, 3);
+    BOOST_CHECK_EQUAL(layout.columns[1].gid, 7);
+    BOOST_CHECK_EQUAL(layout.columns[1].id, 10);
+    BOOST_CHECK_EQUAL(layout.columns[2].id, 11);
+
+    std::vector<float> values;
+    int row = 0;
+    for (std::uint64_t c = 0; c < report_nchunk(layout.header); ++c) {
+        long n = read_report_chunk(f, layout, c, values);
+        BOOST_REQUIRE_GT(n, 0);
+        for (long r = 0; r < n; ++r, ++row) {
+            int step = row * steps_per_row;
+            BOOST_CHECK_EQUAL(values[r * 3 + 0], -step);
+            BOOST_CHECK_EQUAL(values[r * 3 + 1], step);
+            BOOST_CHECK_EQUAL(values[r * 3 + 2], 0.5f * step);
+        }
+    }
+    BOOST_CHECK_EQUAL(row, nrow);
+    BOOST_CHECK_EQUAL(fgetc(f), EOF);
+    fclose(f);
+    remove((name + ".rpt").c_str());
+}
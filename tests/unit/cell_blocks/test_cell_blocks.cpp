@@ -0,0 +1,313 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#define BOOST_TEST_MODULE cell_blocks
+#define BOOST_TEST_MAIN
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "coreneuron/coreneuron.hpp"
+#include "coreneuron/nrniv/nrniv_decl.h"
+#include "coreneuron/permute/cellorder.hpp"
+#include "coreneuron/sim/cell_blocks.hpp"
+#include "coreneuron/sim/multicore.hpp"
+
+using namespace coreneuron;
+
+namespace {
+/// Channel of the test on every node: one gate m, i = gbar * m * (v - e)
+constexpr int channel_type = CAP + 1;
+enum ChannelParam { gbar, e, m, i, g, channel_nparam };
+
+double& param(Memb_list* ml, int iml, int ip) {
+    return ml->data[iml + ip * ml->_nodecount_padded];
+}
+
+void channel_cur(NrnThread* nt, Memb_list* ml, int) {
+    const int* ni = ml->nodeindices;
+    for (int iml = 0; iml < ml->nodecount; ++iml) {
+        double gm = param(ml, iml, gbar) * param(ml, iml, m);
+        param(ml, iml, g) = gm;
+        param(ml, iml, i) = gm * (nt->_actual_v[ni[iml]] - param(ml, iml, e));
+        nt->_actual_rhs[ni[iml]] -= param(ml, iml, i);
+    }
+}
+
+void channel_jacob(NrnThread* nt, Memb_list* ml, int) {
+    const int* ni = ml->nodeindices;
+    for (int iml = 0; iml < ml->nodecount; ++iml) {
+        nt->_actual_d[ni[iml]] += param(ml, iml, g);
+    }
+}
+
+void channel_state(NrnThread* nt, Memb_list* ml, int) {
+    const int* ni = ml->nodeindices;
+    for (int iml = 0; iml < ml->nodecount; ++iml) {
+        double minf = 1.0 / (1.0 + std::exp(-(nt->_actual_v[ni[iml]] + 40.0) / 5.0));
+        param(ml, iml, m) += (minf - param(ml, iml, m)) * (1.0 - std::exp(-nt->_dt));
+    }
+}
+
+void register_test_mechanisms() {
+    int n = channel_type + 1;
+    corenrn.get_memb_funcs().resize(n);
+    corenrn.get_memb_func(channel_type).current = channel_cur;
+    corenrn.get_memb_func(channel_type).jacob = channel_jacob;
+    corenrn.get_memb_func(channel_type).state = channel_state;
+    corenrn.get_prop_param_size().resize(n, 0);
+    corenrn.get_prop_param_size()[CAP] = 2;  // cm, i_cap
+    corenrn.get_prop_param_size()[channel_type] = channel_nparam;
+    corenrn.get_prop_dparam_size().resize(n, 0);
+    corenrn.get_mech_data_layout().resize(n, Layout::SoA);
+    corenrn.get_is_artificial().resize(n, false);
+}
+
+/// Node and mechanism data of ncell cells, capacitance and the channel on every node
+struct Model {
+    int ncell;
+    std::vector<int> parent;
+    std::vector<double> v, rhs, d, a, b, area;
+    std::vector<int> nodes;
+    int padded;
+    std::vector<double> cap, channel;
+};
+
+/// Cells of min_size to max_size nodes, the nodes of a cell after their parent
+Model make_model(int ncell, int min_size, int max_size, bool interleave_cells) {
+    std::mt19937 gen(1234);
+    std::vector<int> size(ncell);
+    for (auto& s: size) {
+        s = std::uniform_int_distribution<int>(min_size, max_size)(gen);
+    }
+    Model model;
+    model.ncell = ncell;
+    model.parent.assign(ncell, 0);
+    std::vector<int> last(ncell);
+    for (int c = 0; c < ncell; ++c) {
+        last[c] = c;
+    }
+    auto add_node = [&](int c) {
+        // mostly unbranched sections
+        int p = std::bernoulli_distribution(0.8)(gen) ? last[c] : c;
+        last[c] = model.parent.size();
+        model.parent.push_back(p);
+    };
+    if (interleave_cells) {
+        // one node of each cell in turn, like a breadth first order over the cells
+        for (int k = 1; k < max_size; ++k) {
+            for (int c = 0; c < ncell; ++c) {
+                if (k < size[c]) {
+                    add_node(c);
+                }
+            }
+        }
+    } else {
+        for (int c = 0; c < ncell; ++c) {
+            for (int k = 1; k < size[c]; ++k) {
+                add_node(c);
+            }
+        }
+    }
+    int nnode = model.parent.size();
+    std::uniform_real_distribution<double> off(-1.0, -0.1);
+    std::uniform_real_distribution<double> voltage(-70.0, -50.0);
+    for (int i = 0; i < nnode; ++i) {
+        model.v.push_back(voltage(gen));
+        model.a.push_back(off(gen));
+        model.b.push_back(off(gen));
+        model.area.push_back(100.0);
+        model.nodes.push_back(i);
+    }
+    model.rhs.assign(nnode, 0.0);
+    model.d.assign(nnode, 0.0);
+    model.padded = (nnode + 7) / 8 * 8;
+    model.cap.assign(2 * model.padded, 1.0);
+    model.channel.assign(channel_nparam * model.padded, 0.0);
+    for (int iml = 0; iml < nnode; ++iml) {
+        model.channel[iml + gbar * model.padded] = 0.01;
+        model.channel[iml + e * model.padded] = 50.0;
+        model.channel[iml + m * model.padded] = 0.05;
+    }
+    return model;
+}
+
+/// NrnThread over the data of a model, tml and ml are owned by the caller
+void set_thread(NrnThread& nt,
+                Model& model,
+                Memb_list (&ml)[2],
+                NrnThreadMembList (&tml)[2],
+                double dt) {
+    nt.id = 0;
+    nt.ncell = model.ncell;
+    nt.end = model.parent.size();
+    nt._dt = dt;
+    nt.cj = 1.0 / dt;
+    nt._v_parent_index = model.parent.data();
+    nt._actual_v = model.v.data();
+    nt._actual_rhs = model.rhs.data();
+    nt._actual_d = model.d.data();
+    nt._actual_a = model.a.data();
+    nt._actual_b = model.b.data();
+    nt._actual_area = model.area.data();
+    std::fill(std::begin(nt.tbl), std::end(nt.tbl), nullptr);
+    double* data[2] = {model.cap.data(), model.channel.data()};
+    int type[2] = {CAP, channel_type};
+    for (int k = 0; k < 2; ++k) {
+        ml[k] = Memb_list{};
+        ml[k].nodeindices = model.nodes.data();
+        ml[k].data = data[k];
+        ml[k].nodecount = nt.end;
+        ml[k]._nodecount_padded = model.padded;
+        tml[k].ml = &ml[k];
+        tml[k].index = type[k];
+        tml[k].next = k == 0 ? &tml[1] : nullptr;
+    }
+    nt.tml = &tml[0];
+}
+
+/// Fixed step of nrn_fixed_step_thread and nrn_fixed_step_lastpart, without events
+void whole_step(NrnThread& nt) {
+    nt._t += 0.5 * nt._dt;
+    setup_tree_matrix_minimal(&nt);
+    nrn_solve_minimal(&nt);
+    update(&nt);
+    nt._t += 0.5 * nt._dt;
+    nonvint(&nt);
+}
+
+void blocked_step(NrnThread& nt) {
+    nt._t += 0.5 * nt._dt;
+    nrn_fixed_step_cell_blocks(&nt);
+    nt._t += 0.5 * nt._dt;
+}
+
+/// Bytes of the node and mechanism arrays of a model
+double model_bytes(const Model& model) {
+    double node = model.parent.size() * (6 * sizeof(double) + 2 * sizeof(int));
+    return node + (model.cap.size() + model.channel.size()) * sizeof(double);
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(partition) {
+    std::vector<std::size_t> cell_bytes{100, 100, 300, 50, 600};
+    BOOST_CHECK((nrn_cell_block_partition(cell_bytes, 250) == std::vector<int>{0, 2, 3, 4, 5}));
+    BOOST_CHECK((nrn_cell_block_partition(cell_bytes, 10000) == std::vector<int>{0, 5}));
+    BOOST_CHECK((nrn_cell_block_partition({}, 250) == std::vector<int>{0}));
+}
+
+BOOST_AUTO_TEST_CASE(contiguous_order) {
+    Model contiguous = make_model(50, 2, 20, false);
+    BOOST_CHECK(cell_contiguous_order(50, contiguous.parent.size(), contiguous.parent.data()) ==
+                nullptr);
+
+    Model model = make_model(50, 2, 20, true);
+    const int nnode = model.parent.size();
+    int* order = cell_contiguous_order(model.ncell, nnode, model.parent.data());
+    BOOST_REQUIRE(order != nullptr);
+    std::vector<int> cell(nnode), new_cell(nnode, -1), new_parent(nnode, -1);
+    for (int i = 0; i < nnode; ++i) {
+        cell[i] = i < model.ncell ? i : cell[model.parent[i]];
+        new_cell[order[i]] = cell[i];
+        new_parent[order[i]] = i < model.ncell ? -1 : order[model.parent[i]];
+    }
+    for (int i = 0; i < model.ncell; ++i) {
+        BOOST_CHECK_EQUAL(order[i], i);
+    }
+    for (int i = model.ncell; i < nnode; ++i) {
+        BOOST_CHECK(new_parent[i] < i);
+        BOOST_CHECK_EQUAL(new_cell[i], new_cell[new_parent[i]]);
+        if (i > model.ncell) {
+            BOOST_CHECK(new_cell[i] >= new_cell[i - 1]);
+        }
+    }
+    delete[] order;
+}
+
+BOOST_AUTO_TEST_CASE(blocked_step_matches_whole_step) {
+    register_test_mechanisms();
+    const double dt = 0.025;
+    Model model = make_model(200, 5, 60, false);
+    Model whole = model;
+    Model blocked = model;
+    Memb_list ml[2];
+    NrnThreadMembList tml[2];
+    NrnThread nt;
+    nrn_threads = &nt;
+    nrn_nthread = 1;
+
+    set_thread(nt, whole, ml, tml, dt);
+    for (int step = 0; step < 20; ++step) {
+        whole_step(nt);
+    }
+
+    // small blocks, most of the cells get a block of their own
+    set_thread(nt, blocked, ml, tml, dt);
+    nrn_cell_blocks_setup(4 * 1024);
+    BOOST_REQUIRE(nrn_cell_blocks_active(&nt));
+    for (int step = 0; step < 20; ++step) {
+        blocked_step(nt);
+    }
+    nrn_cell_blocks_cleanup();
+
+    for (size_t i = 0; i < model.v.size(); ++i) {
+        BOOST_CHECK_CLOSE(blocked.v[i], whole.v[i], 1e-10);
+        BOOST_CHECK_CLOSE(blocked.channel[i + m * model.padded],
+                          whole.channel[i + m * model.padded],
+                          1e-10);
+    }
+    nrn_threads = nullptr;
+    nrn_nthread = 0;
+}
+
+BOOST_AUTO_TEST_CASE(bandwidth) {
+    register_test_mechanisms();
+    const double dt = 0.025;
+    const int nstep = 10;
+    // well beyond the last level cache: about 45 MB of node and mechanism data
+    Model model = make_model(4000, 50, 150, false);
+    Memb_list ml[2];
+    NrnThreadMembList tml[2];
+    NrnThread nt;
+    nrn_threads = &nt;
+    nrn_nthread = 1;
+    set_thread(nt, model, ml, tml, dt);
+
+    auto seconds_per_step = [&](void (*step)(NrnThread&)) {
+        step(nt);  // warm up
+        auto start = std::chrono::steady_clock::now();
+        for (int k = 0; k < nstep; ++k) {
+            step(nt);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() /
+               nstep;
+    };
+    double bytes = model_bytes(model);
+    double twhole = seconds_per_step(whole_step);
+    std::clog << model.parent.size() << " nodes, " << bytes / 1e6 << " MB: whole thread "
+              << twhole * 1e3 << " ms per step (" << bytes / twhole / 1e9 << " GB/s)\n";
+    for (std::size_t block_bytes: {nrn_cell_block_default_bytes(), std::size_t{4} << 20}) {
+        nrn_cell_blocks_setup(block_bytes);
+        BOOST_REQUIRE(nrn_cell_blocks_active(&nt));
+        double tblocked = seconds_per_step(blocked_step);
+        std::clog << "  cell blocks of " << block_bytes / 1024 << " KiB: " << tblocked * 1e3
+                  << " ms per step (" << bytes / tblocked / 1e9 << " GB/s)\n";
+        nrn_cell_blocks_cleanup();
+    }
+    BOOST_CHECK(std::all_of(model.v.begin(), model.v.end(), [](double v) {
+        return std::isfinite(v);
+    }));
+    nrn_threads = nullptr;
+    nrn_nthread = 0;
+}
@@ -42,8 +42,26 @@ BOOST_AUTO_TEST_CASE(cmdline_interface) {
         "--voltage",
         "-32",
 
+        "--mmap",
+
         "--threading",
 
+        "--overlap-gap-transfer",
+
+        "--persistent-threads",
+
+        "--dynamic-threads",
+
+        "--pin-threads",
+
+        "--setup-threads",
+        "6",
+
+        "--cell-blocks",
+
+        "--cell-block-size",
+        "256",
+
         "--ms-phases",
         "1",
 
@@ -52,11 +70,20 @@ BOOST_AUTO_TEST_CASE(cmdline_interface) {
 
         "--multisend",
 
+        "--overlap-exchange",
+
+        "--sparse-exchange",
+
+        "--adaptive-spikebuf",
+
         "--spkcompress",
         "32",
 
         "--binqueue",
 
+        "--event-queue",
+        "calendar",
+
         "--spikebuf",
         "100",
 
@@ -72,6 +99,15 @@ BOOST_AUTO_TEST_CASE(cmdline_interface) {
         "--mindelay",
         "0.1",
 
+        "--lfp-cutoff",
+        "0.01",
+
+        "--spikes-format",
+        "binary",
+
+        "--spikes-flush",
+        "4",
+
         "--dt_io",
         "0.2"};
 
@@ -93,6 +129,20 @@ BOOST_AUTO_TEST_CASE(cmdline_interface) {
 
     BOOST_CHECK(corenrn_param_test.threading == true);
 
+    BOOST_CHECK(corenrn_param_test.overlap_gap_transfer == true);
+
+    BOOST_CHECK(corenrn_param_test.persistent_threads == true);
+
+    BOOST_CHECK(corenrn_param_test.dynamic_threads == true);
+
+    BOOST_CHECK(corenrn_param_test.pin_threads == true);
+
+    BOOST_CHECK(corenrn_param_test.setup_threads == 6);
+
+    BOOST_CHECK(corenrn_param_test.cell_blocks == true);
+
+    BOOST_CHECK(corenrn_param_test.cell_block_size == 256);
+
     BOOST_CHECK(corenrn_param_test.dt == 0.02);
 
     BOOST_CHECK(corenrn_param_test.tstop == 0.1);
@@ -113,17 +163,33 @@ BOOST_AUTO_TEST_CASE(cmdline_interface) {
 
     BOOST_CHECK(corenrn_param_test.voltage == -32);
 
+    BOOST_CHECK(corenrn_param_test.mmap_read == true);
+
     BOOST_CHECK(corenrn_param_test.nwarp == 8);
 
     BOOST_CHECK(corenrn_param_test.multisend == true);
 
+    BOOST_CHECK(corenrn_param_test.overlap_exchange == true);
+
+    BOOST_CHECK(corenrn_param_test.sparse_exchange == true);
+
+    BOOST_CHECK(corenrn_param_test.adaptive_spikebuf == true);
+
     BOOST_CHECK(corenrn_param_test.mindelay == 0.1);
 
+    BOOST_CHECK(corenrn_param_test.lfp_cutoff == 0.01);
+
     BOOST_CHECK(corenrn_param_test.ms_phases == 1);
 
     BOOST_CHECK(corenrn_param_test.ms_subint == 2);
 
     BOOST_CHECK(corenrn_param_test.spkcompress == 32);
 
+    BOOST_CHECK(corenrn_param_test.event_queue == "calendar");
+
+    BOOST_CHECK(corenrn_param_test.spikes_format == "binary");
+
+    BOOST_CHECK(corenrn_param_test.spikes_flush == 4);
+
     BOOST_CHECK(corenrn_param_test.multisend == true);
 }
@@ -0,0 +1,123 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#define BOOST_TEST_MODULE Gid2InTableTest
+#define BOOST_TEST_MAIN
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "coreneuron/network/gid2in_table.hpp"
+
+using namespace coreneuron;
+
+// The table never dereferences the InputPreSyn pointers, fake ones are enough.
+static InputPreSyn* fake_ps(int gid) {
+    return reinterpret_cast<InputPreSyn*>(static_cast<std::uintptr_t>(gid + 1) * 16);
+}
+
+// Random sparse gid set out of a much larger global gid range, like the
+// InputPreSyn of one rank in a large network.
+static std::map<int, InputPreSyn*> make_gid2in(int ngid, int gidmax, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(0, gidmax);
+    std::map<int, InputPreSyn*> gid2in;
+    while (gid2in.size() < static_cast<size_t>(ngid)) {
+        int gid = dist(gen);
+        gid2in[gid] = fake_ps(gid);
+    }
+    return gid2in;
+}
+
+BOOST_AUTO_TEST_CASE(gid2in_table_empty) {
+    Gid2InTable table;
+    BOOST_CHECK(table.find(0) == nullptr);
+    table.build(std::map<int, InputPreSyn*>{});
+    BOOST_CHECK(table.size() == 0);
+    BOOST_CHECK(table.find(0) == nullptr);
+    BOOST_CHECK(table.find(12345) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(gid2in_table_matches_map) {
+    const int gidmax = 10'000'000;
+    auto gid2in = make_gid2in(50'000, gidmax, 1);
+    Gid2InTable table;
+    table.build(gid2in);
+    BOOST_CHECK(table.size() == gid2in.size());
+
+    for (const auto& g: gid2in) {
+        BOOST_CHECK(table.find(g.first) == g.second);
+    }
+    // consecutive gids are the worst case for naive modulo hashing
+    for (int gid = 0; gid < 100'000; ++gid) {
+        auto it = gid2in.find(gid);
+        InputPreSyn* expected = (it == gid2in.end()) ? nullptr : it->second;
+        BOOST_CHECK(table.find(gid) == expected);
+    }
+
+    table.clear();
+    BOOST_CHECK(table.size() == 0);
+    BOOST_CHECK(table.find(gid2in.begin()->first) == nullptr);
+}
+
+// Microbenchmark: lookups per second of std::map versus the flat table for
+// a realistic mix of received spikes (most gids received are wanted).
+BOOST_AUTO_TEST_CASE(gid2in_table_lookup_rate) {
+    const int gidmax = 100'000'000;
+    const int nlookup = 2'000'000;
+    for (int ngid: {10'000, 100'000, 1'000'000}) {
+        auto gid2in = make_gid2in(ngid, gidmax, 2);
+        Gid2InTable table;
+        table.build(gid2in);
+
+        std::vector<int> keys;
+        keys.reserve(gid2in.size());
+        for (const auto& g: gid2in) {
+            keys.push_back(g.first);
+        }
+        std::mt19937 gen(3);
+        std::uniform_int_distribution<int> pick(0, ngid - 1);
+        std::uniform_int_distribution<int> any(0, gidmax);
+        std::vector<int> spikes(nlookup);
+        for (auto& s: spikes) {
+            s = (gen() % 4) ? keys[pick(gen)] : any(gen);
+        }
+
+        using clock = std::chrono::steady_clock;
+        std::uintptr_t check_map = 0, check_table = 0;
+
+        auto t0 = clock::now();
+        for (int gid: spikes) {
+            auto it = gid2in.find(gid);
+            if (it != gid2in.end()) {
+                check_map += reinterpret_cast<std::uintptr_t>(it->second);
+            }
+        }
+        auto t1 = clock::now();
+        for (int gid: spikes) {
+            InputPreSyn* ps = table.find(gid);
+            if (ps) {
+                check_table += reinterpret_cast<std::uintptr_t>(ps);
+            }
+        }
+        auto t2 = clock::now();
+        BOOST_CHECK(check_map == check_table);
+
+        double tmap = std::chrono::duration<double>(t1 - t0).count();
+        double ttable = std::chrono::duration<double>(t2 - t1).count();
+        std::cout << "gid2in ngid=" << ngid << " std::map " << nlookup / tmap
+                  << " lookups/s, Gid2InTable " << nlookup / ttable << " lookups/s ("
+                  << table.bytes() << " bytes)" << std::endl;
+    }
+}
@@ -1,12 +1,20 @@
 #define BOOST_TEST_MODULE LFPTest
 #define BOOST_TEST_MAIN
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <random>
 
 #include <boost/test/unit_test.hpp>
 
 #include "coreneuron/io/lfp.hpp"
+#include "coreneuron/io/reports/builtin_report.hpp"
+#include "coreneuron/io/reports/lfp_report.hpp"
+#include "coreneuron/io/reports/report_file.hpp"
 #include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/mpi/core/nrnmpi.hpp"
 
 using namespace coreneuron;
 using namespace coreneuron::lfputils;
@@ -101,3 +109,153 @@ BOOST_AUTO_TEST_CASE(LFP_PointSource_LineSource) {
     nrnmpi_finalize();
 #endif
 }
+
+// Segments scattered in a 1mm cube, recorded by a column of electrodes. The
+// sparse calculator must drop the far away segments, and its error is bounded
+// by the dropped coefficients.
+BOOST_AUTO_TEST_CASE(LFP_sparse_vs_dense) {
+    pi = 3.141592653589;
+    const int nsegment = 20000;
+    const int nelectrode = 63;  // not a multiple of the dense block size
+    const double cutoff = 0.1;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> pos(0.0, 1000.0);
+    std::uniform_real_distribution<double> dir(-5.0, 5.0);
+    std::uniform_real_distribution<double> current(-1.0, 1.0);
+    Point3Ds seg_start(nsegment), seg_end(nsegment);
+    std::vector<double> radii(nsegment, 1.0);
+    std::vector<int> indices(nsegment);
+    std::vector<double> currents(nsegment);
+    for (int l = 0; l < nsegment; ++l) {
+        seg_start[l] = {pos(gen), pos(gen), pos(gen)};
+        seg_end[l] = paxpy(seg_start[l], 1.0, {dir(gen), dir(gen), dir(gen)});
+        indices[l] = nsegment - 1 - l;
+        currents[l] = current(gen);
+    }
+    Point3Ds electrodes(nelectrode);
+    for (int k = 0; k < nelectrode; ++k) {
+        electrodes[k] = {500.0, 500.0, 1000.0 * k / nelectrode};
+    }
+
+    auto time = [](auto&& f) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    const int nrep = 20;
+    LFPCalculator<LineSource> dense(seg_start, seg_end, radii, indices, electrodes, 1.0);
+    LFPCalculator<LineSource> sparse(seg_start, seg_end, radii, indices, electrodes, 1.0, cutoff);
+    BOOST_REQUIRE(!dense.is_sparse());
+    BOOST_REQUIRE(sparse.is_sparse());
+    double tdense = time([&] {
+        for (int i = 0; i < nrep; ++i) {
+            dense.lfp(currents);
+        }
+    });
+    double tsparse = time([&] {
+        for (int i = 0; i < nrep; ++i) {
+            sparse.lfp(currents);
+        }
+    });
+    std::clog << "LFP " << nelectrode << " electrodes x " << nsegment << " segments\n"
+              << "  dense:  " << dense.memory_usage() / 1024 << " KiB, " << tdense / nrep * 1e3
+              << " ms per call\n"
+              << "  sparse: " << sparse.memory_usage() / 1024 << " KiB, " << tsparse / nrep * 1e3
+              << " ms per call, " << sparse.ncoefficients() << " coefficients kept (cutoff "
+              << cutoff << ")\n";
+    BOOST_CHECK_EQUAL(dense.ncoefficients(), nelectrode * nsegment);
+    BOOST_CHECK_LT(sparse.memory_usage(), dense.memory_usage());
+
+    // reference: the former dense double loop, and the bound on the dropped coefficients
+    const double f = 1.0 / (4.0 * pi);
+    for (int k = 0; k < nelectrode; ++k) {
+        std::vector<double> m(nsegment);
+        double ref = 0.0, max_coef = 0.0;
+        for (int l = 0; l < nsegment; ++l) {
+            m[l] = line_source_lfp_factor(electrodes[k], seg_start[l], seg_end[l], radii[l], f);
+            ref += m[l] * currents[indices[l]];
+            max_coef = std::max(max_coef, m[l]);
+        }
+        double dropped = 0.0;
+        for (int l = 0; l < nsegment; ++l) {
+            if (m[l] < cutoff * max_coef) {
+                dropped += m[l] * std::abs(currents[indices[l]]);
+            }
+        }
+        BOOST_CHECK_CLOSE(dense.lfp_values()[k], ref, 1.0e-8);
+        BOOST_CHECK_LE(std::abs(sparse.lfp_values()[k] - ref), dropped * (1.0 + 1.0e-12));
+    }
+
+    // a cutoff small enough to keep every coefficient gives the dense result
+    LFPCalculator<PointSource> pdense(seg_start, seg_end, radii, indices, electrodes, 1.0);
+    LFPCalculator<PointSource> psparse(seg_start, seg_end, radii, indices, electrodes, 1.0, 1e-12);
+    pdense.lfp(currents);
+    psparse.lfp(currents);
+    BOOST_CHECK_EQUAL(psparse.ncoefficients(), nelectrode * nsegment);
+    for (int k = 0; k < nelectrode; ++k) {
+        BOOST_CHECK_CLOSE(psparse.lfp_values()[k], pdense.lfp_values()[k], 1.0e-8);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(LFP_report_reduction) {
+    const std::string geometry_file = "lfp_test_geometry.txt";
+    {
+        std::ofstream out(geometry_file);
+        out << "2 0.3\n0 0 10\n0 0 -10\n1\n"
+            << "7 2\n0 1\n0 0 0 1 0 0 2\n3 2\n1 0 0 2 0 0 1\n2 0 0 3 0 0 1\n";
+    }
+    LFPGeometry geometry = read_lfp_geometry(geometry_file);
+    BOOST_CHECK_CLOSE(geometry.conductivity, 0.3, 1e-12);
+    BOOST_REQUIRE_EQUAL(geometry.electrodes.size(), 2);
+    BOOST_CHECK_EQUAL(geometry.electrodes[1][2], -10.0);
+    BOOST_REQUIRE_EQUAL(geometry.cells.count(7), 1);
+    const auto& sections = geometry.cells[7];
+    BOOST_REQUIRE_EQUAL(sections.size(), 2);
+    BOOST_REQUIRE_EQUAL(sections.at(3).size(), 2);
+    BOOST_CHECK_EQUAL(sections.at(3)[1].start[0], 2.0);
+    BOOST_CHECK_EQUAL(sections.at(0)[0].radius, 2.0);
+    std::remove(geometry_file.c_str());
+
+    // two threads add their LFP at every step, one row every 2 steps
+    const std::string name = "lfp_test_report";
+    const double dt = 0.025;
+    const int nrow = 10;
+    builtin_report_create(name, dt, 0.0, nrow * 2 * dt, 2 * dt, 1);
+    lfp_report_create(name, dt, 0.0, nrow * 2 * dt, 2 * dt, 2);
+    builtin_report_setup(4);
+    for (int step = 0; step < 2 * nrow; ++step) {
+        for (int thread = 0; thread < 2; ++thread) {
+            double values[2] = {double(step + thread), -double(step)};
+            lfp_report_add(name, step, values);
+        }
+        if (step % 5 == 4) {
+            lfp_reports_reduce((step + 1) * dt);
+            builtin_report_end_iteration((step + 1) * dt);
+        }
+    }
+    lfp_reports_finalize();
+    builtin_report_flush(2 * nrow * dt);
+
+    FILE* f = fopen((name + ".rpt").c_str(), "rb");
+    BOOST_REQUIRE(f);
+    ReportFileLayout layout;
+    BOOST_REQUIRE(read_report_file_layout(f, layout));
+    BOOST_REQUIRE_EQUAL(layout.header.nrow, nrow);
+    BOOST_REQUIRE_EQUAL(layout.header.ncol, 2);
+    std::vector<float> values;
+    std::vector<float> rows;
+    for (std::uint64_t c = 0; c < report_nchunk(layout.header); ++c) {
+        BOOST_REQUIRE_GT(read_report_chunk(f, layout, c, values), 0);
+        rows.insert(rows.end(), values.begin(), values.end());
+    }
+    fclose(f);
+    // only rank 0 has columns, with the sum over the ranks
+    for (int row = 0; row < nrow; ++row) {
+        int step = 2 * row;
+        BOOST_CHECK_EQUAL(rows[row * 2], nrnmpi_numprocs * (2 * step + 1));
+        BOOST_CHECK_EQUAL(rows[row * 2 + 1], nrnmpi_numprocs * -2 * step);
+    }
+    if (nrnmpi_myid == 0) {
+        std::remove((name + ".rpt").c_str());
+    }
+}
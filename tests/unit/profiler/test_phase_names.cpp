@@ -0,0 +1,85 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#define BOOST_TEST_MODULE PhaseNamesTest
+#define BOOST_TEST_MAIN
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "coreneuron/utils/profile/profiler_interface.h"
+
+using namespace coreneuron;
+
+// Count every heap allocation made by this process
+static std::atomic<long> n_alloc{0};
+
+void* operator new(std::size_t sz) {
+    ++n_alloc;
+    if (void* p = std::malloc(sz ? sz : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+BOOST_AUTO_TEST_CASE(mech_phase_names_registry) {
+    Instrumentor::mech_phase_names::register_mechanism(5, "ExpSyn");
+    using Instrumentor::mech_phase;
+    using Instrumentor::mech_phase_names;
+    BOOST_CHECK(strcmp(mech_phase_names::get(mech_phase::net_receive, 5), "net-receive-ExpSyn") ==
+                0);
+    BOOST_CHECK(strcmp(mech_phase_names::get(mech_phase::net_buf_receive, 5),
+                       "net-buf-receive-ExpSyn") == 0);
+    BOOST_CHECK(strcmp(mech_phase_names::get(mech_phase::cur, 5), "cur-ExpSyn") == 0);
+    BOOST_CHECK(strcmp(mech_phase_names::get(mech_phase::state, 5), "state-ExpSyn") == 0);
+    // unknown types fall back to the prefix
+    BOOST_CHECK(strcmp(mech_phase_names::get(mech_phase::cur, 4), "cur-") == 0);
+    BOOST_CHECK(strcmp(mech_phase_names::get(mech_phase::state, 1000), "state-") == 0);
+}
+
+// Heap allocations made by the instrumentation for a number of delivered
+// events, as done before (string concatenation per event) and now.
+BOOST_AUTO_TEST_CASE(mech_phase_allocations) {
+    const char* mechname = "ProbAMPANMDA_EMS";
+    const int type = 17;
+    const long nevent = 100'000;
+    Instrumentor::mech_phase_names::register_mechanism(type, mechname);
+
+    long before = n_alloc;
+    for (long i = 0; i < nevent; ++i) {
+        std::string ss("net-receive-");
+        ss += mechname;
+        Instrumentor::phase p(ss.c_str());
+    }
+    long string_allocs = n_alloc - before;
+
+    before = n_alloc;
+    for (long i = 0; i < nevent; ++i) {
+        Instrumentor::phase p(Instrumentor::mech_phase::net_receive, type);
+    }
+    long handle_allocs = n_alloc - before;
+
+    std::cout << "heap allocations for " << nevent << " events: std::string " << string_allocs
+              << ", precomputed " << handle_allocs << std::endl;
+    BOOST_CHECK(string_allocs >= nevent);
+    BOOST_CHECK(handle_allocs == 0);
+}
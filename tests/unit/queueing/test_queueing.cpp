@@ -12,12 +12,19 @@
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <chrono>
 #include <cstdlib>
+#include <random>
 #include <vector>
 #include <iostream>
 //#include "test/unit/queueing/test_header.hpp"
 #include "coreneuron/network/netcvode.hpp"
 #include "coreneuron/network/tqueue.hpp"
+#include "coreneuron/sim/multicore.hpp"
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 namespace bfs = ::boost::filesystem;
 using namespace coreneuron;
@@ -78,9 +85,160 @@ BOOST_AUTO_TEST_CASE(tqueue_ordered_test) {
     BOOST_CHECK(tq.least() == NULL);
 }
 
-BOOST_AUTO_TEST_CASE(tqueue_move_nolock) {}
+BOOST_AUTO_TEST_CASE(calendar_queue_nq_dq) {
+    TQueue<calq> tq = TQueue<calq>();
+    BOOST_CHECK(tq.kind() == calq);
+    const int num = 1000;
+    int cnter = 0;
+    // enough items to resize the calendar a few times, spread over several years
+    for (int i = 0; i < num; ++i) {
+        tq.insert(static_cast<double>((i * 7919) % num) * 0.37, NULL);
+    }
+
+    double time = 0.0;
+    TQItem* item = NULL;
+    while ((item = tq.atomic_dq(1e20)) != NULL) {
+        BOOST_CHECK(time <= item->t_);
+        time = item->t_;
+        ++cnter;
+        delete item;
+    }
+    BOOST_CHECK(cnter == num);
+    BOOST_CHECK(tq.least() == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(tqueue_move_nolock) {
+    // the STL priority queue moves a copy of the item, check the others
+    for (container c: {spltree, calq}) {
+        TQueue<> tq(c);
+        std::vector<TQItem*> items;
+        for (int i = 0; i < 100; ++i) {
+            items.push_back(tq.insert(static_cast<double>(i), NULL));
+        }
+        // move the least item after all the others, and an item before all of them
+        tq.move(items[0], 200.0);
+        tq.move(items[50], -1.0);
+        BOOST_CHECK(tq.least() == items[50]);
+        std::vector<TQItem*> order;
+        TQItem* item = NULL;
+        while ((item = tq.atomic_dq(1e20)) != NULL) {
+            order.push_back(item);
+        }
+        BOOST_CHECK(order.size() == items.size());
+        BOOST_CHECK(order.front() == items[50]);
+        BOOST_CHECK(order.back() == items[0]);
+        for (size_t i = 1; i < order.size(); ++i) {
+            BOOST_CHECK(order[i - 1]->t_ <= order[i]->t_);
+        }
+        for (auto q: order) {
+            delete q;
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tqueue_remove) {
+    for (container c: {spltree, pq_que, calq}) {
+        TQueue<> tq(c);
+        std::vector<TQItem*> items;
+        for (int i = 0; i < 100; ++i) {
+            items.push_back(tq.insert(static_cast<double>(i), NULL));
+        }
+        // remove the least and all the odd times
+        for (int i = 0; i < 100; ++i) {
+            if (i == 0 || i % 2) {
+                tq.remove(items[i]);
+            }
+        }
+        int cnter = 0;
+        TQItem* item = NULL;
+        while ((item = tq.atomic_dq(1e20)) != NULL) {
+            BOOST_CHECK(static_cast<int>(item->t_) % 2 == 0);
+            ++cnter;
+            delete item;
+        }
+        BOOST_CHECK(cnter == 49);
+    }
+}
 
-BOOST_AUTO_TEST_CASE(tqueue_remove) {}
+BOOST_AUTO_TEST_CASE(tqueue_item_pool) {
+    for (container c: {spltree, pq_que, calq}) {
+        ObjectPool<TQItem> pool(64);
+        {
+            TQueue<> tq(c, &pool);
+            for (int i = 0; i < 100; ++i) {
+                tq.insert(static_cast<double>(i), NULL);
+            }
+            BOOST_CHECK(pool.n_in_use() == 100);
+            // steady state: the released items are reused
+            for (int i = 0; i < 10'000; ++i) {
+                TQItem* item = tq.atomic_dq(1e20);
+                double t = item->t_;
+                tq.release(item);
+                tq.insert(t + 100.0, NULL);
+            }
+            BOOST_CHECK(pool.n_alloc() == 10'100);
+            BOOST_CHECK(pool.n_slab() == 2);
+            BOOST_CHECK(pool.n_peak() <= 101);
+        }
+        // the items still in the queue are given back to the pool
+        BOOST_CHECK(pool.n_in_use() == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(object_pool_clear) {
+    ObjectPool<TQItem> pool(16);
+    for (int i = 0; i < 100; ++i) {
+        pool.alloc();
+    }
+    std::size_t nslab = pool.n_slab();
+    pool.clear();
+    BOOST_CHECK(pool.n_in_use() == 0);
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK(pool.alloc()->data_ == NULL);
+    }
+    // the slabs are reused after a clear
+    BOOST_CHECK(pool.n_slab() == nslab);
+}
+
+/// Hold model benchmark of the event queues: with n events in the queue,
+/// repeatedly deliver the least one and schedule a new one. The delays mimic
+/// the ringtest (a few fixed NetCon delays) and netstim (exponentially
+/// distributed self event intervals) models.
+static double hold_rate(container c, int n, bool exponential) {
+    std::mt19937 gen(1);
+    std::exponential_distribution<double> interval(1.0 / 5.0);
+    const double delays[] = {1.0, 1.5, 2.0, 5.0};
+    auto delay = [&](int i) { return exponential ? interval(gen) : delays[i % 4]; };
+
+    TQueue<> tq(c);
+    for (int i = 0; i < n; ++i) {
+        tq.insert(delay(i), NULL);
+    }
+    const int nhold = 1'000'000;
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    for (int i = 0; i < nhold; ++i) {
+        TQItem* q = tq.atomic_dq(1e20);
+        double t = q->t_;
+        delete q;
+        tq.insert(t + delay(i), NULL);
+    }
+    auto t1 = clock::now();
+    return nhold / std::chrono::duration<double>(t1 - t0).count();
+}
+
+BOOST_AUTO_TEST_CASE(tqueue_hold_rate) {
+    const char* names[] = {"splay", "pq", "calendar"};
+    for (bool exponential: {false, true}) {
+        for (int n: {100, 10'000, 1'000'000}) {
+            std::cout << "hold " << (exponential ? "netstim" : "ring") << " n=" << n;
+            for (container c: {spltree, pq_que, calq}) {
+                std::cout << " " << names[c] << " " << hold_rate(c, n, exponential) << "/s";
+            }
+            std::cout << std::endl;
+        }
+    }
+}
 
 BOOST_AUTO_TEST_CASE(threaddata_interthread_send) {
     NetCvodeThreadData nt{};
@@ -88,8 +246,110 @@ BOOST_AUTO_TEST_CASE(threaddata_interthread_send) {
     for (size_t i = 0; i < num; ++i)
         nt.interthread_send(static_cast<double>(i), NULL, NULL);
 
+    BOOST_CHECK(nt.n_inter_thread_events() == num);
+
+    nrn_interthread_mutex_ = true;
+    for (size_t i = 0; i < num; ++i)
+        nt.interthread_send(static_cast<double>(i), NULL, NULL);
+    nrn_interthread_mutex_ = false;
+
     BOOST_CHECK(nt.inter_thread_events_.size() == num);
+    BOOST_CHECK(nt.n_inter_thread_events() == 2 * num);
+
+    nt.clear_inter_thread_events();
+    BOOST_CHECK(nt.n_inter_thread_events() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(interthread_mailbox_order) {
+    InterThreadMailbox mailbox;
+    const int num = 1000;  // several blocks
+    int next = 0;
+    for (int i = 0; i < num; ++i) {
+        mailbox.push(InterThreadEvent{NULL, static_cast<double>(i)});
+        if (i % 300 == 0) {
+            mailbox.drain([&](const InterThreadEvent& ite) {
+                BOOST_CHECK(ite.t_ == next);
+                ++next;
+            });
+        }
+    }
+    BOOST_CHECK(mailbox.size() == static_cast<size_t>(num - next));
+    mailbox.drain([&](const InterThreadEvent& ite) {
+        BOOST_CHECK(ite.t_ == next);
+        ++next;
+    });
+    BOOST_CHECK(next == num);
+    BOOST_CHECK(mailbox.size() == 0);
+}
+
+#if defined(_OPENMP)
+/// Contention benchmark of the inter-thread events on a fully connected
+/// synthetic network: every thread sends to every other thread while the
+/// targets concurrently drain what they have received.
+static double interthread_rate(int nthread, bool use_mutex) {
+    nrn_interthread_mutex_ = use_mutex;
+    std::vector<NetCvodeThreadData> ntd(nthread);
+    std::vector<NrnThread> nts(nthread);
+    for (int i = 0; i < nthread; ++i) {
+        ntd[i].init_mailboxes(nthread);
+        nts[i].id = i;
+    }
+    const int nround = 200;
+    const int nspike = 50;  // spikes per thread and round, each sent to all other threads
+    std::vector<long> nreceived(nthread, 0);
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+#pragma omp parallel num_threads(nthread)
+    {
+        int id = omp_get_thread_num();
+        for (int r = 0; r < nround; ++r) {
+            for (int s = 0; s < nspike; ++s) {
+                for (int tar = 0; tar < nthread; ++tar) {
+                    if (tar != id) {
+                        ntd[tar].interthread_send(r + 1.0, NULL, &nts[id]);
+                    }
+                }
+            }
+            // what the enqueue into the event queue does, without the queue
+            if (use_mutex) {
+                std::lock_guard<OMP_Mutex> lock(ntd[id].mut);
+                nreceived[id] += ntd[id].inter_thread_events_.size();
+                ntd[id].inter_thread_events_.clear();
+            } else {
+                for (auto& mailbox: ntd[id].inter_thread_mailboxes_) {
+                    mailbox->drain([&](const InterThreadEvent&) { ++nreceived[id]; });
+                }
+            }
+        }
+#pragma omp barrier
+        if (use_mutex) {
+            nreceived[id] += ntd[id].inter_thread_events_.size();
+            ntd[id].inter_thread_events_.clear();
+        } else {
+            for (auto& mailbox: ntd[id].inter_thread_mailboxes_) {
+                mailbox->drain([&](const InterThreadEvent&) { ++nreceived[id]; });
+            }
+        }
+    }
+    auto t1 = clock::now();
+    nrn_interthread_mutex_ = false;
+    long nsent = long(nthread) * (nthread - 1) * nround * nspike;
+    long ntotal = 0;
+    for (auto n: nreceived) {
+        ntotal += n;
+    }
+    BOOST_CHECK(ntotal == nsent);
+    return nsent / std::chrono::duration<double>(t1 - t0).count();
+}
+
+BOOST_AUTO_TEST_CASE(interthread_contention) {
+    for (int nthread = 1; nthread <= 64; nthread *= 2) {
+        std::cout << "interthread nthread=" << nthread
+                  << " mutex " << interthread_rate(nthread, true) << "/s"
+                  << " lock-free " << interthread_rate(nthread, false) << "/s" << std::endl;
+    }
 }
+#endif
 /*
 BOOST_AUTO_TEST_CASE(threaddata_enqueue){
     NetCvode n = NetCvode();
@@ -0,0 +1,143 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#define BOOST_TEST_MODULE ReportStagingTest
+#define BOOST_TEST_MAIN
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "coreneuron/io/reports/report_staging.hpp"
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+using namespace coreneuron;
+
+BOOST_AUTO_TEST_CASE(flush_replays_staged_steps) {
+    std::vector<double> live{1., 2., 3.};
+    ReportStaging staging({&live[2], &live[0]});
+    BOOST_REQUIRE(staging.size() == 2);
+    for (int step = 0; step < 4; ++step) {
+        staging.stage(step);
+        for (auto& v: live) {
+            v += 10.;
+        }
+    }
+    BOOST_CHECK(staging.nstaged() == 4);
+    // the library reads the registered values when called for a step
+    int nwrite = 0;
+    staging.flush([&](double step) {
+        BOOST_CHECK(step == nwrite);
+        BOOST_CHECK(*staging.value(0) == 3. + 10. * step);
+        BOOST_CHECK(*staging.value(1) == 1. + 10. * step);
+        ++nwrite;
+    });
+    BOOST_CHECK(nwrite == 4);
+    BOOST_CHECK(staging.nstaged() == 0);
+    staging.flush([&](double) { ++nwrite; });
+    BOOST_CHECK(nwrite == 4);
+}
+
+/// Stand-in for the reporting library: gathers the registered values of a step
+struct Recorder {
+    std::vector<double> buffer;
+    void record(const std::vector<double*>& values) {
+        for (double* v: values) {
+            buffer.push_back(*v);
+        }
+        buffer.clear();
+    }
+};
+
+/// Stand-in for ReportEvent::summation_alu: each value is a weighted sum of currents
+static void summation(const std::vector<double>& currents, std::vector<double>& values) {
+    const std::size_t ncurrent = currents.size() / values.size();
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        double sum = 0.;
+        for (std::size_t j = 0; j < ncurrent; ++j) {
+            sum += currents[i * ncurrent + j] * (j % 2 ? -1. : 1.);
+        }
+        values[i] = sum;
+    }
+}
+
+/// Mean time per step, in microseconds, of the report events of nthread threads
+/// with nvalue values each, over intervals of nstep_interval steps. Either every
+/// thread sums and records in a critical section at each step, as ReportEvent
+/// did, or it sums and stages its values in parallel and a single thread
+/// replays them to the recorder after the interval.
+static double step_overhead(int nthread, bool staged) {
+    const int nvalue = 20'000;
+    const int ncurrent = 8;
+    const int nstep_interval = 40;
+    const int ninterval = 25;
+    std::vector<std::vector<double>> currents(nthread);
+    std::vector<std::vector<double>> live(nthread);
+    std::vector<ReportStaging> staging(nthread);
+    std::vector<std::vector<double*>> registered(nthread);
+    #pragma omp parallel for num_threads(nthread)
+    for (int ith = 0; ith < nthread; ++ith) {
+        currents[ith].assign(nvalue * ncurrent, 1e-3 * ith);
+        live[ith].assign(nvalue, 0.);
+        std::vector<double*> src;
+        for (auto& v: live[ith]) {
+            src.push_back(&v);
+        }
+        if (staged) {
+            staging[ith] = ReportStaging(src);
+            for (int i = 0; i < nvalue; ++i) {
+                src[i] = staging[ith].value(i);
+            }
+        }
+        registered[ith] = src;
+    }
+    Recorder recorder;
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    for (int interval = 0; interval < ninterval; ++interval) {
+        #pragma omp parallel for num_threads(nthread)
+        for (int ith = 0; ith < nthread; ++ith) {
+            for (int step = 0; step < nstep_interval; ++step) {
+                if (staged) {
+                    summation(currents[ith], live[ith]);
+                    staging[ith].stage(step);
+                } else {
+                    #pragma omp critical
+                    {
+                        summation(currents[ith], live[ith]);
+                        recorder.record(registered[ith]);
+                    }
+                }
+            }
+        }
+        if (staged) {
+            for (int ith = 0; ith < nthread; ++ith) {
+                staging[ith].flush([&](double) { recorder.record(registered[ith]); });
+            }
+        }
+    }
+    auto t1 = clock::now();
+    return 1e6 * std::chrono::duration<double>(t1 - t0).count() / (ninterval * nstep_interval);
+}
+
+BOOST_AUTO_TEST_CASE(report_step_overhead_thread_scaling) {
+    int max_threads = 1;
+#if defined(_OPENMP)
+    max_threads = omp_get_max_threads();
+#endif
+    for (int nthread = 1; nthread <= max_threads; nthread *= 2) {
+        std::cout << "report step nthread=" << nthread << " critical "
+                  << step_overhead(nthread, false) << "us staged " << step_overhead(nthread, true)
+                  << "us" << std::endl;
+    }
+}
@@ -0,0 +1,146 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#define BOOST_TEST_MODULE solver
+#define BOOST_TEST_MAIN
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "coreneuron/nrniv/nrniv_decl.h"
+#include "coreneuron/permute/cellorder.hpp"
+#include "coreneuron/permute/node_permute.h"
+#include "coreneuron/sim/multicore.hpp"
+
+using namespace coreneuron;
+
+namespace {
+/// Hines matrices of ncell cells of nshape shapes, nodes of a cell after their parent
+struct Matrices {
+    int ncell;
+    std::vector<int> parent;
+    std::vector<double> a, b, d, rhs;
+};
+
+Matrices make_matrices(int ncell, int nshape, int min_size, int max_size) {
+    std::mt19937 gen(1234);
+    std::vector<std::vector<int>> shapes(nshape);
+    for (auto& shape: shapes) {
+        int size = std::uniform_int_distribution<int>(min_size, max_size)(gen);
+        shape.push_back(-1);
+        for (int i = 1; i < size; ++i) {
+            // mostly unbranched sections, like the dendrites of the ring cells
+            int p = std::bernoulli_distribution(0.8)(gen)
+                        ? i - 1
+                        : std::uniform_int_distribution<int>(0, i - 1)(gen);
+            shape.push_back(p);
+        }
+    }
+    Matrices m;
+    m.ncell = ncell;
+    m.parent.assign(ncell, 0);
+    std::vector<const std::vector<int>*> cells;
+    for (int i = 0; i < ncell; ++i) {
+        cells.push_back(&shapes[i % nshape]);
+    }
+    // roots first, then the other nodes of each cell
+    for (int icell = 0; icell < ncell; ++icell) {
+        const auto& shape = *cells[icell];
+        int first = m.parent.size();
+        for (size_t i = 1; i < shape.size(); ++i) {
+            m.parent.push_back(shape[i] == 0 ? icell : first + shape[i] - 1);
+        }
+    }
+    std::uniform_real_distribution<double> off(-1.0, -0.1);
+    std::uniform_real_distribution<double> diag(5.0, 10.0);
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+    for (size_t i = 0; i < m.parent.size(); ++i) {
+        m.a.push_back(off(gen));
+        m.b.push_back(off(gen));
+        m.d.push_back(diag(gen));
+        m.rhs.push_back(value(gen));
+    }
+    return m;
+}
+
+void set_thread(NrnThread& nt, Matrices& m) {
+    nt.ncell = m.ncell;
+    nt.end = m.parent.size();
+    nt._v_parent_index = m.parent.data();
+    nt._actual_a = m.a.data();
+    nt._actual_b = m.b.data();
+    nt._actual_d = m.d.data();
+    nt._actual_rhs = m.rhs.data();
+}
+
+/// Solve copies of the matrices nrep times, returns the seconds per solve
+double solve(NrnThread& nt, const Matrices& m, Matrices& work, int nrep) {
+    double seconds = 0.0;
+    for (int rep = 0; rep < nrep; ++rep) {
+        work.d = m.d;
+        work.rhs = m.rhs;
+        set_thread(nt, work);
+        auto start = std::chrono::steady_clock::now();
+        nrn_solve_minimal(&nt);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return seconds / nrep;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(interleaved_solvers) {
+    const int ncell = 2000;
+    const int nrep = 50;
+    // cells of few shapes, from the size of the ring cells to a few hundred nodes
+    for (int max_size: {25, 400}) {
+        Matrices m = make_matrices(ncell, 8, max_size / 2, max_size);
+        const int nnode = m.parent.size();
+        NrnThread nt;
+        nrn_threads = &nt;
+        nrn_nthread = 1;
+
+        // reference: triang and bksub in the original order
+        use_solve_interleave = false;
+        Matrices reference = m;
+        double tserial = solve(nt, m, reference, nrep);
+
+        for (int type: {1, 3}) {
+            interleave_permute_type = type;
+            create_interleave_info();
+            std::vector<int> parent(m.parent);
+            int* order = interleave_order(0, ncell, nnode, parent.data());
+            Matrices permuted = m;
+            permute_ptr(permuted.parent.data(), nnode, order);
+            node_permute(permuted.parent.data(), nnode, order);
+            for (auto* v: {&permuted.a, &permuted.b, &permuted.d, &permuted.rhs}) {
+                permute_data(v->data(), nnode, order);
+            }
+            use_solve_interleave = true;
+            Matrices work = permuted;
+            double t = solve(nt, permuted, work, nrep);
+            for (int i = 0; i < nnode; ++i) {
+                BOOST_CHECK_CLOSE(work.rhs[order[i]], reference.rhs[i], 1e-10);
+            }
+            std::clog << ncell << " cells of " << nnode / ncell << " nodes, --cell-permute "
+                      << type << ": " << t * 1e6 << " us per solve, triang/bksub "
+                      << tserial * 1e6 << " us";
+            if (type == 3) {
+                std::clog << " (" << simd_lanes << " lanes)";
+            }
+            std::clog << '\n';
+            delete[] order;
+            destroy_interleave_info();
+        }
+        nrn_threads = nullptr;
+        nrn_nthread = 0;
+    }
+}
@@ -0,0 +1,152 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#define BOOST_TEST_MODULE SpikeRecordTest
+#define BOOST_TEST_MAIN
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "coreneuron/io/output_spikes.hpp"
+#include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/utils/nrnmutdec.h"
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+using namespace coreneuron;
+
+// The sort that local_spikevec_sort replaced: stable by gid, then stable by time.
+static void reference_sort(const std::vector<double>& time,
+                           const std::vector<int>& gid,
+                           std::vector<double>& stime,
+                           std::vector<int>& sgid) {
+    std::vector<std::size_t> perm(time.size());
+    std::iota(perm.begin(), perm.end(), 0);
+    std::stable_sort(perm.begin(), perm.end(), [&](std::size_t i, std::size_t j) {
+        return gid[i] < gid[j];
+    });
+    std::stable_sort(perm.begin(), perm.end(), [&](std::size_t i, std::size_t j) {
+        return time[i] < time[j];
+    });
+    stime.clear();
+    sgid.clear();
+    for (std::size_t i: perm) {
+        stime.push_back(time[i]);
+        sgid.push_back(gid[i]);
+    }
+}
+
+// nrun time sorted runs of spikes on a dt grid, so that there are ties
+static void make_runs(int nrun, int nspike, std::vector<double>& time, std::vector<int>& gid) {
+    std::mt19937 gen(nrun);
+    std::uniform_int_distribution<int> step(0, 3);
+    std::uniform_int_distribution<int> cell(0, 50);
+    time.clear();
+    gid.clear();
+    for (int r = 0; r < nrun; ++r) {
+        double t = 0.;
+        for (int i = 0; i < nspike; ++i) {
+            t += 0.025 * step(gen);
+            time.push_back(t);
+            gid.push_back(cell(gen));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sort_matches_reference) {
+    std::vector<double> time, stime, rtime;
+    std::vector<int> gid, sgid, rgid;
+    local_spikevec_sort(time, gid, stime, sgid);
+    BOOST_CHECK(stime.empty() && sgid.empty());
+    for (int nrun: {1, 2, 7, 64}) {
+        make_runs(nrun, 1000, time, gid);
+        local_spikevec_sort(time, gid, stime, sgid);
+        reference_sort(time, gid, rtime, rgid);
+        BOOST_CHECK(stime == rtime);
+        BOOST_CHECK(sgid == rgid);
+    }
+    // no sorted run longer than one spike
+    std::reverse(time.begin(), time.end());
+    local_spikevec_sort(time, gid, stime, sgid);
+    reference_sort(time, gid, rtime, rgid);
+    BOOST_CHECK(stime == rtime);
+    BOOST_CHECK(sgid == rgid);
+}
+
+BOOST_AUTO_TEST_CASE(record_per_thread_and_merge) {
+    const int nspike = 1000;
+    nrn_nthread = 4;
+    mk_spikevec_buffer(0);
+    #pragma omp parallel for
+    for (int tid = 0; tid < nrn_nthread; ++tid) {
+        for (int i = 0; i < nspike; ++i) {
+            spikevec_record(tid, tid * nspike + i, 0.1 * i);
+        }
+    }
+    spikevec_merge();
+    const std::size_t ntotal = nrn_nthread * nspike;
+    BOOST_REQUIRE(spikevec_gid.size() == ntotal);
+    // the buffers are appended in thread order
+    for (int i = 0; i < static_cast<int>(ntotal); ++i) {
+        BOOST_CHECK(spikevec_gid[i] == i);
+    }
+    spikevec_merge();
+    BOOST_CHECK(spikevec_gid.size() == ntotal);
+    clear_spike_vectors();
+    BOOST_CHECK(spikevec_gid.empty());
+    nrn_nthread = 0;
+}
+
+/// Spikes recorded per second by nthread threads, each recording nspike, either
+/// in its own buffer or, as before, in the shared vectors under a mutex.
+static double record_rate(int nthread, bool shared) {
+    const int nspike = 1'000'000;
+    nrn_nthread = nthread;
+    mk_spikevec_buffer(0);
+    OMP_Mutex mut;
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    #pragma omp parallel for num_threads(nthread)
+    for (int tid = 0; tid < nthread; ++tid) {
+        for (int i = 0; i < nspike; ++i) {
+            if (shared) {
+                mut.lock();
+                spikevec_gid.push_back(i);
+                spikevec_time.push_back(0.025 * i);
+                mut.unlock();
+            } else {
+                spikevec_record(tid, i, 0.025 * i);
+            }
+        }
+    }
+    spikevec_merge();
+    auto t1 = clock::now();
+    clear_spike_vectors();
+    nrn_nthread = 0;
+    return nthread * nspike / std::chrono::duration<double>(t1 - t0).count();
+}
+
+BOOST_AUTO_TEST_CASE(record_rate_thread_scaling) {
+    int max_threads = 1;
+#if defined(_OPENMP)
+    max_threads = omp_get_max_threads();
+#endif
+    for (int nthread = 1; nthread <= max_threads; nthread *= 2) {
+        std::cout << "spike record nthread=" << nthread << " mutex "
+                  << record_rate(nthread, true) << "/s per thread buffer "
+                  << record_rate(nthread, false) << "/s" << std::endl;
+    }
+}
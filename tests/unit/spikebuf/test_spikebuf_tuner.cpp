@@ -0,0 +1,86 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#define BOOST_TEST_MODULE SpikebufTunerTest
+#define BOOST_TEST_MAIN
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "coreneuron/network/spikebuf_tuner.hpp"
+
+using namespace coreneuron;
+
+// size of an NRNMPI_Spike, {int gid; double spiketime;}
+static constexpr std::size_t spike_size = 16;
+
+// Feed the same per-rank counts for n exchanges, return the number of resizes.
+static int feed(SpikebufTuner& tuner, const std::vector<int>& nin, int n) {
+    int nresize = 0;
+    for (int i = 0; i < n; ++i) {
+        nresize += tuner.update(nin.data(), nin.size(), spike_size);
+    }
+    return nresize;
+}
+
+BOOST_AUTO_TEST_CASE(no_decision_before_window) {
+    SpikebufTuner tuner(8);
+    std::vector<int> nin(4, 100);
+    BOOST_CHECK_EQUAL(feed(tuner, nin, SpikebufTuner::window - 1), 0);
+    BOOST_CHECK_EQUAL(tuner.capacity(), 8);
+    BOOST_CHECK_EQUAL(tuner.noverflow(), SpikebufTuner::window - 1);
+    BOOST_CHECK_EQUAL(feed(tuner, nin, 1), 1);
+    BOOST_CHECK_EQUAL(tuner.nresize(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(grows_to_cover_steady_counts) {
+    SpikebufTuner tuner(8);
+    std::vector<int> nin(16, 100);
+    feed(tuner, nin, SpikebufTuner::window);
+    BOOST_CHECK_EQUAL(tuner.capacity(), 128);
+    // no overflow and no resize once the counts fit
+    feed(tuner, nin, 4 * SpikebufTuner::window);
+    BOOST_CHECK_EQUAL(tuner.capacity(), 128);
+    BOOST_CHECK_EQUAL(tuner.nresize(), 1);
+    BOOST_CHECK_EQUAL(tuner.noverflow(), SpikebufTuner::window);
+    BOOST_CHECK_EQUAL(tuner.nexchange(), 5 * SpikebufTuner::window);
+}
+
+BOOST_AUTO_TEST_CASE(shrinks_when_quiet) {
+    SpikebufTuner tuner(1024);
+    std::vector<int> nin(64, 0);
+    feed(tuner, nin, SpikebufTuner::window);
+    BOOST_CHECK_EQUAL(tuner.capacity(), 0);
+    BOOST_CHECK_EQUAL(tuner.noverflow(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(rare_bursts_go_to_overflow) {
+    SpikebufTuner tuner(8);
+    std::vector<int> quiet(64, 1);
+    std::vector<int> burst(64, 1);
+    burst[0] = 4000;  // a single rank, once per window
+    for (int w = 0; w < 4; ++w) {
+        feed(tuner, burst, 1);
+        feed(tuner, quiet, SpikebufTuner::window - 1);
+    }
+    // padding every buffer to the burst would cost far more than one overflow
+    BOOST_CHECK_EQUAL(tuner.capacity(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(same_counts_same_decision) {
+    // the resize is collective because every rank sees the same counts
+    SpikebufTuner a(8), b(8);
+    std::vector<int> nin{3, 70, 0, 12, 5, 40};
+    for (int i = 0; i < 3 * SpikebufTuner::window; ++i) {
+        nin[i % nin.size()] = (nin[i % nin.size()] * 7 + i) % 97;
+        BOOST_CHECK_EQUAL(a.update(nin.data(), nin.size(), spike_size),
+                          b.update(nin.data(), nin.size(), spike_size));
+        BOOST_CHECK_EQUAL(a.capacity(), b.capacity());
+    }
+}
@@ -0,0 +1,135 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#define BOOST_TEST_MODULE spin_barrier
+#define BOOST_TEST_MAIN
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "coreneuron/utils/spin_barrier.hpp"
+
+using namespace coreneuron;
+
+namespace {
+int nworker() {
+#if defined(_OPENMP)
+    return std::max(2, std::min(8, omp_get_max_threads()));
+#else
+    return 1;
+#endif
+}
+
+int worker_id() {
+#if defined(_OPENMP)
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/// Small per thread work of a step, a few cells worth of nodes
+void step_work(std::vector<double>& v) {
+    for (auto& x: v) {
+        x = 0.5 * x + 1.0;
+    }
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(serial_part_sees_all_threads) {
+    const int n = nworker();
+    const int nphase = 1000;
+    SpinBarrier barrier(n);
+    std::vector<std::atomic<int>> count(n);
+    int nerror = 0;
+
+    // clang-format off
+
+    #pragma omp parallel num_threads(n)
+    // clang-format on
+    {
+        int id = worker_id();
+        bool sense = false;
+        for (int phase = 1; phase <= nphase; ++phase) {
+            count[id] = phase;
+            barrier.wait(sense, id == 0, [&] {
+                for (const auto& c: count) {
+                    nerror += c != phase;
+                }
+            });
+            // nobody is past the barrier before the serial part is done
+            if (count[(id + 1) % n] < phase) {
+#pragma omp atomic
+                ++nerror;
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(nerror, 0);
+}
+
+/*
+ * Per step overhead: with gap junctions every step synchronizes the threads
+ * twice. Compare a parallel loop per half step (fork/join) with one parallel
+ * region for all the steps and two barriers per step, for a work so small
+ * that the synchronization dominates.
+ */
+BOOST_AUTO_TEST_CASE(per_step_overhead) {
+    const int n = nworker();
+    const int nstep = 20000;
+    const int nnode = 256;
+    std::vector<std::vector<double>> forkjoin(n, std::vector<double>(nnode, 0.0));
+    std::vector<std::vector<double>> persistent(forkjoin);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < nstep; ++step) {
+        for (int half = 0; half < 2; ++half) {
+            int i;
+            // clang-format off
+
+            #pragma omp parallel for private(i) num_threads(n) schedule(static, 1)
+            // clang-format on
+            for (i = 0; i < n; ++i) {
+                step_work(forkjoin[i]);
+            }
+        }
+    }
+    double tforkjoin =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    SpinBarrier barrier(n);
+    // clang-format off
+
+    #pragma omp parallel num_threads(n)
+    // clang-format on
+    {
+        int id = worker_id();
+        bool sense = false;
+        for (int step = 0; step < nstep; ++step) {
+            for (int half = 0; half < 2; ++half) {
+                step_work(persistent[id]);
+                barrier.wait(sense, id == 0);
+            }
+        }
+    }
+    double tpersistent =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    BOOST_CHECK(forkjoin == persistent);
+    std::clog << n << " threads, " << nnode << " nodes per thread: " << tforkjoin / nstep * 1e6
+              << " us per step with a parallel loop per half step, " << tpersistent / nstep * 1e6
+              << " us with a persistent region and barriers\n";
+}
@@ -0,0 +1,210 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2021 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#define BOOST_TEST_MODULE threshold
+#define BOOST_TEST_MAIN
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "coreneuron/network/netcon.hpp"
+#include "coreneuron/network/netcvode.hpp"
+#include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/utils/memory.h"
+
+using namespace coreneuron;
+
+namespace {
+/// Cells whose PreSyn watches a node of its own with a threshold around -50, their
+/// root or a node past the roots
+struct ThresholdThread {
+    NrnThread nt;
+    std::vector<double> v;
+    std::vector<PreSynHelper> helper;
+
+    ThresholdThread(int ncell, const std::vector<int>& without_presyn, bool roots = false) {
+        std::mt19937 gen(1234);
+        std::uniform_real_distribution<double> thresh(-55.0, -45.0);
+        nt.ncell = ncell;
+        nt.end = 2 * ncell;
+        nt.presyns = new PreSyn[ncell];
+        for (int i = 0; i < ncell; ++i) {
+            nt.presyns[i].thvar_index_ = roots ? i : ncell + (i * 7) % ncell;
+            nt.presyns[i].threshold_ = thresh(gen);
+        }
+        for (int i: without_presyn) {
+            nt.presyns[i].thvar_index_ = -1;
+        }
+        v.assign(nt.end, -65.0);
+        nt._actual_v = v.data();
+        helper.assign(ncell, PreSynHelper{0});
+        nt.presyns_helper = helper.data();
+        nrn_threshold_table_setup(nt);
+    }
+
+    ~ThresholdThread() {
+        free_memory(nt.presyns_thvar_index);
+        free_memory(nt.presyns_threshold);
+        delete[] nt.presyns;
+    }
+
+    /// Voltage of the node watched by cell i
+    double& cell_v(int i) {
+        return v[nt.presyns[i].thvar_index_];
+    }
+
+    int compact(std::vector<int>& buf) {
+        buf.assign(nt.ncell, -1);
+        int n = nrn_threshold_compact(nt.ncell,
+                                      nt.presyns_thvar_index,
+                                      nt.presyns_threshold,
+                                      nt._actual_v,
+                                      nt.presyns_helper,
+                                      buf.data());
+        buf.resize(n);
+        return n;
+    }
+};
+
+/// The per-PreSyn loop of check_thresh before the SoA table. It read
+/// actual_v[-1] for a cell without a presyn, here such a cell is below threshold.
+int presyn_loop(const NrnThread& nt, std::vector<int>& flags, std::vector<int>& buf) {
+    buf.clear();
+    for (int i = 0; i < nt.ncell; ++i) {
+        const PreSyn& ps = nt.presyns[i];
+        double v = ps.thvar_index_ >= 0 ? nt._actual_v[ps.thvar_index_]
+                                        : -std::numeric_limits<double>::infinity();
+        // pscheck
+        if (v > ps.threshold_) {
+            if (flags[i] == false) {
+                flags[i] = true;
+                buf.push_back(i);
+            }
+        } else {
+            flags[i] = false;
+        }
+    }
+    return buf.size();
+}
+
+/// Run the kernel and the presyn loop on the current voltages, compare buffers and flags
+std::vector<int> check_step(ThresholdThread& th, std::vector<int>& flags) {
+    std::vector<int> buf, ref;
+    int n = th.compact(buf);
+    int nref = presyn_loop(th.nt, flags, ref);
+    BOOST_REQUIRE_EQUAL(n, nref);
+    BOOST_CHECK(buf == ref);
+    for (int i = 0; i < th.nt.ncell; ++i) {
+        BOOST_CHECK_EQUAL(th.helper[i].flag_, flags[i]);
+    }
+    return buf;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(table) {
+    ThresholdThread th(100, {3, 99});
+    for (int i = 0; i < th.nt.ncell; ++i) {
+        const PreSyn& ps = th.nt.presyns[i];
+        if (i == 3 || i == 99) {
+            // never fires, whatever the voltage of node 0
+            BOOST_CHECK_EQUAL(th.nt.presyns_thvar_index[i], 0);
+            BOOST_CHECK(std::isinf(th.nt.presyns_threshold[i]));
+        } else {
+            BOOST_CHECK_EQUAL(th.nt.presyns_thvar_index[i], ps.thvar_index_);
+            BOOST_CHECK_EQUAL(th.nt.presyns_threshold[i], ps.threshold_);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(kernel_matches_presyn_loop) {
+    // three whole blocks of 64 cells and a partial one, cell 5 without a presyn
+    const int ncell = 3 * 64 + 17;
+    ThresholdThread th(ncell, {5});
+    th.v[0] = 100.0;  // node 0, watched by cell 5 in the table
+    std::vector<int> flags(ncell, 0);
+
+    // no crossing at all
+    BOOST_CHECK(check_step(th, flags).empty());
+
+    // block 0: none, block 1: one, block 2: all of them, last block: a few
+    std::vector<int> expected{64 + 10};
+    for (int i = 128; i < 192; ++i) {
+        expected.push_back(i);
+    }
+    expected.insert(expected.end(), {192, 200, 208});
+    for (int i: expected) {
+        th.cell_v(i) = 0.0;
+    }
+    BOOST_CHECK(check_step(th, flags) == expected);
+
+    // still above: no new spike, a cell fires again only after going below
+    BOOST_CHECK(check_step(th, flags).empty());
+    th.cell_v(130) = -70.0;
+    BOOST_CHECK(check_step(th, flags).empty());
+    th.cell_v(130) = 0.0;
+    BOOST_CHECK(check_step(th, flags) == std::vector<int>{130});
+
+    // random walks through the thresholds
+    std::mt19937 gen(42);
+    std::normal_distribution<double> dv(0.0, 4.0);
+    for (int step = 0; step < 200; ++step) {
+        for (int i = ncell; i < th.nt.end; ++i) {
+            th.v[i] = std::min(std::max(th.v[i] + dv(gen), -80.0), 20.0);
+        }
+        check_step(th, flags);
+    }
+    BOOST_CHECK_EQUAL(th.helper[5].flag_, 0);
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+    // 1e5 cells watching their root, few of them crossing on a step
+    const int ncell = 100000;
+    const int nstep = 200;
+    ThresholdThread th(ncell, {}, true);
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<std::vector<double>> steps_v(8, std::vector<double>(ncell));
+    for (auto& v: steps_v) {
+        for (auto& x: v) {
+            x = uniform(gen) < 0.001 ? 0.0 : -65.0;
+        }
+    }
+
+    std::vector<int> flags(ncell, 0), ref;
+    std::vector<int> buf(ncell);
+    int nspike_ref = 0, nspike = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < nstep; ++step) {
+        std::copy(steps_v[step % 8].begin(), steps_v[step % 8].end(), th.v.begin());
+        nspike_ref += presyn_loop(th.nt, flags, ref);
+    }
+    double tloop = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int step = 0; step < nstep; ++step) {
+        std::copy(steps_v[step % 8].begin(), steps_v[step % 8].end(), th.v.begin());
+        nspike += nrn_threshold_compact(ncell,
+                                        th.nt.presyns_thvar_index,
+                                        th.nt.presyns_threshold,
+                                        th.nt._actual_v,
+                                        th.nt.presyns_helper,
+                                        buf.data());
+    }
+    double tkernel = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                         .count();
+    BOOST_CHECK_EQUAL(nspike, nspike_ref);
+    // the copy of v is in both times
+    std::clog << ncell << " cells, " << nstep << " steps: presyn loop " << tloop * 1e3
+              << " ms, SoA kernel " << tkernel * 1e3 << " ms\n";
+}